@@ -4,8 +4,11 @@
 #define INTERNAL_CLOCK_SPEED 67108864
 
 #include "types.hpp"
-
-#include <queue>
+#include "emulator/instrumentation.hpp"
+#include "emulator/guestmemory.hpp"
+#include "emulator/savestate.hpp"
+#include <atomic>
+#include <mutex>
 
 enum EventType {
 	STOP,
@@ -17,30 +20,51 @@ enum EventType {
 	IPC_RECV_FIFO7,
 	PPU_LINE_START,
 	PPU_HBLANK,
-	REFRESH_WRAM_PAGES,
-	REFRESH_VRAM_PAGES,
-	REFRESH_ROM_PAGES,
+	REFRESH_PAGES,
 	SPI_FINISHED,
 	RTC_REFRESH,
 	SERIAL_INTERRUPT,
-	TIMER_OVERFLOW_9,
-	TIMER_OVERFLOW_7,
+	TIMER0_OVERFLOW_9, // Each timer channel gets its own slot so they can be rescheduled independently
+	TIMER1_OVERFLOW_9,
+	TIMER2_OVERFLOW_9,
+	TIMER3_OVERFLOW_9,
+	TIMER0_OVERFLOW_7,
+	TIMER1_OVERFLOW_7,
+	TIMER2_OVERFLOW_7,
+	TIMER3_OVERFLOW_7,
 	GAMECARD_TRANSFER_READY,
 	GAMECARD_COMMAND_COMPLETE,
-	APU_SAMPLE
+	APU_SAMPLE,
+	EVENT_COUNT
 };
 
 // This class is not the same as BusARM9 and BusARM7.
 // It's a catch-all for shared memory, I/O registers, and other things that either don't warrant their own class or need to be seen by everything.
 class BusShared {
 public:
+	// The scheduler is checked after every slice, so its state goes first and stays together.
+	// When the ARM7 runs on its own thread, it gets its own copy of the current time.
+	// Anything that can be called by either CPU should use time() instead of currentTime.
+	alignas(64) u64 currentTime;
+	u64 nextEventTime; // Timestamp of the earliest pending event, or UINT64_MAX if there are none
+	u64 pendingEvents; // Bit n is set if event type n is scheduled
+	EventType nextEventType;
+	u64 eventTimes[EVENT_COUNT];
+	u64 &time() { return onArm7Thread ? arm7Time : currentTime; }
+	static thread_local bool onArm7Thread;
+
+	// The ARM7 thread writes this after every instruction, so it gets a cache line to itself
+	alignas(64) u64 arm7Time;
+
+	alignas(64) GuestMemory memory;
 	u8 *psram;
 	u8 *wram;
-	std::stringstream log;
 
 	BusShared();
 	~BusShared();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
 	u8 readIO9(u32 address);
 	void writeIO9(u32 address, u8 value);
@@ -76,18 +100,71 @@ public:
 	};
 	u8 WRAMCNT; // NDS9 - 0x4000247 aka. WRAMSTAT NDS7 - 0x4000241
 
-	// For the scheduler
-	struct Event {
-		u64 timeStamp;
-		EventType type;
-	};
-	struct eventSorter {
-		bool operator()(const Event &lhs, const Event &rhs);
+	// Set when a CPU or its DMA writes PSRAM or shared WRAM, since the other CPU might be polling a flag there.
+	// The other CPU's idle loop detection gets woken up at the start of the next slice. Either thread can set these.
+	alignas(64) std::atomic<bool> wakeArm9;
+	std::atomic<bool> wakeArm7;
+	static void requestWake(std::atomic<bool> &flag) {
+		if (!flag.load(std::memory_order_relaxed)) // Don't keep dirtying the cache line
+			flag.store(true, std::memory_order_relaxed);
+	}
+
+	// Page table refreshes are deferred to a single REFRESH_PAGES event so back to back bank changes only rebuild the tables once
+	enum PageRefresh {
+		PAGES_WRAM = 1 << 0,
+		PAGES_VRAM = 1 << 1,
+		PAGES_ROM = 1 << 2
 	};
+	void requestPageRefresh(PageRefresh pages);
+	u8 dirtyPages;
+	u64 coalescedRefreshes; // Requests that were folded into one that was already pending
+
+	// Held by either bus while touching state the other CPU can see (IPC, gamecard, and the registers above).
+	// Only contended when the ARM7 is running on its own thread.
+	std::mutex ioMutex;
 
+	// For the scheduler
+	// Every event type has exactly one slot. Adding an event that's already pending moves it instead of queueing a duplicate.
 	void addEvent(u64 cycles, EventType type);
 	void addEventAbsolute(u64 time, EventType type);
+	void cancelEvent(EventType type);
+	bool eventPending(EventType type);
+	EventType popEvent();
+	void refreshNextEvent();
+	std::mutex eventMutex; // Only taken during parallel slices
+
+	// Set while the ARM7 is running a slice on its own thread. Anything scheduled during the slice pulls sliceEnd in,
+	// so both CPUs stop there and the event gets handled before either of them goes past it.
+	bool parallelSlice;
+	std::atomic<u64> sliceEnd;
+
+	// Each component registers handlers for its own events. The payload is fixed when the handler is registered,
+	// so something like a timer channel can have its own slot and only do the work for that channel.
+	struct EventHandler {
+		void (*callback)(void *object, int arg);
+		void *object;
+		int arg;
+	};
+	EventHandler eventHandlers[EVENT_COUNT];
+	void registerEvent(EventType type, void (*callback)(void *object, int arg), void *object, int arg = 0);
+	void dispatchEvent(EventType type) {
+		auto& handler = eventHandlers[type];
+		handler.callback(handler.object, handler.arg);
+	}
+
+	// Anything can write to the log. The ARM7 thread writes to its own buffer, which gets moved over when the CPUs meet up.
+	struct Log {
+		std::stringstream main;
+		std::stringstream arm7;
 
-	u64 currentTime;
-	std::priority_queue<Event, std::vector<Event>, eventSorter> eventQueue;
+		template <typename T>
+		Log &operator<<(const T &value) {
+			(onArm7Thread ? arm7 : main) << value;
+			return *this;
+		}
+		std::string str() { return main.str(); }
+		void str(const std::string &text) { main.str(text); }
+		void merge();
+	};
+	Log log;
 };
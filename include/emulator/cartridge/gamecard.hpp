@@ -14,6 +14,8 @@ public:
 	Gamecard(std::shared_ptr<BusShared> shared);
 	~Gamecard();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
 	// Internal Use
 	u64 currentCommand;
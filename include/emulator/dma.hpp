@@ -3,13 +3,47 @@
 #include "emulator/dma.hpp"
 #include "types.hpp"
 #include "emulator/busshared.hpp"
+#include "emulator/iotable.hpp"
 
 // Forward declarations
 class BusARM9;
 class BusARM7;
 
+// The I/O registers are kept apart from the rest of the DMA so the register tables can use offsetof on them
+struct DmaRegisters {
+	struct DmaChannel {
+		u32 DMASAD;
+		u32 DMADAD;
+		union {
+			struct {
+				u32 length : 21;
+				u32 destinationControl : 2;
+				u32 sourceControl : 2;
+				u32 repeat : 1;
+				u32 transferType : 1;
+				u32 startTiming : 3;
+				u32 irqEnable : 1;
+				u32 enable : 1;
+			};
+			u32 DMACNT;
+		};
+
+		// Internal registers
+		u32 sourceAddress;
+		u32 destinationAddress;
+		u32 realLength; // What else am I supposed to name this? length is already taken.
+	};
+
+	DmaChannel channel[4]; // 0x40000B0 - 0x40000DF
+
+	u32 DMA0FILL; // NDS9 - 40000E0
+	u32 DMA1FILL; // NDS9 - 40000E4
+	u32 DMA2FILL; // NDS9 - 40000E8
+	u32 DMA3FILL; // NDS9 - 40000EC
+};
+
 template <bool dma9>
-class DMA {
+class DMA : public DmaRegisters {
 public:
 	std::shared_ptr<BusShared> shared;
 	using ArchBus = std::conditional_t<dma9, BusARM9, BusARM7>;
@@ -40,48 +74,143 @@ public:
 	DMA(std::shared_ptr<BusShared> shared, ArchBus &bus);
 	~DMA();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 	void checkDma(DmaStart event);
 
 	void reloadInternalRegisters(int channel);
 	void doDma(int channel);
 
-	// Memory Interface
-	u8 readIO9(u32 address);
-	void writeIO9(u32 address, u8 value);
-	u8 readIO7(u32 address);
-	void writeIO7(u32 address, u8 value);
-
-	// I/O Registers
-	struct DmaChannel {
-		u32 DMASAD;
-		u32 DMADAD;
-		union {
-			struct {
-				u32 length : 21;
-				u32 destinationControl : 2;
-				u32 sourceControl : 2;
-				u32 repeat : 1;
-				u32 transferType : 1;
-				u32 startTiming : 3;
-				u32 irqEnable : 1;
-				u32 enable : 1;
-			};
-			u32 DMACNT;
-		};
+	// Side effect of a DMACNT write in dma9Registers/dma7Registers
+	static void controlWritten(void *registers, u32 address, u32 old);
+};
 
-		// Internal registers
-		u32 sourceAddress;
-		u32 destinationAddress;
-		u32 realLength; // What else am I supposed to name this? length is already taken.
-	};
+// The DMA registers are all stored with a mask, and only DMACNT has to do anything after a write.
+// The bus's handlers and the debugger's entries for these are generated from this.
+namespace DmaFields {
+using enum IoFieldType;
 
-	DmaChannel channel[4]; // 0x40000B0 - 0x40000DF
+inline constexpr IoField address27[] = {
+	{"Address", 0, 27, TEXT_BOX_HEX}};
+inline constexpr IoField address28[] = {
+	{"Address", 0, 28, TEXT_BOX_HEX}};
+inline constexpr IoField control9[] = {
+	{"Word Count", 0, 21, TEXT_BOX_HEX},
+	{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
+										"Decrement\0"
+										"Fixed\0"
+										"Increment/Reload\0\0"},
+	{"Source Adr Control", 23, 2, COMBO, "Increment\0"
+										 "Decrement\0"
+										 "Fixed\0"
+										 "Prohibited\0\0"},
+	{"DMA Repeat", 25, 1, CHECKBOX},
+	{"DMA Transfer Type", 26, 1, CHECKBOX},
+	{"DMA Start Timing", 27, 3, COMBO, "Start Immediately\0"
+									   "Start at V-Blank\0"
+									   "Start at H-Blank\0"
+									   "Synchronize to start of display\0"
+									   "Main memory display\0"
+									   "DS Cartridge Slot\0"
+									   "GBA Cartridge Slot\0"
+									   "Geometry Command FIFO\0\0"},
+	{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
+	{"DMA Enable", 31, 1, CHECKBOX}};
+// Channels 0 and 2 can start on a wireless interrupt where 1 and 3 start on the GBA slot, and channel 3 has a longer word count
+inline constexpr IoField control7Wireless[] = {
+	{"Word Count", 0, 14, TEXT_BOX_HEX},
+	{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
+										"Decrement\0"
+										"Fixed\0"
+										"Increment/Reload\0\0"},
+	{"Source Adr Control", 23, 2, COMBO, "Increment\0"
+										 "Decrement\0"
+										 "Fixed\0"
+										 "Prohibited\0\0"},
+	{"DMA Repeat", 25, 1, CHECKBOX},
+	{"DMA Transfer Type", 26, 1, CHECKBOX},
+	{"DMA Start Timing", 28, 2, COMBO, "Start Immediately\0"
+									   "Start at V-Blank\0"
+									   "DS Cartridge Slot\0"
+									   "Wireless interrupt\0\0"},
+	{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
+	{"DMA Enable", 31, 1, CHECKBOX}};
+inline constexpr IoField control7Gba[] = {
+	{"Word Count", 0, 14, TEXT_BOX_HEX},
+	{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
+										"Decrement\0"
+										"Fixed\0"
+										"Increment/Reload\0\0"},
+	{"Source Adr Control", 23, 2, COMBO, "Increment\0"
+										 "Decrement\0"
+										 "Fixed\0"
+										 "Prohibited\0\0"},
+	{"DMA Repeat", 25, 1, CHECKBOX},
+	{"DMA Transfer Type", 26, 1, CHECKBOX},
+	{"DMA Start Timing", 28, 2, COMBO, "Start Immediately\0"
+									   "Start at V-Blank\0"
+									   "DS Cartridge Slot\0"
+									   "GBA Cartridge Slot\0\0"},
+	{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
+	{"DMA Enable", 31, 1, CHECKBOX}};
+inline constexpr IoField control7Channel3[] = {
+	{"Word Count", 0, 16, TEXT_BOX_HEX},
+	{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
+										"Decrement\0"
+										"Fixed\0"
+										"Increment/Reload\0\0"},
+	{"Source Adr Control", 23, 2, COMBO, "Increment\0"
+										 "Decrement\0"
+										 "Fixed\0"
+										 "Prohibited\0\0"},
+	{"DMA Repeat", 25, 1, CHECKBOX},
+	{"DMA Transfer Type", 26, 1, CHECKBOX},
+	{"DMA Start Timing", 28, 2, COMBO, "Start Immediately\0"
+									   "Start at V-Blank\0"
+									   "DS Cartridge Slot\0"
+									   "GBA Cartridge Slot\0\0"},
+	{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
+	{"DMA Enable", 31, 1, CHECKBOX}};
+inline constexpr IoField fill[] = {
+	{"Filldata", 0, 32, TEXT_BOX_HEX}};
+}
 
-	u32 DMA0FILL; // NDS9 - 40000E0
-	u32 DMA1FILL; // NDS9 - 40000E4
-	u32 DMA2FILL; // NDS9 - 40000E8
-	u32 DMA3FILL; // NDS9 - 40000EC
+#define DMA_REGISTER(member) offsetof(DmaRegisters, member)
+inline constexpr IoRegisterInfo dma9Registers[] = {
+	{"DMA0SAD", "DMA 0 Source Address", 0x40000B0, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[0].DMASAD), nullptr, DmaFields::address28},
+	{"DMA0DAD", "DMA 0 Destination Address", 0x40000B4, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[0].DMADAD), nullptr, DmaFields::address28},
+	{"DMA0CNT", "DMA 0 Control", 0x40000B8, 4, 0xFFFFFFFF, 0xFFFFFFFF, DMA_REGISTER(channel[0].DMACNT), DMA<true>::controlWritten, DmaFields::control9},
+	{"DMA1SAD", "DMA 1 Source Address", 0x40000BC, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[1].DMASAD), nullptr, DmaFields::address28},
+	{"DMA1DAD", "DMA 1 Destination Address", 0x40000C0, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[1].DMADAD), nullptr, DmaFields::address28},
+	{"DMA1CNT", "DMA 1 Control", 0x40000C4, 4, 0xFFFFFFFF, 0xFFFFFFFF, DMA_REGISTER(channel[1].DMACNT), DMA<true>::controlWritten, DmaFields::control9},
+	{"DMA2SAD", "DMA 2 Source Address", 0x40000C8, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[2].DMASAD), nullptr, DmaFields::address28},
+	{"DMA2DAD", "DMA 2 Destination Address", 0x40000CC, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[2].DMADAD), nullptr, DmaFields::address28},
+	{"DMA2CNT", "DMA 2 Control", 0x40000D0, 4, 0xFFFFFFFF, 0xFFFFFFFF, DMA_REGISTER(channel[2].DMACNT), DMA<true>::controlWritten, DmaFields::control9},
+	{"DMA3SAD", "DMA 3 Source Address", 0x40000D4, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[3].DMASAD), nullptr, DmaFields::address28},
+	{"DMA3DAD", "DMA 3 Destination Address", 0x40000D8, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[3].DMADAD), nullptr, DmaFields::address28},
+	{"DMA3CNT", "DMA 3 Control", 0x40000DC, 4, 0xFFFFFFFF, 0xFFFFFFFF, DMA_REGISTER(channel[3].DMACNT), DMA<true>::controlWritten, DmaFields::control9},
+	{"DMA0FILL", "DMA 0 Filldata", 0x40000E0, 4, 0xFFFFFFFF, 0xFFFFFFFF, DMA_REGISTER(DMA0FILL), nullptr, DmaFields::fill},
+	{"DMA1FILL", "DMA 1 Filldata", 0x40000E4, 4, 0xFFFFFFFF, 0xFFFFFFFF, DMA_REGISTER(DMA1FILL), nullptr, DmaFields::fill},
+	{"DMA2FILL", "DMA 2 Filldata", 0x40000E8, 4, 0xFFFFFFFF, 0xFFFFFFFF, DMA_REGISTER(DMA2FILL), nullptr, DmaFields::fill},
+	{"DMA3FILL", "DMA 3 Filldata", 0x40000EC, 4, 0xFFFFFFFF, 0xFFFFFFFF, DMA_REGISTER(DMA3FILL), nullptr, DmaFields::fill},
+};
+// The NDS7 has no fill registers, and which channels can reach the whole bus depends on the channel
+inline constexpr IoRegisterInfo dma7Registers[] = {
+	{"DMA0SAD", "DMA 0 Source Address", 0x40000B0, 4, 0xFFFFFFFF, 0x07FFFFFE, DMA_REGISTER(channel[0].DMASAD), nullptr, DmaFields::address27},
+	{"DMA0DAD", "DMA 0 Destination Address", 0x40000B4, 4, 0xFFFFFFFF, 0x07FFFFFE, DMA_REGISTER(channel[0].DMADAD), nullptr, DmaFields::address27},
+	{"DMA0CNT", "DMA 0 Control", 0x40000B8, 4, 0xFFFFFFFF, 0xF7E03FFF, DMA_REGISTER(channel[0].DMACNT), DMA<false>::controlWritten, DmaFields::control7Wireless},
+	{"DMA1SAD", "DMA 1 Source Address", 0x40000BC, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[1].DMASAD), nullptr, DmaFields::address28},
+	{"DMA1DAD", "DMA 1 Destination Address", 0x40000C0, 4, 0xFFFFFFFF, 0x07FFFFFE, DMA_REGISTER(channel[1].DMADAD), nullptr, DmaFields::address27},
+	{"DMA1CNT", "DMA 1 Control", 0x40000C4, 4, 0xFFFFFFFF, 0xF7E03FFF, DMA_REGISTER(channel[1].DMACNT), DMA<false>::controlWritten, DmaFields::control7Gba},
+	{"DMA2SAD", "DMA 2 Source Address", 0x40000C8, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[2].DMASAD), nullptr, DmaFields::address28},
+	{"DMA2DAD", "DMA 2 Destination Address", 0x40000CC, 4, 0xFFFFFFFF, 0x07FFFFFE, DMA_REGISTER(channel[2].DMADAD), nullptr, DmaFields::address27},
+	{"DMA2CNT", "DMA 2 Control", 0x40000D0, 4, 0xFFFFFFFF, 0xF7E03FFF, DMA_REGISTER(channel[2].DMACNT), DMA<false>::controlWritten, DmaFields::control7Wireless},
+	{"DMA3SAD", "DMA 3 Source Address", 0x40000D4, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[3].DMASAD), nullptr, DmaFields::address28},
+	{"DMA3DAD", "DMA 3 Destination Address", 0x40000D8, 4, 0xFFFFFFFF, 0x0FFFFFFE, DMA_REGISTER(channel[3].DMADAD), nullptr, DmaFields::address28},
+	{"DMA3CNT", "DMA 3 Control", 0x40000DC, 4, 0xFFFFFFFF, 0xF7E0FFFF, DMA_REGISTER(channel[3].DMACNT), DMA<false>::controlWritten, DmaFields::control7Channel3},
 };
+#undef DMA_REGISTER
+static_assert(ioRegistersWithin(dma9Registers, sizeof(DmaRegisters)) && ioRegistersWithin(dma7Registers, sizeof(DmaRegisters)));
 
 #include "emulator/nds9/busarm9.hpp"
 #include "emulator/nds7/busarm7.hpp"
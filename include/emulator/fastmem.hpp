@@ -0,0 +1,69 @@
+#pragma once
+
+#include "types.hpp"
+#include "emulator/guestmemory.hpp"
+
+#include <atomic>
+#include <memory>
+
+// Maps one CPU's whole 32-bit address space onto host memory, so a load or store is just base plus address.
+// 4GB is reserved with no access. Each 16KB page the bus's page table points into guest memory gets that part of the
+// guest memory file mapped over it, so mirrors really are the same memory. Everything else stays inaccessible.
+// Touching one of those pages faults. The handler makes that page accessible so the instruction can finish, then the
+// bus sees the fault flag, puts the page back, and does the access through the page tables like before.
+// Only on Linux for now, since it needs memfd. Debuggers will stop on the SIGSEGVs unless told to pass them through.
+class Fastmem {
+public:
+	static constexpr u64 RESERVATION_SIZE = 0x100000000;
+	static constexpr u32 PAGE_SIZE = 0x4000; // Same as the bus page tables
+	static constexpr u32 PAGE_COUNT = 0x4000; // Pages covered by the tables. 0x10000000 and up is never mapped.
+
+	u8 *base; // nullptr when disabled
+
+	Fastmem();
+	~Fastmem();
+	int enable(GuestMemory &memory); // Returns 0 or an errno value
+	void disable();
+	// Brings the mappings in line with a bus's page tables. Only pages that changed get touched.
+	// Pages where reads and writes go to different places can't be mapped.
+	void remap(u8 *const *readTable, u8 *const *writeTable);
+
+	// Each bit is a 16MB region of the bottom 256MB. Regions that aren't mostly guest memory would fault on every access.
+	static bool covers(u32 address, u16 regions) { return (address < 0x10000000) && ((regions >> (address >> 24)) & 1); }
+
+	// Both return false if the page wasn't mapped, and the access has to go the slow way
+	template <typename T>
+	bool read(u32 address, T &value) {
+		value = GuestMemory::load<T>(base + address);
+		std::atomic_signal_fence(std::memory_order_seq_cst); // Don't let the flag check move above the access
+		if (faultPage) [[unlikely]] {
+			recover();
+			return false;
+		}
+		return true;
+	}
+	template <typename T>
+	bool write(u32 address, T value) {
+		GuestMemory::store<T>(base + address, value);
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+		if (faultPage) [[unlikely]] {
+			recover();
+			return false;
+		}
+		return true;
+	}
+
+	// Set by the signal handler on the thread that faulted
+	static inline thread_local u8 *faultPage = nullptr;
+
+	struct Reservation;
+
+private:
+	GuestMemory *memory;
+	Reservation *slot; // Where this reservation is registered with the signal handler
+	std::unique_ptr<u8 *[]> shadow; // What each page is mapped to right now
+
+	u8 *mappable(u8 *pointer);
+	void mapRun(u32 firstPage, u32 count, u8 *target);
+	void recover();
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "types.hpp"
+#include <atomic>
+#include <chrono>
+
+// Keeps the emulator thread running at a fixed multiple of the real DS frame rate
+class FramePacer {
+public:
+	static constexpr double FRAME_RATE = 59.8261; // 33513982Hz / 6 / 355 dots / 263 lines
+
+	enum Mode {
+		REALTIME,
+		UNCAPPED,
+		FAST_FORWARD
+	};
+	enum FastForwardAudio {
+		AUDIO_NORMAL,
+		AUDIO_MUTE,
+		AUDIO_DECIMATE // Only keep every Nth sample so the audio plays at normal speed
+	};
+
+	// Set by the GUI, and read by the emulator and audio threads
+	std::atomic<Mode> mode;
+	std::atomic<int> fastForwardMultiplier;
+	std::atomic<FastForwardAudio> fastForwardAudio;
+	std::atomic<double> speedPercent; // Emulated frames per second compared to a real DS, averaged over the last second
+
+	FramePacer();
+	~FramePacer();
+	void reset();
+	void frame();
+
+	double targetSpeed();
+	bool audioMuted();
+	int audioDecimation();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	Clock::time_point nextFrameTime;
+	Clock::time_point lastSpeedPoll;
+	int framesSinceSpeedPoll;
+};
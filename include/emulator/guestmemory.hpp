@@ -0,0 +1,65 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <atomic>
+
+// All of the emulated RAM and BIOS lives in one block at fixed offsets.
+// It's backed by 2MB pages when the OS allows it, so the whole thing only takes a few TLB entries, and anything that
+// wants to see all of memory at once (snapshots, fastmem) only needs one base pointer.
+// Palettes and OAM stay inside the PPU. TCM is in here so the ARM9 page tables and fastmem can point at it like any other memory.
+class GuestMemory {
+public:
+	enum RegionId {
+		PSRAM,
+		VRAM,
+		SHARED_WRAM,
+		ARM7_WRAM,
+		ARM9_BIOS,
+		ARM7_BIOS,
+		ITCM,
+		DTCM,
+		WIFI_RAM,
+		REGION_COUNT
+	};
+	struct Region {
+		const char *name;
+		size_t offset;
+		size_t size;
+	};
+	static constexpr Region layout[REGION_COUNT] = {
+		{"PSRAM", 0x000000, 0x400000}, // First so it starts on a huge page
+		{"VRAM", 0x400000, 0xA4000},
+		{"Shared WRAM", 0x4A4000, 0x8000},
+		{"ARM7 WRAM", 0x4AC000, 0x10000},
+		{"ARM9 BIOS", 0x4BC000, 0x8000},
+		{"ARM7 BIOS", 0x4C4000, 0x4000},
+		{"ITCM", 0x4C8000, 0x8000},
+		{"DTCM", 0x4D0000, 0x4000},
+		{"Wi-Fi RAM", 0x4D4000, 0x2000} // Last, since it's the only region that isn't a whole number of 16KB pages
+	};
+	static constexpr size_t HUGE_PAGE_SIZE = 0x200000;
+	static constexpr size_t SIZE = (layout[REGION_COUNT - 1].offset + layout[REGION_COUNT - 1].size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+	u8 *base;
+	enum {
+		PAGES_NORMAL,
+		PAGES_TRANSPARENT_HUGE, // Asked for with madvise(). The kernel might still not give them.
+		PAGES_EXPLICIT_HUGE // MAP_HUGETLB
+	} pageType;
+	int fd; // Backing file once the arena has been shared, otherwise -1
+
+	GuestMemory();
+	~GuestMemory();
+	// Moves the arena into a memfd without changing its address, so parts of it can be mapped somewhere else too.
+	// Returns 0 or an errno value. Nothing else can be touching guest memory while this runs.
+	int share();
+	u8 *operator[](RegionId region) { return base + layout[region].offset; }
+
+	// For anything both CPUs can reach, since the ARM7 thread can be touching it at the same time.
+	// Relaxed atomics are the same plain loads and stores on the hosts we build for. Pointers have to be aligned to sizeof(T).
+	template <typename T>
+	static T load(const u8 *pointer) { return std::atomic_ref<T>(*(T *)pointer).load(std::memory_order_relaxed); }
+	template <typename T>
+	static void store(u8 *pointer, T value) { std::atomic_ref<T>(*(T *)pointer).store(value, std::memory_order_relaxed); }
+};
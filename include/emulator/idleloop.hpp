@@ -0,0 +1,58 @@
+#pragma once
+
+#include "types.hpp"
+#include <string>
+
+// Watches a CPU for short polling loops that can't end until something outside the CPU changes.
+// A loop counts as idle once it makes it back to the same branch target with identical registers several times in a row
+// without writing anything or reading I/O registers that change on their own (timers, math busy flags, etc.).
+class IdleLoopDetector {
+public:
+	static constexpr u32 MAX_LOOP_SIZE = 0x40; // Bytes between the loop head and the branch back to it
+	static constexpr int REQUIRED_MATCHES = 2;
+
+	struct Override {
+		bool arm9;
+		bool arm7;
+	};
+	static Override lookupOverride(const std::string &gameCode);
+
+	bool enabled;
+	bool idle; // Set when a loop is detected. Cleared by the scheduler when the next event happens.
+	bool active; // The CPU is currently inside a candidate loop
+	bool clean; // Nothing in the current iteration has disqualified the loop
+
+	IdleLoopDetector();
+	~IdleLoopDetector();
+	void reset();
+	void wake();
+
+	// Call before every instruction. Returns true once the loop has been identified as idle.
+	bool instruction(u32 pc, const u32 *reg, u32 cpsr) {
+		u32 last = lastPc;
+		lastPc = pc;
+
+		if ((pc > last) || ((last - pc) > MAX_LOOP_SIZE)) { [[likely]] // Not a short backwards branch (or a branch to itself)
+			if (active && ((pc < loopStart) || (pc > loopEnd)))
+				active = false;
+			return false;
+		}
+
+		return loopHead(pc, last, reg, cpsr);
+	}
+
+	// Memory Interface
+	void write() { clean = false; }
+	void read(u32 address) { if (!pollable(address)) clean = false; } // Only needed for reads that miss the page tables
+	static bool pollable(u32 address);
+
+private:
+	bool loopHead(u32 pc, u32 branchPc, const u32 *reg, u32 cpsr);
+
+	u32 lastPc;
+	u32 loopStart;
+	u32 loopEnd;
+	int matches;
+	u32 savedReg[15];
+	u32 savedCpsr;
+};
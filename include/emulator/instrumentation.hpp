@@ -0,0 +1,21 @@
+#pragma once
+
+// Debugging features the core can be built without.
+// The debug policy keeps everything, each feature still switched on and off by its own runtime flag (traceArm9, logDma, etc.).
+// The release policy compiles them out, so runs that never use them don't pay for the checks or the string formatting.
+// OrtinCore is built with the debug policy and OrtinCoreRelease with the release one.
+struct DebugInstrumentation {
+	static constexpr bool logging = true; // Component logs and accesses to unknown addresses
+	static constexpr bool debugger = true; // Instruction tracing, single stepping, and reverse debugging
+};
+
+struct ReleaseInstrumentation {
+	static constexpr bool logging = false;
+	static constexpr bool debugger = false;
+};
+
+#ifdef ORTIN_RELEASE_CORE
+using Instrumentation = ReleaseInstrumentation;
+#else
+using Instrumentation = DebugInstrumentation;
+#endif
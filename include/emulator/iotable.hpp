@@ -0,0 +1,198 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <span>
+#include <string_view>
+
+// How the debugger shows part of a register
+enum class IoFieldType {
+	TEXT_BOX,
+	TEXT_BOX_HEX,
+	CHECKBOX,
+	COMBO,
+	SPECIAL
+};
+
+struct IoField {
+	std::string_view name;
+	int startBit;
+	int length;
+	IoFieldType type;
+	const char *comboText = nullptr;
+};
+
+// A register that's just a value stored somewhere, plus whatever has to happen after it's written.
+// A table of these is enough for IoTable to generate the handlers and for the debugger to show and edit them.
+struct IoRegisterInfo {
+	std::string_view name;
+	std::string_view description;
+	u32 address;
+	int size;
+	u32 readMask; // 0 if it can't be read
+	u32 writeMask; // 0 if it can't be written
+	size_t offset; // Where the value is in the object the handlers are given
+	void (*written)(void *object, u32 address, u32 old); // Side effects after the new value is stored, or nullptr
+	std::span<const IoField> fields;
+};
+
+// Save states write the object a table points into as one block, along with the internal state next to the registers,
+// instead of going through the table. This checks that the block really covers every register in the table.
+constexpr bool ioRegistersWithin(std::span<const IoRegisterInfo> registers, size_t size) {
+	for (auto& reg : registers) {
+		if ((reg.offset + reg.size) > size)
+			return false;
+	}
+	return true;
+}
+
+// Sends I/O register accesses straight to the component that owns the register.
+// Components register handlers for the widths they can take, and the bus looks the handler up by address in a flat table.
+// If every byte of an access belongs to the same handler, and that handler has a function for that width, it's one call.
+// Otherwise the access is split in halves until it is, with final only set on the last piece, like the old byte-by-byte path.
+class IoTable {
+public:
+	struct Handler {
+		void *object;
+		u8 (*read8)(void *object, u32 address, bool final);
+		u16 (*read16)(void *object, u32 address, bool final);
+		u32 (*read32)(void *object, u32 address, bool final);
+		void (*write8)(void *object, u32 address, u8 value, bool final);
+		void (*write16)(void *object, u32 address, u16 value, bool final);
+		void (*write32)(void *object, u32 address, u32 value, bool final);
+	};
+
+	IoTable();
+	~IoTable();
+	// Gets every byte no handler was added for, including anything outside the table. Needs read8 and write8.
+	void setFallback(Handler handler);
+	// End is inclusive. Leaving read8 or write8 out means the handler doesn't take part in that direction at all.
+	void add(u32 start, u32 end, Handler handler);
+	// Adds handlers for every register in a table, with offset added to each address. All of it is generated at compile
+	// time, so the masks and sizes are constants in the handlers.
+	template <auto &registers>
+	void addRegisters(void *object, u32 offset) {
+		[&]<size_t... i>(std::index_sequence<i...>) {
+			(addRegister<registers, i>(object, offset), ...);
+		}(std::make_index_sequence<std::size(registers)>());
+	}
+
+	template <typename T>
+	T read(u32 address, bool final) {
+		Handler *handler = handlerFor<T>(readIndex, address);
+		if constexpr (sizeof(T) == 1) {
+			return handler->read8(handler->object, address, final);
+		} else {
+			if constexpr (sizeof(T) == 4) {
+				if (handler && handler->read32) [[likely]]
+					return handler->read32(handler->object, address, final);
+			} else {
+				if (handler && handler->read16) [[likely]]
+					return handler->read16(handler->object, address, final);
+			}
+
+			using Half = std::conditional_t<sizeof(T) == 4, u16, u8>;
+			T low = read<Half>(address, false);
+			return low | ((T)read<Half>(address + sizeof(Half), final) << (sizeof(Half) * 8));
+		}
+	}
+
+	template <typename T>
+	void write(u32 address, T value, bool final) {
+		Handler *handler = handlerFor<T>(writeIndex, address);
+		if constexpr (sizeof(T) == 1) {
+			handler->write8(handler->object, address, value, final);
+		} else {
+			if constexpr (sizeof(T) == 4) {
+				if (handler && handler->write32) [[likely]] {
+					handler->write32(handler->object, address, value, final);
+					return;
+				}
+			} else {
+				if (handler && handler->write16) [[likely]] {
+					handler->write16(handler->object, address, value, final);
+					return;
+				}
+			}
+
+			using Half = std::conditional_t<sizeof(T) == 4, u16, u8>;
+			write<Half>(address, (Half)value, false);
+			write<Half>(address + sizeof(Half), (Half)(value >> (sizeof(Half) * 8)), final);
+		}
+	}
+
+private:
+	// Covers 0x4000000 - 0x4001FFF and 0x4100000 - 0x4101FFF, which is everything but WiFi.
+	// It goes by byte instead of by halfword because a few halfwords are split between components, like 0x4000246
+	// where VRAMCNT_G is the PPU's and WRAMCNT is shared.
+	std::vector<Handler> handlers; // 0 is the fallback
+	u16 readIndex[0x4000]; // addRegisters() adds a handler per register, so there can be more than 256
+	u16 writeIndex[0x4000];
+
+	static bool inTable(u32 address) { return (address & 0xFFEFE000) == 0x4000000; }
+	static u32 toIndex(u32 address) { return ((address >> 7) & 0x2000) | (address & 0x1FFF); }
+
+	template <auto &registers, size_t i>
+	void addRegister(void *object, u32 offset) {
+		constexpr const IoRegisterInfo &reg = registers[i];
+		static_assert(((reg.size == 1) || (reg.size == 2) || (reg.size == 4)) && !(reg.address & (reg.size - 1)));
+
+		Handler handler = {.object = object,
+			.read8 = readRegister<registers, i, u8>,
+			.write8 = writeRegister<registers, i, u8>};
+		if constexpr (reg.size >= 2) {
+			handler.read16 = readRegister<registers, i, u16>;
+			handler.write16 = writeRegister<registers, i, u16>;
+		}
+		if constexpr (reg.size == 4) {
+			handler.read32 = readRegister<registers, i, u32>;
+			handler.write32 = writeRegister<registers, i, u32>;
+		}
+		add(reg.address + offset, reg.address + offset + reg.size - 1, handler);
+	}
+
+	// Registers are aligned, so the low bits of the address are where in the register the access starts
+	template <auto &registers, size_t i, typename T>
+	static T readRegister(void *object, u32 address, bool final) {
+		constexpr const IoRegisterInfo &reg = registers[i];
+		u32 value = 0;
+		memcpy(&value, (u8 *)object + reg.offset, reg.size);
+		return (T)((value & reg.readMask) >> ((address & (reg.size - 1)) * 8));
+	}
+
+	template <auto &registers, size_t i, typename T>
+	static void writeRegister(void *object, u32 address, T value, bool final) {
+		constexpr const IoRegisterInfo &reg = registers[i];
+		if constexpr (reg.writeMask != 0) {
+			int shift = (address & (reg.size - 1)) * 8;
+			u32 mask = reg.writeMask & ((u32)(T)~0 << shift);
+
+			u32 old = 0;
+			memcpy(&old, (u8 *)object + reg.offset, reg.size);
+			u32 stored = (old & ~mask) | (((u32)value << shift) & mask);
+			memcpy((u8 *)object + reg.offset, &stored, reg.size);
+
+			if constexpr (reg.written != nullptr)
+				reg.written(object, address, old);
+		}
+	}
+
+	// nullptr if the access is split between handlers
+	template <typename T>
+	Handler *handlerFor(const u16 *index, u32 address) {
+		if (!inTable(address)) [[unlikely]]
+			return &handlers[0];
+
+		const u16 *entry = &index[toIndex(address)];
+		if constexpr (sizeof(T) == 4) {
+			u64 all;
+			memcpy(&all, entry, sizeof(all));
+			if (all != (entry[0] * 0x0001000100010001))
+				return nullptr;
+		} else if constexpr (sizeof(T) == 2) {
+			if (entry[0] != entry[1])
+				return nullptr;
+		}
+		return &handlers[entry[0]];
+	}
+};
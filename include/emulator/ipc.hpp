@@ -11,12 +11,22 @@ public:
 	IPC(std::shared_ptr<BusShared> shared);
 	~IPC();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
 	// Memory Interface
 	u8 readIO9(u32 address, bool final);
 	void writeIO9(u32 address, u8 value, bool final);
 	u8 readIO7(u32 address, bool final);
 	void writeIO7(u32 address, u8 value, bool final);
+	void send9(u32 value); // IPCFIFOSEND and IPCFIFORECV as whole words
+	u32 receive9();
+	void send7(u32 value);
+	u32 receive7();
+	void pushFifo9(u32 value);
+	void popFifo9();
+	void pushFifo7(u32 value);
+	void popFifo7();
 
 	// I/O Registers
 	union {
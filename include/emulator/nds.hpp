@@ -1,19 +1,30 @@
 #pragma once
 
+#include <condition_variable>
 #include <memory>
 
 #include "types.hpp"
 #include "busshared.hpp"
 #include "ipc.hpp"
 #include "ppu.hpp"
+#include "framepacer.hpp"
+#include "savestate.hpp"
+#include "rewind.hpp"
+#include "statehash.hpp"
+#include "timetravel.hpp"
+#include "spscqueue.hpp"
 #include "emulator/cartridge/gamecard.hpp"
 #include "emulator/nds9/busarm9.hpp"
 #include "emulator/nds7/busarm7.hpp"
 #include "arm946e/arm946edisasm.hpp"
 #include "arm7tdmi/arm7tdmidisasm.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <ctime>
 #include <filesystem>
-#include <mutex>
+#include <thread>
+#include <variant>
 #include <system_error>
 
 #include "mio/mmap.hpp"
@@ -27,9 +38,28 @@ public:
 	std::shared_ptr<BusARM9> nds9;
 	std::shared_ptr<BusARM7> nds7;
 
+	// Everything the main loop looks at on every step, kept together so it only takes a couple of cache lines.
+	// Big or rarely touched state (framebuffers, history, file maps, etc.) goes further down.
+	alignas(64) u64 nds9timestamp;
+	u64 cycleLimit;
+	int syncQuantum; // Max cycles one CPU can run ahead of the other. 0 runs them in lockstep.
+	std::atomic<bool> running; // Written by the emulator thread and read by the GUI
+	std::atomic<bool> stepArm9;
+	std::atomic<bool> stepArm7;
+	bool frameEnded;
 	bool traceArm9;
-	ARM946EDisassembler disassembler9;
 	bool traceArm7;
+	bool threadedArm7; // Runs the ARM7 on its own host thread
+	bool idleLoopDetection; // Lets a CPU sleep until the next event when it's stuck polling something
+	bool speculative; // Running frames that are going to be rolled back
+	bool timeTravelEnabled; // Recording history for reverse debugging
+
+	// Written by the ARM7 thread after every instruction, so it gets a cache line to itself
+	alignas(64) u64 nds7timestamp;
+
+	alignas(64) FramePacer pacer;
+
+	ARM946EDisassembler disassembler9;
 	ARM7TDMIDisassembler disassembler7;
 
 	struct {
@@ -40,6 +70,7 @@ public:
 		std::filesystem::path firmwareFilePath;
 
 		std::string name; // 12 bytes - 0x000
+		std::string gameCode; // 4 bytes - 0x00C
 		u8 version; // 1 byte - 0x01E
 		bool autostart; // 1 byte - 0x01F
 
@@ -60,6 +91,96 @@ public:
 	void directBoot();
 	void run();
 
+	// Synchronous interface for running the core without the emulator thread
+	void runFrame();
+	void runCycles(u64 cycles);
+	const u16 *getFramebuffer(int engine); // 256x192 ABGR1555
+	int pullAudio(i16 *buffer, int maxSamples);
+	void setKeys(u32 keys);
+	void setTouch(u8 x, u8 y);
+	int setFastmem(bool enable); // Only while the CPUs are stopped. Returns 0 or an errno value.
+
+	// Save states. Buffers can be reused between saves to avoid reallocating.
+	void saveState(std::vector<u8> &buffer);
+	void saveState(StateWriter &state);
+	int loadState(const u8 *data, size_t size);
+	int saveStateFile(std::filesystem::path path);
+	int loadStateFile(std::filesystem::path path);
+
+	// Rewind
+	bool rewindEnabled;
+	int rewindInterval; // Frames between snapshots
+	int rewindBudget; // MB
+	std::atomic<bool> rewinding; // Set by the GUI while the rewind key is held. Steps back one snapshot per frame instead of running.
+	RewindBuffer rewind;
+	std::vector<u8> rewindScratch;
+	int framesSinceSnapshot;
+	u64 rewindCaptureTime; // Microseconds the last snapshot took
+	void captureRewind();
+	bool stepBack();
+
+	// Run-ahead. After each real frame, runs a few more with the same input and shows the last one, then goes back.
+	// Cuts out the frames of latency from games that read input late. The threaded version runs the extra frames on a
+	// second instance so this one never has to roll back.
+	int runAheadFrames; // 0 turns it off
+	bool runAheadThreaded;
+	std::vector<u8> runAheadState;
+	void runAhead();
+
+	std::unique_ptr<NDS> aheadInstance;
+	std::vector<u8> aheadFirmware; // The second instance's own copy, so frames that get thrown away can't write to the real file
+	std::thread aheadThread;
+	std::atomic<bool> aheadThreadExit;
+	std::atomic<u64> aheadRequested;
+	std::atomic<u64> aheadFinished;
+	std::atomic<bool> aheadFrameReady; // The second instance's framebuffers have a frame that hasn't been shown yet
+	std::mutex aheadMutex; // Only so the emulator thread can wait on aheadDone with a timeout
+	std::condition_variable aheadDone;
+	void startAheadThread();
+	void stopAheadThread();
+	void aheadThreadLoop();
+
+	// Boot snapshots. The first cold boot of a game saves the machine once the ARM9 reaches the game's entry point,
+	// and later resets load that instead of running through the BIOS and firmware again.
+	// Snapshots are named by game code and header CRC, and are only used if the header, BIOS, and firmware all still match.
+	bool bootCache;
+	std::filesystem::path bootCacheDirectory;
+	bool bootSnapshotPending; // Waiting for the ARM9 to reach the entry point
+	bool bootArm7Entered; // The ARM7 got to its entry point first, so it's out of the BIOS
+	std::filesystem::path bootSnapshotPath();
+	void bootHashes(u64 hashes[4]);
+	bool loadBootSnapshot();
+	void captureBootSnapshot();
+
+	// Determinism checking. Hashes are taken at the start of every VBlank.
+	StateHasher hasher;
+	void hashFrame();
+
+	// Reverse debugging. While history is being recorded the CPUs always run in lockstep, so the debugger can go back to any
+	// instruction by loading the keyframe before it and replaying.
+	int keyframeInterval; // Frames between keyframes
+	int timeTravelBudget; // MB
+	TimeTravel history;
+	std::vector<u8> keyframeScratch;
+	void recordStep();
+	void loadKeyframe(const TimeTravel::Keyframe &keyframe);
+	bool replayTick();
+	void seekTick(u64 ticks);
+	bool reverseStep(bool arm9);
+	bool reverseContinue();
+	void endReplay();
+
+	void runStep();
+	void runSlice();
+	template <bool parallel> void runArm9(u64 sliceEnd);
+	template <bool parallel> void runArm7(u64 sliceEnd);
+	void runLockstep();
+	void handleEvents();
+	void lineStartEvent();
+	void hBlankEvent();
+	void refreshPagesEvent();
+	void gamecardEvent(EventType type);
+
 	// Thread-safe queue
 	enum threadEventType {
 		STOP,
@@ -73,24 +194,66 @@ public:
 		LOAD_FIRMWARE,
 		CLEAR_LOG,
 		UPDATE_KEYS,
-		SET_TIME
+		SET_TIME,
+		SAVE_STATE,
+		LOAD_STATE,
+		REWIND,
+		RECORD_HASHES,
+		CHECK_HASHES,
+		STOP_HASHES,
+		REVERSE_STEP_ARM9,
+		REVERSE_STEP_ARM7,
+		REVERSE_CONTINUE,
+		ENABLE_FASTMEM,
+		DISABLE_FASTMEM
+	};
+	// Payloads are owned by the event so the GUI doesn't have to keep anything alive
+	struct KeyState {
+		u32 keys;
+		u8 touchX, touchY;
 	};
+	struct RealTime {
+		std::time_t time;
+	};
+	using threadEventArg = std::variant<std::monostate, std::filesystem::path, KeyState, RealTime>;
 	struct threadEvent {
 		threadEventType type;
-		u64 intArg;
-		void *ptrArg;
+		threadEventArg arg;
+		std::chrono::steady_clock::time_point queuedTime;
 	};
-	std::queue<threadEvent> threadQueue;
-	std::mutex threadQueueMutex;
+	SpscQueue<threadEvent, 64> threadQueue; // The GUI thread is the only producer
+	std::atomic<u64> resumeLatency; // Microseconds between the last START being queued and the emulator actually running
 	void handleThreadQueue();
-	void addThreadEvent(threadEventType type);
-	void addThreadEvent(threadEventType type, u64 intArg);
-	void addThreadEvent(threadEventType type, void *ptrArg);
-	void addThreadEvent(threadEventType type, u64 intArg, void *ptrArg);
-
-	bool running;
-	bool stepArm9;
-	bool stepArm7;
+	void addThreadEvent(threadEventType type, threadEventArg arg = {});
+
+	// The threaded ARM7 only meets up with the ARM9 between slices and at events. It's opt-in and off by default, because
+	// it isn't exact:
+	// - Anything one CPU does to the other (IPC, shared memory, VRAM/WRAM bank changes, events it schedules) can reach the
+	//   other CPU up to syncQuantum cycles late, since that CPU might already be further along in the slice.
+	// - How far each CPU gets before it sees something depends on the host, so two runs aren't guaranteed to match.
+	//   Hashing and history recording always keep the ARM7 on the emulator thread.
+	// Each side spins for a while before blocking, since the other one is usually only a slice away. Handing a slice over
+	// still has a fixed cost, so slices too short to make up for it run on the emulator thread like they would without it.
+	std::thread arm7Thread;
+	std::atomic<bool> arm7ThreadExit;
+	alignas(64) std::atomic<u64> arm7SliceRequested;
+	std::atomic<bool> arm7Sleeping; // The ARM7 thread gave up spinning and is blocked on arm7SliceRequested
+	alignas(64) std::atomic<u64> arm7SliceFinished;
+	std::atomic<bool> arm9Sleeping; // The emulator thread gave up spinning and is blocked on arm7SliceFinished
+	alignas(64) u64 handoffTime; // Nanoseconds to hand a slice over and get it back, measured when the thread starts
+	double arm7CycleTime; // Nanoseconds it takes to run one ARM7 cycle, averaged over recent slices
+	std::atomic<u64> parallelMinSlice; // Break-even slice length in cycles, handoffTime / arm7CycleTime. Shown in the menu.
+	u64 arm7TimedSlices;
+	std::atomic<bool> arm7ThreadUnavailable; // Only one host CPU, so there's nothing to gain
+	void startArm7Thread();
+	void requestArm7Slice();
+	void waitForArm7();
+	void arm7ThreadLoop();
+	void timeArm7(u64 cycles, std::chrono::steady_clock::time_point start);
+
+	// Idle loop detection can also be turned off per game in idleloop.cpp
+	u64 idleCyclesSkipped;
+
 	mio::ummap_cow_sink romMap;
 	mio::ummap_source bios9Map;
 	mio::ummap_source bios7Map;
@@ -99,4 +262,6 @@ public:
 	int loadBios9(std::filesystem::path bios9FilePath);
 	int loadBios7(std::filesystem::path bios7FilePath);
 	int loadFirmware(std::filesystem::path firmwareFilePath);
+
+	u16 runAheadFramebuffer[2][192][256]; // What getFramebuffer() returns while run-ahead is on
 };
@@ -3,6 +3,7 @@
 #include "types.hpp"
 #include "emulator/busshared.hpp"
 #include "emulator/nds7/busarm7.hpp"
+#include "emulator/spscqueue.hpp"
 
 #define SAMPLE_BUFFER_SIZE 1024
 
@@ -12,16 +13,21 @@ public:
 	BusARM7& bus;
 
 	// External Use
-	volatile bool soundRunning;
+	int sampleDecimation; // Keep one out of this many samples. Set above 1 when fast forwarding.
+	using SampleBlock = std::array<i16, SAMPLE_BUFFER_SIZE * 2>;
 	i16 newSamples[SAMPLE_BUFFER_SIZE * 2];
-	i16 outputSamples[SAMPLE_BUFFER_SIZE * 2];
+	SpscQueue<SampleBlock, 4> outputBlocks; // Finished blocks for the audio thread. Blocks are dropped if it falls behind.
+	bool discardOutput; // Throw away finished blocks instead. For frames that will be rolled back.
 
 	APU(std::shared_ptr<BusShared> shared, BusARM7& bus);
 	~APU();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
 	// Internal use
 	int sampleIndex;
+	int decimationCounter;
 
 	void doSample();
 	void fillFifo(int chanNum);
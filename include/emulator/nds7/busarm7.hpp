@@ -4,6 +4,9 @@
 
 #include "types.hpp"
 #include "emulator/busshared.hpp"
+#include "emulator/idleloop.hpp"
+#include "emulator/fastmem.hpp"
+#include "emulator/iotable.hpp"
 
 class BusShared;
 class IPC;
@@ -19,12 +22,27 @@ class WiFi;
 
 class BusARM7 {
 public:
-	// Connected components
+	// Touched on every instruction or memory access, so it goes first and shares cache lines with the start of the page tables
+	alignas(64) i64 delay;
+	u32 IE; // NDS7 - 0x4000210
+	u32 IF; // NDS7 - 0x4000214
+	bool IME; // NDS7 - 0x4000208
+	u8 HALTCNT; // NDS7 - 0x4000301
 	std::shared_ptr<BusShared> shared;
+	std::unique_ptr<ARM7TDMI<BusARM7>> cpu;
+	Fastmem fastmem; // Tried before the page tables when it's enabled
+	u32 fetchPage; // Instruction fetches remember the last page they hit. Address >> 14, or FETCH_NONE.
+	u8 *fetchPointer;
+	int fetchWaitstates[2][2]; // Code waitstates for that page, indexed by sequential and then size like waitstates
+	int waitstates[2][2][2][16]; // 0/1=data/code, 0/1=nonsequential/sequential, 0/1=32/16bit, 0..15=bits24..27
+	u8 *readTable[0x4000];
+	u8 *writeTable[0x4000];
+	IoTable io;
+
+	// Connected components
 	std::shared_ptr<IPC> ipc;
 	std::shared_ptr<PPU> ppu;
 	std::shared_ptr<Gamecard> gamecard;
-	std::unique_ptr<ARM7TDMI<BusARM7>> cpu;
 	std::unique_ptr<DMA<false>> dma;
 	std::unique_ptr<Timer> timer;
 	std::unique_ptr<RTC> rtc;
@@ -38,6 +56,8 @@ public:
 	BusARM7(std::shared_ptr<BusShared> shared, std::shared_ptr<IPC> ipc, std::shared_ptr<PPU> ppu, std::shared_ptr<Gamecard> gamecard);
 	~BusARM7();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
 	// Interrupts
 	enum InterruptType {
@@ -65,26 +85,22 @@ public:
 		INT_WIFI = 1 << 24,
 	};
 
-	bool IME; // NDS7 - 0x4000208
-	u32 IE; // NDS7 - 0x4000210
-	u32 IF; // NDS7 - 0x4000214
 	u8 POSTFLG; // NDS7 - 0x4000300
-	u8 HALTCNT; // NDS7 - 0x4000301
 
 	void requestInterrupt(InterruptType type);
+	static void timerEvent(void *bus, int channel);
 	void refreshInterrupts();
 
 	// For CPU and memory
-	i64 delay;
-	int waitstates[2][2][2][16]; // 0/1=data/code, 0/1=nonsequential/sequential, 0/1=32/16bit, 0..15=bits24..27
-	u8 *readTable[0x4000];
-	u8 *writeTable[0x4000];
+	IdleLoopDetector idleLoop;
 
 	void refreshWramPages();
 	void refreshVramPages();
 	void refreshRomPages();
+	static constexpr u32 FETCH_NONE = 0xFFFFFFFF;
+	void setFetchPage(u32 address, u8 *pagePointer);
 
-	std::stringstream &log;
+	BusShared::Log &log;
 	void hacf();
 	template <typename T, bool code> T read(u32 address, bool sequential);
 	template <typename T> void write(u32 address, T value, bool sequential);
@@ -93,4 +109,6 @@ public:
 
 	u8 readIO(u32 address, bool final);
 	void writeIO(u32 address, u8 value, bool final);
+	u32 readIO32(u32 address); // IME, IE, and IF
+	void writeIO32(u32 address, u32 value);
 };
@@ -13,6 +13,8 @@ public:
 	RTC(std::shared_ptr<BusShared> shared);
 	~RTC();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
 	// Internal Use
 	bool logRtc;
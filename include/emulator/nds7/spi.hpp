@@ -11,6 +11,8 @@ public:
 	SPI(std::shared_ptr<BusShared> shared);
 	~SPI();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
 	bool logSpi;
 
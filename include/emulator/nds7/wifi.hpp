@@ -11,6 +11,8 @@ public:
 	WiFi(std::shared_ptr<BusShared> shared);
 	~WiFi();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
     // Internal Use
 	bool logWifi;
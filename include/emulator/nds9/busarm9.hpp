@@ -4,6 +4,9 @@
 
 #include "types.hpp"
 #include "emulator/busshared.hpp"
+#include "emulator/idleloop.hpp"
+#include "emulator/fastmem.hpp"
+#include "emulator/iotable.hpp"
 
 class BusShared;
 class IPC;
@@ -16,21 +19,39 @@ class DSMath;
 
 class BusARM9 {
 public:
-	// Connected components
+	// Touched on every instruction or memory access, so it goes first and shares cache lines with the start of the page tables
+	alignas(64) i64 delay;
+	u32 IE; // NDS9 - 0x4000210
+	u32 IF; // NDS9 - 0x4000214
+	bool IME; // NDS9 - 0x4000208
 	std::shared_ptr<BusShared> shared;
+	std::unique_ptr<ARM946E<BusARM9>> cpu;
+	Fastmem fastmem; // Tried before the page tables when it's enabled
+	u32 fetchPage; // Instruction fetches remember the last page they hit. Address >> 14, or FETCH_NONE.
+	u8 *fetchPointer;
+	u8 *readTable[0x4000];
+	u8 *readTable8[0x4000];
+	u8 *writeTable[0x4000];
+	u8 *codeTable[0x4000]; // Same as readTable, except DTCM can't be executed from
+	IoTable io;
+
+	// Connected components
 	std::shared_ptr<IPC> ipc;
 	std::shared_ptr<PPU> ppu;
 	std::shared_ptr<Gamecard> gamecard;
-	std::unique_ptr<ARM946E<BusARM9>> cpu;
 	std::unique_ptr<DMA<true>> dma;
 	std::unique_ptr<Timer> timer;
 	std::unique_ptr<DSMath> dsmath;
 	u8 *bios;
+	u8 *itcm; // 32KB
+	u8 *dtcm; // 16KB
 
 	// For external use
 	BusARM9(std::shared_ptr<BusShared> shared, std::shared_ptr<IPC> ipc, std::shared_ptr<PPU> ppu, std::shared_ptr<Gamecard> gamecard);
 	~BusARM9();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
 	// Interrupts
 	enum InterruptType {
@@ -55,25 +76,34 @@ public:
 		INT_GEOMETRY_FIFO = 1 << 21,
 	};
 
-	bool IME; // NDS9 - 0x4000208
-	u32 IE; // NDS9 - 0x4000210
-	u32 IF; // NDS9 - 0x4000214
 	u8 POSTFLG; // NDS9 - 0x4000300
 
 	void requestInterrupt(InterruptType type);
+	static void timerEvent(void *bus, int channel);
 	void refreshInterrupts();
 
 	// For CPU and memory
-	i64 delay;
-	u8 *readTable[0x4000];
-	u8 *readTable8[0x4000];
-	u8 *writeTable[0x4000];
+	IdleLoopDetector idleLoop;
 
 	void refreshWramPages();
 	void refreshVramPages();
 	void refreshRomPages();
+	void refreshTcmPages();
+	static constexpr u32 FETCH_NONE = 0xFFFFFFFF;
+	void setFetchPage(u32 address, u8 *pagePointer);
+
+	// TCM is laid over the page tables, so the normal path doesn't need to check for it.
+	// Whatever was under it is saved here and put back before the tables are rebuilt.
+	struct TcmPage {
+		u32 page;
+		u8 *read, *read8, *write, *code;
+	};
+	std::vector<TcmPage> tcmPages;
+	std::vector<TcmPage> partialTcmPages; // Pages TCM only covers part of. They're left empty so the slow path can check byte by byte.
+	void mapTcm();
+	void unmapTcm();
 
-	std::stringstream &log;
+	BusShared::Log &log;
 	void hacf(); // TODO: Document this interface
 	template <typename T, bool code> T read(u32 address, bool sequential);
 	template <typename T> void write(u32 address, T value, bool sequential);
@@ -82,6 +112,8 @@ public:
 
 	u8 readIO(u32 address, bool final);
 	void writeIO(u32 address, u8 value, bool final);
+	u32 readIO32(u32 address); // IME, IE, and IF
+	void writeIO32(u32 address, u32 value);
 
 	// Coprocessor
 	u32 coprocessorRead(u32 copNum, u32 copOpc, u32 copSrcDestReg, u32 copOpReg, u32 copOpcType);
@@ -11,6 +11,8 @@ public:
 	DSMath(std::shared_ptr<BusShared> shared);
 	~DSMath();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
 	// Memory Interface
 	u8 readIO9(u32 address, bool final);
@@ -2,6 +2,9 @@
 
 #include "types.hpp"
 #include "emulator/busshared.hpp"
+#include "emulator/iotable.hpp"
+
+#define VRAM_SIZE ((128 + 128 + 128 + 128 + 64 + 16 + 16 + 32 + 16) * 1024)
 
 class PPU {
 public:
@@ -10,6 +13,7 @@ public:
 	// External Use
 	int frameCounter;
 	bool updateScreen;
+	bool hideFrames; // Don't set updateScreen. For frames that aren't going to be shown, like the real ones during run-ahead.
 	uint16_t framebufferA[192][256];
 	uint16_t framebufferB[192][256];
 	bool vBlankIrq9, hBlankIrq9, vCounterIrq9;
@@ -18,6 +22,8 @@ public:
 	PPU(std::shared_ptr<BusShared> shared);
 	~PPU();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
 	// Types
 	union VramInfoEntry {
@@ -165,6 +171,10 @@ public:
 	void writeIO9(u32 address, u8 value);
 	u8 readIO7(u32 address);
 	void writeIO7(u32 address, u8 value);
+	// Side effects of the registers in ppuEngineRegisters. The object is the engine that was written to.
+	static void bgControlWritten(void *engine, u32 address, u32 old);
+	static void referencePointWritten(void *engine, u32 address, u32 old);
+	static void windowWritten(void *engine, u32 address, u32 old);
 
 	// I/O Registers
 	struct GraphicsEngine { // Engine B has a memory offset of 0x1000
@@ -485,3 +495,129 @@ public:
 		u16 POWCNT1; // NDS9 - 0x4000304
 	};
 };
+
+// The registers both 2D engines have that are just stored with a mask. Engine B's are 0x1000 higher.
+// The bus's handlers and the debugger's entries for these are generated from this.
+namespace PpuFields {
+using enum IoFieldType;
+
+inline constexpr IoField bg0Control[] = {
+	{"BG Priority", 0, 2, TEXT_BOX},
+	{"Character Base Block", 2, 4, TEXT_BOX},
+	{"Mosaic", 6, 1, CHECKBOX},
+	{"Colors/Palettes", 7, 1, COMBO, "16/16\0"
+									 "256/1\0\0"},
+	{"Screen Base Block", 8, 5, TEXT_BOX},
+	{"Ext Palette Slot", 13, 1, COMBO, "Slot 0\0"
+									   "Slot2\0\0"},
+	{"Screen Size", 14, 2, TEXT_BOX}};
+inline constexpr IoField bg1Control[] = {
+	{"BG Priority", 0, 2, TEXT_BOX},
+	{"Character Base Block", 2, 4, TEXT_BOX},
+	{"Mosaic", 6, 1, CHECKBOX},
+	{"Colors/Palettes", 7, 1, COMBO, "16/16\0"
+									 "256/1\0\0"},
+	{"Screen Base Block", 8, 5, TEXT_BOX},
+	{"Ext Palette Slot", 13, 1, COMBO, "Slot 1\0"
+									   "Slot3\0\0"},
+	{"Screen Size", 14, 2, TEXT_BOX}};
+inline constexpr IoField affineBgControl[] = {
+	{"BG Priority", 0, 2, TEXT_BOX},
+	{"Character Base Block", 2, 4, TEXT_BOX},
+	{"Mosaic", 6, 1, CHECKBOX},
+	{"Colors/Palettes", 7, 1, COMBO, "16/16\0"
+									 "256/1\0\0"},
+	{"Screen Base Block", 8, 5, TEXT_BOX},
+	{"Display Area Overflow", 13, 1, COMBO, "Transparent\0"
+											"Wraparound\0\0"},
+	{"Screen Size", 14, 2, TEXT_BOX}};
+inline constexpr IoField scroll[] = {
+	{"Offset", 0, 9, TEXT_BOX}};
+inline constexpr IoField affineParameter[] = {
+	{"Rotation/Scaling Parameter", 0, 16, TEXT_BOX_HEX},
+	{"Rotation/Scaling Parameter", 0, 16, SPECIAL}};
+inline constexpr IoField referencePoint[] = {
+	{"Reference Point", 0, 28, TEXT_BOX_HEX},
+	{"Reference Point", 0, 28, SPECIAL}};
+inline constexpr IoField windowH[] = {
+	{"X2, Rightmost coordinate of window, plus 1", 0, 8, TEXT_BOX},
+	{"X1, Leftmost coordinate of window", 8, 8, TEXT_BOX}};
+inline constexpr IoField windowV[] = {
+	{"Y2, Bottom-most coordinate of window, plus 1", 0, 8, TEXT_BOX},
+	{"Y1, Top-most coordinate of window", 8, 8, TEXT_BOX}};
+inline constexpr IoField windowIn[] = {
+	{"Window 0 BG0 Enable Bit", 0, 1, CHECKBOX},
+	{"Window 0 BG1 Enable Bit", 1, 1, CHECKBOX},
+	{"Window 0 BG2 Enable Bit", 2, 1, CHECKBOX},
+	{"Window 0 BG3 Enable Bit", 3, 1, CHECKBOX},
+	{"Window 0 OBJ Enable Bit", 4, 1, CHECKBOX},
+	{"Window 0 Color Special Effect", 5, 1, CHECKBOX},
+	{"Window 1 BG0 Enable Bit", 8, 1, CHECKBOX},
+	{"Window 1 BG1 Enable Bit", 9, 1, CHECKBOX},
+	{"Window 1 BG2 Enable Bit", 10, 1, CHECKBOX},
+	{"Window 1 BG3 Enable Bit", 11, 1, CHECKBOX},
+	{"Window 1 OBJ Enable Bit", 12, 1, CHECKBOX},
+	{"Window 1 Color Special Effect", 13, 1, CHECKBOX}};
+inline constexpr IoField windowOut[] = {
+	{"Outside BG0 Enable Bit", 0, 1, CHECKBOX},
+	{"Outside BG1 Enable Bit", 1, 1, CHECKBOX},
+	{"Outside BG2 Enable Bit", 2, 1, CHECKBOX},
+	{"Outside BG3 Enable Bit", 3, 1, CHECKBOX},
+	{"Outside OBJ Enable Bit", 4, 1, CHECKBOX},
+	{"Outside Color Special Effect", 5, 1, CHECKBOX},
+	{"OBJ Window BG0 Enable Bit", 8, 1, CHECKBOX},
+	{"OBJ Window BG1 Enable Bit", 9, 1, CHECKBOX},
+	{"OBJ Window BG2 Enable Bit", 10, 1, CHECKBOX},
+	{"OBJ Window BG3 Enable Bit", 11, 1, CHECKBOX},
+	{"OBJ Window OBJ Enable Bit", 12, 1, CHECKBOX},
+	{"OBJ Window Color Special Effect", 13, 1, CHECKBOX}};
+inline constexpr IoField mosaic[] = {
+	{"BG Mosaic H-Size (minus 1)", 0, 4, TEXT_BOX},
+	{"BG Mosaic V-Size (minus 1)", 4, 4, TEXT_BOX},
+	{"OBJ Mosaic H-Size (minus 1)", 8, 4, TEXT_BOX},
+	{"OBJ Mosaic V-Size (minus 1)", 12, 4, TEXT_BOX}};
+inline constexpr IoField masterBright[] = {
+	{"Factor used for 6bit R,G,B Intensities", 0, 5, TEXT_BOX},
+	{"Mode", 14, 2, COMBO, "Disable\0"
+						   "Up\0"
+						   "Down\0"
+						   "Reserved\0\0"}};
+}
+
+#define ENGINE_REGISTER(member) offsetof(PPU::GraphicsEngine, member)
+inline constexpr IoRegisterInfo ppuEngineRegisters[] = {
+	{"BG0CNT", "BG0 Control", 0x4000008, 2, 0xFFFF, 0xFFFF, ENGINE_REGISTER(bg[0].BGCNT), PPU::bgControlWritten, PpuFields::bg0Control},
+	{"BG1CNT", "BG1 Control", 0x400000A, 2, 0xFFFF, 0xFFFF, ENGINE_REGISTER(bg[1].BGCNT), PPU::bgControlWritten, PpuFields::bg1Control},
+	{"BG2CNT", "BG2 Control", 0x400000C, 2, 0xFFFF, 0xFFFF, ENGINE_REGISTER(bg[2].BGCNT), PPU::bgControlWritten, PpuFields::affineBgControl},
+	{"BG3CNT", "BG3 Control", 0x400000E, 2, 0xFFFF, 0xFFFF, ENGINE_REGISTER(bg[3].BGCNT), PPU::bgControlWritten, PpuFields::affineBgControl},
+	{"BG0HOFS", "BG0 X-Offset", 0x4000010, 2, 0, 0x01FF, ENGINE_REGISTER(bg[0].BGHOFS), nullptr, PpuFields::scroll},
+	{"BG0VOFS", "BG0 Y-Offset", 0x4000012, 2, 0, 0x01FF, ENGINE_REGISTER(bg[0].BGVOFS), nullptr, PpuFields::scroll},
+	{"BG1HOFS", "BG1 X-Offset", 0x4000014, 2, 0, 0x01FF, ENGINE_REGISTER(bg[1].BGHOFS), nullptr, PpuFields::scroll},
+	{"BG1VOFS", "BG1 Y-Offset", 0x4000016, 2, 0, 0x01FF, ENGINE_REGISTER(bg[1].BGVOFS), nullptr, PpuFields::scroll},
+	{"BG2HOFS", "BG2 X-Offset", 0x4000018, 2, 0, 0x01FF, ENGINE_REGISTER(bg[2].BGHOFS), nullptr, PpuFields::scroll},
+	{"BG2VOFS", "BG2 Y-Offset", 0x400001A, 2, 0, 0x01FF, ENGINE_REGISTER(bg[2].BGVOFS), nullptr, PpuFields::scroll},
+	{"BG3HOFS", "BG3 X-Offset", 0x400001C, 2, 0, 0x01FF, ENGINE_REGISTER(bg[3].BGHOFS), nullptr, PpuFields::scroll},
+	{"BG3VOFS", "BG3 Y-Offset", 0x400001E, 2, 0, 0x01FF, ENGINE_REGISTER(bg[3].BGVOFS), nullptr, PpuFields::scroll},
+	{"BG2PA", "BG2 Rotation/Scaling Parameter A (alias dx)", 0x4000020, 2, 0, 0xFFFF, ENGINE_REGISTER(bg[2].BGPA), nullptr, PpuFields::affineParameter},
+	{"BG2PB", "BG2 Rotation/Scaling Parameter B (alias dmx)", 0x4000022, 2, 0, 0xFFFF, ENGINE_REGISTER(bg[2].BGPB), nullptr, PpuFields::affineParameter},
+	{"BG2PC", "BG2 Rotation/Scaling Parameter C (alias dy)", 0x4000024, 2, 0, 0xFFFF, ENGINE_REGISTER(bg[2].BGPC), nullptr, PpuFields::affineParameter},
+	{"BG2PD", "BG2 Rotation/Scaling Parameter D (alias dmy)", 0x4000026, 2, 0, 0xFFFF, ENGINE_REGISTER(bg[2].BGPD), nullptr, PpuFields::affineParameter},
+	{"BG2X", "BG2 Reference Point X-Coordinate", 0x4000028, 4, 0, 0x0FFFFFFF, ENGINE_REGISTER(bg[2].BGX), PPU::referencePointWritten, PpuFields::referencePoint},
+	{"BG2Y", "BG2 Reference Point Y-Coordinate", 0x400002C, 4, 0, 0x0FFFFFFF, ENGINE_REGISTER(bg[2].BGY), PPU::referencePointWritten, PpuFields::referencePoint},
+	{"BG3PA", "BG3 Rotation/Scaling Parameter A (alias dx)", 0x4000030, 2, 0, 0xFFFF, ENGINE_REGISTER(bg[3].BGPA), nullptr, PpuFields::affineParameter},
+	{"BG3PB", "BG3 Rotation/Scaling Parameter B (alias dmx)", 0x4000032, 2, 0, 0xFFFF, ENGINE_REGISTER(bg[3].BGPB), nullptr, PpuFields::affineParameter},
+	{"BG3PC", "BG3 Rotation/Scaling Parameter C (alias dy)", 0x4000034, 2, 0, 0xFFFF, ENGINE_REGISTER(bg[3].BGPC), nullptr, PpuFields::affineParameter},
+	{"BG3PD", "BG3 Rotation/Scaling Parameter D (alias dmy)", 0x4000036, 2, 0, 0xFFFF, ENGINE_REGISTER(bg[3].BGPD), nullptr, PpuFields::affineParameter},
+	{"BG3X", "BG3 Reference Point X-Coordinate", 0x4000038, 4, 0, 0x0FFFFFFF, ENGINE_REGISTER(bg[3].BGX), PPU::referencePointWritten, PpuFields::referencePoint},
+	{"BG3Y", "BG3 Reference Point Y-Coordinate", 0x400003C, 4, 0, 0x0FFFFFFF, ENGINE_REGISTER(bg[3].BGY), PPU::referencePointWritten, PpuFields::referencePoint},
+	{"WIN0H", "Window 0 Horizontal Dimensions", 0x4000040, 2, 0, 0xFFFF, ENGINE_REGISTER(WIN0H), PPU::windowWritten, PpuFields::windowH},
+	{"WIN1H", "Window 1 Horizontal Dimensions", 0x4000042, 2, 0, 0xFFFF, ENGINE_REGISTER(WIN1H), PPU::windowWritten, PpuFields::windowH},
+	{"WIN0V", "Window 0 Vertical Dimensions", 0x4000044, 2, 0, 0xFFFF, ENGINE_REGISTER(WIN0V), PPU::windowWritten, PpuFields::windowV},
+	{"WIN1V", "Window 1 Vertical Dimensions", 0x4000046, 2, 0, 0xFFFF, ENGINE_REGISTER(WIN1V), PPU::windowWritten, PpuFields::windowV},
+	{"WININ", "Control of Inside of Window(s)", 0x4000048, 2, 0xFFFF, 0xFFFF, ENGINE_REGISTER(WININ), nullptr, PpuFields::windowIn},
+	{"WINOUT", "Control of Outside of Windows & Inside of OBJ Window", 0x400004A, 2, 0xFFFF, 0xFFFF, ENGINE_REGISTER(WINOUT), nullptr, PpuFields::windowOut},
+	{"MOSAIC", "Mosaic Size", 0x400004C, 2, 0, 0xFFFF, ENGINE_REGISTER(MOSAIC), nullptr, PpuFields::mosaic},
+	{"MASTER_BRIGHT", "Master Brightness Up/Down", 0x400006C, 2, 0xFFFF, 0xC01F, ENGINE_REGISTER(MASTER_BRIGHT), nullptr, PpuFields::masterBright},
+};
+#undef ENGINE_REGISTER
+static_assert(ioRegistersWithin(ppuEngineRegisters, sizeof(PPU::GraphicsEngine)));
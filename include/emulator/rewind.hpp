@@ -0,0 +1,40 @@
+#pragma once
+
+#include "types.hpp"
+#include <deque>
+
+// Keeps a history of save states for rewinding.
+// Only the newest state is kept in full. Every older one is stored as the difference from the one after it, so stepping back
+// is just applying the newest difference, and the oldest history can be thrown away without touching anything else.
+// Differences are taken in 4KB blocks of the serialized state, XORed, and run length encoded, which works out to
+// roughly the pages of memory the game actually wrote to.
+class RewindBuffer {
+public:
+	static constexpr size_t BLOCK_SIZE = 0x1000;
+
+	size_t budget; // Max bytes used by the history, including the newest state
+	size_t memoryUsed;
+
+	RewindBuffer();
+	~RewindBuffer();
+	void clear();
+
+	// Makes state the newest entry. The buffer is swapped with the last newest state to avoid copying, so its contents are garbage afterwards.
+	void push(std::vector<u8> &state);
+	bool stepBack();
+	bool empty() { return current.empty(); }
+	size_t depth() { return deltas.size(); }
+	const std::vector<u8> &newest() { return current; }
+
+private:
+	struct Delta {
+		size_t size; // Size of the older state
+		std::vector<u8> data; // For each changed block: u32 index, u32 encoded length, then the encoded XOR
+	};
+	std::deque<Delta> deltas;
+	std::vector<u8> current;
+	u8 xorBlock[BLOCK_SIZE];
+
+	void encodeBlock(std::vector<u8> &out, const u8 *block, size_t blockSize);
+	static void applyBlock(u8 *block, size_t blockSize, const u8 *encoded, size_t encodedSize);
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <queue>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Save states are a small header followed by one chunk per component.
+// Each chunk has a 4 character tag, its own version number, and its size. Components bump their version when their layout changes
+// and can keep reading older versions, without touching the rest of the file. Chunks are found by tag, so order doesn't matter
+// and chunks from newer builds that this one doesn't know about are skipped.
+//
+// Everything is written with memcpy into a buffer that's reused between saves, so saving every frame is cheap.
+#define SAVESTATE_MAGIC 0x5354524F // "ORTS"
+#define SAVESTATE_FORMAT_VERSION 1
+
+class StateWriter {
+public:
+	std::vector<u8> &buffer;
+
+	StateWriter(std::vector<u8> &buffer);
+
+	void beginChunk(const char *tag, u32 version);
+	void endChunk();
+
+	void writeBytes(const void *data, size_t size);
+	template <typename T> void write(const T &value) {
+		static_assert(std::is_trivially_copyable_v<T>, "Only plain data can be written directly");
+		writeBytes(&value, sizeof(T));
+	}
+	template <typename T> void writeQueue(std::queue<T> queue) {
+		write<u32>(queue.size());
+		while (!queue.empty()) {
+			write(queue.front());
+			queue.pop();
+		}
+	}
+
+private:
+	size_t chunkStart;
+};
+
+class StateReader {
+public:
+	StateReader(const u8 *data, size_t size);
+
+	// Returns the version of the chunk, or 0 if it's missing or newer than maxVersion (which also fails the load)
+	u32 beginChunk(const char *tag, u32 maxVersion);
+	void endChunk();
+
+	void readBytes(void *data, size_t size);
+	template <typename T> void read(T &value) {
+		static_assert(std::is_trivially_copyable_v<T>, "Only plain data can be read directly");
+		readBytes(&value, sizeof(T));
+	}
+	template <typename T> T read() {
+		T value{};
+		read(value);
+		return value;
+	}
+	template <typename T> void readQueue(std::queue<T> &queue) {
+		queue = {};
+		u32 size = read<u32>();
+		for (u32 i = 0; (i < size) && !failed(); i++)
+			queue.push(read<T>());
+	}
+
+	bool failed() { return !error.empty(); }
+	void fail(std::string message);
+	std::string error; // The first thing that went wrong. Empty if nothing has.
+
+private:
+	struct Chunk {
+		u32 tag;
+		u32 version;
+		size_t offset;
+		size_t size;
+	};
+	std::vector<Chunk> chunks;
+
+	const u8 *data;
+	size_t position;
+	size_t chunkEnd;
+	u32 currentTag;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "types.hpp"
+#include <array>
+#include <atomic>
+#include <thread>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+// The producer owns head and the consumer owns tail, so each side only has to read the other's index.
+template <typename T, size_t size>
+class SpscQueue {
+	static_assert((size & (size - 1)) == 0, "Queue size must be a power of 2");
+
+public:
+	SpscQueue() : head(0), tail(0) {}
+
+	// Producer side. Waits for the consumer if the queue is full.
+	void push(T value) {
+		size_t currentHead = head.load(std::memory_order_relaxed);
+		while ((currentHead - tail.load(std::memory_order_acquire)) == size)
+			std::this_thread::yield();
+
+		buffer[currentHead & (size - 1)] = std::move(value);
+		head.store(currentHead + 1, std::memory_order_release);
+		head.notify_one();
+	}
+
+	// Producer side. Returns false instead of waiting if the queue is full.
+	bool tryPush(T value) {
+		size_t currentHead = head.load(std::memory_order_relaxed);
+		if ((currentHead - tail.load(std::memory_order_acquire)) == size)
+			return false;
+
+		buffer[currentHead & (size - 1)] = std::move(value);
+		head.store(currentHead + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side
+	bool empty() {
+		return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_relaxed);
+	}
+
+	bool pop(T &value) {
+		size_t currentTail = tail.load(std::memory_order_relaxed);
+		if (head.load(std::memory_order_acquire) == currentTail)
+			return false;
+
+		value = std::move(buffer[currentTail & (size - 1)]);
+		tail.store(currentTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	void clear() {
+		T discard;
+		while (pop(discard));
+	}
+
+	// Sleeps until the producer pushes something
+	void wait() {
+		size_t currentTail = tail.load(std::memory_order_relaxed);
+		head.wait(currentTail, std::memory_order_acquire);
+	}
+
+private:
+	std::array<T, size> buffer;
+	alignas(64) std::atomic<size_t> head;
+	alignas(64) std::atomic<size_t> tail;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+// Hashes the machine once per frame to check that runs are deterministic.
+// A run can record its hashes to a file, check itself against a file as it goes, or two files can be compared afterwards.
+// Every component gets its own hash so a mismatch says where things went wrong, not just when.
+class StateHasher {
+public:
+	enum Component {
+		PSRAM,
+		WRAM,
+		VRAM,
+		OAM,
+		PALETTE,
+		TCM,
+		ARM9,
+		ARM7,
+		IO,
+		COMPONENT_COUNT
+	};
+	static constexpr const char *componentNames[COMPONENT_COUNT] = {"PSRAM", "WRAM", "VRAM", "OAM", "Palette", "TCM", "ARM9", "ARM7", "I/O"};
+
+	struct FrameHash {
+		u64 frame;
+		u64 component[COMPONENT_COUNT];
+	};
+
+	// Four independent lanes, so the loop vectorizes or at least keeps four multiplies in flight
+	static u64 hash(const void *data, size_t size, u64 seed = 0);
+
+	StateHasher();
+	~StateHasher();
+	int record(std::filesystem::path path);
+	int check(std::filesystem::path path);
+	void stop();
+	bool active() { return recordFile.is_open() || referenceFile.is_open(); }
+
+	// Returns false the first time the frame doesn't match the reference
+	bool frame(FrameHash &hashes);
+	u64 frameNumber;
+	bool diverged;
+	std::string divergence; // Description of the first mismatch
+
+	// Returns an empty string if the two files match
+	static std::string compare(std::filesystem::path pathA, std::filesystem::path pathB);
+
+private:
+	std::ofstream recordFile;
+	std::ifstream referenceFile;
+
+	static void writeFrame(std::ostream &stream, const FrameHash &hashes);
+	static bool readFrame(std::istream &stream, FrameHash &hashes);
+	static std::string describe(const FrameHash &a, const FrameHash &b);
+};
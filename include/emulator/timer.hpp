@@ -13,11 +13,14 @@ public:
 	Timer(bool timer9, std::shared_ptr<BusShared> shared);
 	~Timer();
 	void reset();
+	void saveState(StateWriter &state);
+	void loadState(StateReader &state);
 
 	// Internal use
 	void updateCounter(int channel);
+	EventType overflowEvent(int channel);
 	u64 scheduleTimer(int channel);
-	void checkOverflow();
+	u8 checkOverflow(int channel);
 
 	// Memory Interface
 	u8 readIO(u32 address);
@@ -40,6 +43,5 @@ public:
 		};
 
 		u64 lastIncrementTimestamp;
-		bool interruptRequested;
 	} timer[4];
 };
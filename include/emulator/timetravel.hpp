@@ -0,0 +1,46 @@
+#pragma once
+
+#include "types.hpp"
+#include <deque>
+
+// History for stepping the debugger backwards.
+// Keyframes are full save states taken every few frames, and every input in between is logged with the point it was
+// applied at. Going back to any earlier point is loading the keyframe before it and replaying from there, so it never
+// costs more than one keyframe interval of emulation.
+// Points in the history are counted in lockstep iterations, which are the smallest unit the emulator can stop on.
+class TimeTravel {
+public:
+	struct Position {
+		u64 ticks; // Calls to runLockstep()
+		u64 instructions9;
+		u64 instructions7;
+	};
+	struct Keyframe {
+		Position position;
+		u64 time; // shared->currentTime
+		std::vector<u8> state;
+	};
+	struct Input {
+		u64 ticks; // Applied right before this tick runs
+		u32 keys;
+		u8 touchX, touchY;
+	};
+
+	size_t budget; // Max bytes used by keyframes
+	size_t memoryUsed;
+	Position position; // Where the emulator is now
+	std::deque<Keyframe> keyframes;
+	std::deque<Input> inputs;
+	size_t nextInput; // The first one a replay hasn't reached yet
+
+	TimeTravel();
+	~TimeTravel();
+	void clear();
+
+	// The buffer is swapped into the keyframe to avoid copying, so its contents are garbage afterwards
+	void addKeyframe(std::vector<u8> &state, u64 time);
+	void addInput(u32 keys, u8 touchX, u8 touchY);
+
+	// Forgets everything after the current position. Once the emulator has gone back, the old future might not happen again.
+	void truncate();
+};
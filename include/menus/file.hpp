@@ -23,5 +23,8 @@ private:
 	void bios9FileDialog();
 	void bios7FileDialog();
 	void firmwareFileDialog();
+	void saveStateDialog();
+	void loadStateDialog();
+	void hashFileDialog(NDS::threadEventType type);
 	void romInfoWindow();
 };
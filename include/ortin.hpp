@@ -37,6 +37,7 @@ public:
 
 	bool error;
 	bool penDown;
+	u8 touchX, touchY; // Sent to the emulator thread with the keys
 
 	SDL_Window* window;
 	SDL_GLContext gl_context;
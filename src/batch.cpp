@@ -0,0 +1,268 @@
+// Headless batch runner
+// Runs a list of ROMs for a fixed number of frames each, spread across a pool of worker threads.
+// Each ROM runs in a child process, so one that crashes the emulator only takes itself down.
+//
+// Usage: OrtinBatch --bios9 <path> --bios7 <path> --firmware <path> [--threads <n>] [--hashes <directory>] <list file>
+//        OrtinBatch --compare <hashes> <hashes>
+// Each line of the list file is a ROM path followed by the number of frames to run it for.
+// --hashes records per-frame state hashes for every ROM, which --compare can check against another run.
+// The log columns are only filled in by OrtinBatchDebug, since the release core has logging compiled out.
+
+#include "emulator/nds.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+struct BatchJob {
+	std::filesystem::path romPath;
+	int frames;
+};
+
+struct BatchResult {
+	std::string status;
+	int framesRun;
+	double fps;
+	u64 framebufferHash;
+	size_t logLines;
+	std::string lastLogLine;
+};
+
+struct BatchSettings {
+	std::filesystem::path bios9Path;
+	std::filesystem::path bios7Path;
+	std::filesystem::path firmwarePath;
+	std::filesystem::path tempDirectory;
+	std::filesystem::path hashDirectory;
+};
+
+static u64 hashFramebuffers(NDS &nds) {
+	u64 hash = 0;
+	for (int engine = 0; engine < 2; engine++)
+		hash = StateHasher::hash(nds.getFramebuffer(engine), 256 * 192 * sizeof(u16), hash);
+
+	return hash;
+}
+
+static BatchResult runJob(const BatchSettings &settings, const BatchJob &job, int index) {
+	BatchResult result = {.status = "ok", .framesRun = 0, .fps = 0, .framebufferHash = 0, .logLines = 0};
+	auto nds = std::make_unique<NDS>();
+	nds->idleLoopDetection = true;
+	nds->threadedArm7 = false; // The pool already keeps every core busy
+	nds->bootCache = settings.hashDirectory.empty(); // Skipping the boot would throw the frame numbers off
+
+	// Firmware is mapped writable, so every instance gets its own copy
+	std::error_code error;
+	std::filesystem::path firmwareCopy = settings.tempDirectory / fmt::format("ortin-batch-firmware-{}.bin", index);
+	std::filesystem::copy_file(settings.firmwarePath, firmwareCopy, std::filesystem::copy_options::overwrite_existing, error);
+
+	if (error || nds->loadBios9(settings.bios9Path) || nds->loadBios7(settings.bios7Path) || nds->loadFirmware(firmwareCopy) || nds->loadRom(job.romPath)) {
+		result.status = "load failed";
+	} else {
+		nds->romInfo.romLoaded = nds->romInfo.bios9Loaded = nds->romInfo.bios7Loaded = nds->romInfo.firmwareLoaded = true;
+		if (!settings.hashDirectory.empty())
+			nds->hasher.record(settings.hashDirectory / fmt::format("{}-{}.hashes", index, job.romPath.stem().string()));
+		nds->reset();
+
+		auto start = std::chrono::steady_clock::now();
+		while (result.framesRun < job.frames) {
+			nds->runFrame();
+			if (!nds->frameEnded) { // Something called hacf() or hit a breakpoint
+				result.status = "stopped";
+				break;
+			}
+
+			++result.framesRun;
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		result.fps = (elapsed.count() > 0) ? (result.framesRun / elapsed.count()) : 0;
+		result.framebufferHash = hashFramebuffers(*nds);
+		nds->hasher.stop();
+	}
+
+	std::string line;
+	std::istringstream log(nds->shared->log.str());
+	while (std::getline(log, line)) {
+		++result.logLines;
+		result.lastLogLine = line;
+	}
+
+	nds.reset();
+	std::filesystem::remove(firmwareCopy, error);
+	return result;
+}
+
+// Runs the job in a child process and reads the result back through a pipe.
+// Windows has no fork(), so jobs run on the worker thread there and a crash still takes everything down.
+static BatchResult runIsolatedJob(const BatchSettings &settings, const BatchJob &job, int index) {
+#ifdef _WIN32
+	return runJob(settings, job, index);
+#else
+	// A child forked by another worker while this pipe's write end is open would keep it open, and the read below
+	// wouldn't see the end until that child exited too
+	static std::mutex forkMutex;
+
+	BatchResult result = {.status = "ok", .framesRun = 0, .fps = 0, .framebufferHash = 0, .logLines = 0};
+	int fds[2];
+	std::unique_lock lock(forkMutex);
+	if (pipe(fds)) {
+		result.status = fmt::format("pipe failed: {}", strerror(errno));
+		return result;
+	}
+
+	pid_t pid = fork();
+	if (pid < 0) {
+		result.status = fmt::format("fork failed: {}", strerror(errno));
+		close(fds[0]);
+		close(fds[1]);
+		return result;
+	}
+
+	if (pid == 0) {
+		close(fds[0]);
+		BatchResult childResult = runJob(settings, job, index);
+		std::string output = fmt::format("{}\t{}\t{}\t{}\t{}\t{}", childResult.status, childResult.framesRun, childResult.fps,
+			childResult.framebufferHash, childResult.logLines, childResult.lastLogLine);
+		for (size_t written = 0; written < output.size();) {
+			ssize_t count = write(fds[1], output.data() + written, output.size() - written);
+			if (count < 0) {
+				if (errno == EINTR)
+					continue;
+				_exit(1);
+			}
+			written += count;
+		}
+		_exit(0); // Skip the parent's atexit handlers and static destructors
+	}
+
+	close(fds[1]);
+	lock.unlock();
+	std::string output;
+	char buffer[4096];
+	while (true) {
+		ssize_t count = read(fds[0], buffer, sizeof(buffer));
+		if (count > 0) {
+			output.append(buffer, count);
+		} else if ((count == 0) || (errno != EINTR)) {
+			break;
+		}
+	}
+	close(fds[0]);
+
+	int status;
+	while ((waitpid(pid, &status, 0) < 0) && (errno == EINTR));
+	if (WIFSIGNALED(status)) {
+		result.status = fmt::format("crashed (signal {}, {})", WTERMSIG(status), strsignal(WTERMSIG(status)));
+		return result;
+	}
+	if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0) || output.empty()) {
+		result.status = fmt::format("exited with {}", WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+		return result;
+	}
+
+	// Status, frames, fps, framebuffer hash, log lines, then the last log line, which can have tabs of its own
+	std::istringstream fields(output);
+	std::string framesRun, fps, framebufferHash, logLines;
+	std::getline(fields, result.status, '\t');
+	std::getline(fields, framesRun, '\t');
+	std::getline(fields, fps, '\t');
+	std::getline(fields, framebufferHash, '\t');
+	std::getline(fields, logLines, '\t');
+	std::getline(fields, result.lastLogLine);
+	result.framesRun = atoi(framesRun.c_str());
+	result.fps = atof(fps.c_str());
+	result.framebufferHash = strtoull(framebufferHash.c_str(), nullptr, 10);
+	result.logLines = strtoull(logLines.c_str(), nullptr, 10);
+	return result;
+#endif
+}
+
+int main(int argc, char *argv[]) {
+	BatchSettings settings;
+	std::filesystem::path listPath;
+	int threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if ((arg == "--bios9") && ((i + 1) < argc)) {
+			settings.bios9Path = argv[++i];
+		} else if ((arg == "--bios7") && ((i + 1) < argc)) {
+			settings.bios7Path = argv[++i];
+		} else if ((arg == "--firmware") && ((i + 1) < argc)) {
+			settings.firmwarePath = argv[++i];
+		} else if ((arg == "--threads") && ((i + 1) < argc)) {
+			threadCount = std::max(1, atoi(argv[++i]));
+		} else if ((arg == "--hashes") && ((i + 1) < argc)) {
+			settings.hashDirectory = argv[++i];
+		} else if ((arg == "--compare") && ((i + 2) < argc)) {
+			std::string difference = StateHasher::compare(argv[i + 1], argv[i + 2]);
+			fmt::print("{}\n", difference.empty() ? "Identical" : difference);
+			return difference.empty() ? 0 : 1;
+		} else {
+			listPath = arg;
+		}
+	}
+
+	if (listPath.empty() || settings.bios9Path.empty() || settings.bios7Path.empty() || settings.firmwarePath.empty()) {
+		fmt::print(stderr, "Usage: {0} --bios9 <path> --bios7 <path> --firmware <path> [--threads <n>] [--hashes <directory>] <list file>\n"
+			"       {0} --compare <hashes> <hashes>\n", argv[0]);
+		return -1;
+	}
+	settings.tempDirectory = std::filesystem::temp_directory_path();
+	if (!settings.hashDirectory.empty())
+		std::filesystem::create_directories(settings.hashDirectory);
+
+	// Read the job list
+	std::vector<BatchJob> jobs;
+	std::ifstream listFile(listPath);
+	std::string line;
+	while (std::getline(listFile, line)) {
+		if (line.empty() || (line[0] == '#'))
+			continue;
+
+		// The frame count comes last so paths can contain spaces
+		auto split = line.find_last_of(" \t");
+		if (split == std::string::npos) {
+			fmt::print(stderr, "Skipping line without a frame count: {}\n", line);
+			continue;
+		}
+		jobs.push_back({line.substr(0, split), atoi(line.c_str() + split + 1)});
+	}
+
+	// Run everything
+	std::vector<BatchResult> results(jobs.size());
+	std::atomic<size_t> nextJob = 0;
+	std::vector<std::thread> workers;
+	for (int i = 0; i < std::min(threadCount, (int)jobs.size()); i++) {
+		workers.emplace_back([&] {
+			size_t job;
+			while ((job = nextJob.fetch_add(1)) < jobs.size())
+				results[job] = runIsolatedJob(settings, jobs[job], job);
+		});
+	}
+	for (auto& worker : workers)
+		worker.join();
+
+	// Report
+	fmt::print("rom\tstatus\tframes\tfps\tframebuffer hash{}\n", Instrumentation::logging ? "\tlog lines\tlast log line" : "");
+	for (size_t i = 0; i < jobs.size(); i++) {
+		auto& result = results[i];
+		fmt::print("{}\t{}\t{}\t{:.1f}\t{:0>16X}", jobs[i].romPath.string(), result.status, result.framesRun, result.fps, result.framebufferHash);
+		if constexpr (Instrumentation::logging)
+			fmt::print("\t{}\t{}", result.logLines, result.lastLogLine);
+		fmt::print("\n");
+	}
+
+	return 0;
+}
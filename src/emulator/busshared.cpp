@@ -1,38 +1,182 @@
 #include "emulator/busshared.hpp"
 
+static_assert(EVENT_COUNT <= 64, "pendingEvents can't hold every event type");
+
+thread_local bool BusShared::onArm7Thread = false;
+
 BusShared::BusShared() {
-	psram = new u8[0x400000]; // 4MB
-	memset(psram, 0, 0x400000);
-	wram = new u8[0x8000]; // 32KB
-	memset(wram, 0, 0x8000);
+	psram = memory[GuestMemory::PSRAM]; // 4MB
+	wram = memory[GuestMemory::SHARED_WRAM]; // 32KB
 
 	KEYINPUT = 0x03FF;
 	KEYCNT9 = KEYCNT7 = 0x0000;
 	EXTKEYIN = 0x007F;
 	EXMEMCNT = 0;
 	WRAMCNT = 0x03;
+	wakeArm9 = wakeArm7 = false;
+	parallelSlice = false;
+	sliceEnd = 0;
+
+	for (int i = 0; i < EVENT_COUNT; i++)
+		registerEvent((EventType)i, [](void *object, int arg) {
+			auto shared = (BusShared *)object;
+			shared->log << "Invalid event " << arg << "\n";
+			shared->addEvent(0, STOP);
+		}, this, i);
 }
 
 BusShared::~BusShared() {
-	delete[] psram;
-	delete[] wram;
+	//
 }
 
 void BusShared::reset() {
-	currentTime = 0;
-	eventQueue = {};
+	currentTime = arm7Time = 0;
+	wakeArm9 = wakeArm7 = false;
+	parallelSlice = false;
+	sliceEnd = 0;
+	dirtyPages = 0;
+	coalescedRefreshes = 0;
+	pendingEvents = 0;
+	refreshNextEvent();
 }
 
-bool BusShared::eventSorter::operator()(const Event &lhs, const Event &rhs) {
-	return lhs.timeStamp > rhs.timeStamp;
+void BusShared::saveState(StateWriter &state) {
+	state.beginChunk("SHRD", 1);
+	state.writeBytes(psram, 0x400000);
+	state.writeBytes(wram, 0x8000);
+	state.write(KEYINPUT);
+	state.write(KEYCNT9);
+	state.write(KEYCNT7);
+	state.write(EXTKEYIN);
+	state.write(EXMEMCNT);
+	state.write(EXMEMSTAT);
+	state.write(WRAMCNT);
+	state.write(dirtyPages);
+	state.endChunk();
+
+	// Handlers aren't saved since they're registered once by each component and never change
+	state.beginChunk("SCHD", 1);
+	state.write(currentTime);
+	state.write(arm7Time);
+	state.write<u32>(EVENT_COUNT);
+	state.write(pendingEvents);
+	state.write(eventTimes);
+	state.endChunk();
+}
+
+void BusShared::loadState(StateReader &state) {
+	state.beginChunk("SHRD", 1);
+	state.readBytes(psram, 0x400000);
+	state.readBytes(wram, 0x8000);
+	state.read(KEYINPUT);
+	state.read(KEYCNT9);
+	state.read(KEYCNT7);
+	state.read(EXTKEYIN);
+	state.read(EXMEMCNT);
+	state.read(EXMEMSTAT);
+	state.read(WRAMCNT);
+	state.read(dirtyPages);
+	state.endChunk();
+
+	state.beginChunk("SCHD", 1);
+	state.read(currentTime);
+	state.read(arm7Time);
+	if (state.read<u32>() != EVENT_COUNT)
+		state.fail("Save state has a different set of events");
+	state.read(pendingEvents);
+	state.read(eventTimes);
+	state.endChunk();
+	refreshNextEvent();
+}
+
+// Only call this while the ARM7 thread is waiting
+void BusShared::Log::merge() {
+	if (arm7.tellp() <= 0)
+		return;
+
+	main << arm7.rdbuf();
+	arm7.str("");
+}
+
+void BusShared::registerEvent(EventType type, void (*callback)(void *object, int arg), void *object, int arg) {
+	eventHandlers[type] = {callback, object, arg};
+}
+
+void BusShared::requestPageRefresh(PageRefresh pages) {
+	if (dirtyPages & pages) {
+		++coalescedRefreshes;
+		return;
+	}
+
+	if (dirtyPages == 0)
+		addEvent(0, EventType::REFRESH_PAGES);
+	dirtyPages |= pages;
 }
 
 void BusShared::addEvent(u64 cycles, EventType type) {
-	eventQueue.push(Event{currentTime + cycles, type});
+	addEventAbsolute(time() + cycles, type);
 }
 
+// The scheduler only needs locking while the ARM7 is running on its own thread. parallelSlice is only changed between slices.
 void BusShared::addEventAbsolute(u64 time, EventType type) {
-	eventQueue.push(Event{time, type});
+	std::unique_lock lock(eventMutex, std::defer_lock);
+	if (parallelSlice) [[unlikely]]
+		lock.lock();
+	bool wasNext = eventPending(type) && (nextEventType == type);
+
+	eventTimes[type] = time;
+	pendingEvents |= (u64)1 << type;
+
+	// Ties go to the lower event type so the order doesn't depend on when things were scheduled
+	if ((time < nextEventTime) || ((time == nextEventTime) && (type < nextEventType))) {
+		nextEventTime = time;
+		nextEventType = type;
+	} else if (wasNext) { // The earliest event got pushed back, so something else might be first now
+		refreshNextEvent();
+	}
+
+	if (parallelSlice && (time < sliceEnd.load(std::memory_order_relaxed)))
+		sliceEnd.store(time, std::memory_order_relaxed);
+}
+
+void BusShared::cancelEvent(EventType type) {
+	std::unique_lock lock(eventMutex, std::defer_lock);
+	if (parallelSlice) [[unlikely]]
+		lock.lock();
+	if (!eventPending(type))
+		return;
+
+	pendingEvents &= ~((u64)1 << type);
+	if (nextEventType == type)
+		refreshNextEvent();
+}
+
+bool BusShared::eventPending(EventType type) {
+	return (pendingEvents >> type) & 1;
+}
+
+// Removes and returns the earliest event. Only call this if nextEventTime has been reached.
+// Events are only handled between slices, so this never needs the lock.
+EventType BusShared::popEvent() {
+	EventType type = nextEventType;
+
+	pendingEvents &= ~((u64)1 << type);
+	refreshNextEvent();
+	return type;
+}
+
+void BusShared::refreshNextEvent() {
+	nextEventTime = UINT64_MAX;
+	nextEventType = STOP;
+
+	for (u64 pending = pendingEvents; pending != 0; pending &= pending - 1) {
+		int type = std::countr_zero(pending);
+
+		if (eventTimes[type] < nextEventTime) {
+			nextEventTime = eventTimes[type];
+			nextEventType = (EventType)type;
+		}
+	}
 }
 
 u8 BusShared::readIO9(u32 address) {
@@ -76,7 +220,7 @@ void BusShared::writeIO9(u32 address, u8 value) {
 	case 0x4000247:
 		WRAMCNT = value & 0x03;
 
-		addEvent(0, EventType::REFRESH_WRAM_PAGES);
+		requestPageRefresh(PAGES_WRAM);
 		break;
 	default:
 		log << fmt::format("[NDS9 Bus][Shared] Write to unknown IO register 0x{:0>8X} with value 0x{:0>8X}\n", address, value);
@@ -56,6 +56,56 @@ void Gamecard::reset() {
 	//level1.encrypt((u64 *)(romData + 0x78));
 }
 
+void Gamecard::saveState(StateWriter &state) {
+	state.beginChunk("CART", 1);
+	state.write(encryptionMode);
+	state.write(chipId);
+	state.write(currentCommand);
+	state.write(bytesRead);
+	state.write(dataBlockSizeBytes);
+	state.write(level1);
+	state.write(level2);
+	state.write(level3);
+	state.write(AUXSPICNT);
+	state.write(ROMCTRL);
+	state.write(nextCartridgeCommand);
+	state.write(key2Seed0Low9);
+	state.write(key2Seed0Low7);
+	state.write(key2Seed1Low9);
+	state.write(key2Seed1Low7);
+	state.write(key2Seed0High9);
+	state.write(key2Seed0High7);
+	state.write(key2Seed1High9);
+	state.write(key2Seed1High7);
+	state.write(cartridgeReadData);
+	state.endChunk();
+}
+
+void Gamecard::loadState(StateReader &state) {
+	state.beginChunk("CART", 1);
+	state.read(encryptionMode);
+	state.read(chipId);
+	state.read(currentCommand);
+	state.read(bytesRead);
+	state.read(dataBlockSizeBytes);
+	state.read(level1);
+	state.read(level2);
+	state.read(level3);
+	state.read(AUXSPICNT);
+	state.read(ROMCTRL);
+	state.read(nextCartridgeCommand);
+	state.read(key2Seed0Low9);
+	state.read(key2Seed0Low7);
+	state.read(key2Seed1Low9);
+	state.read(key2Seed1Low7);
+	state.read(key2Seed0High9);
+	state.read(key2Seed0High7);
+	state.read(key2Seed1High9);
+	state.read(key2Seed1High7);
+	state.read(cartridgeReadData);
+	state.endChunk();
+}
+
 void Gamecard::sendCommand() {
 	currentCommand = std::byteswap(nextCartridgeCommand);
 	bytesRead = 0;
@@ -70,7 +120,7 @@ void Gamecard::sendCommand() {
 	if (encryptionMode == ENCRYPTION_KEY1)
 		level2.decrypt(&currentCommand);
 
-	if (logGamecard) {
+	if (Instrumentation::logging && logGamecard) {
 		shared->log << fmt::format("[Gamecard] Command 0x{:0>16X} (0x{:X} bytes) - ", currentCommand, dataBlockSizeBytes);
 		switch (currentCommand >> 56) {
 		case 0x00: shared->log << "Get Header (from address 00000000h)\n"; break;
@@ -238,7 +288,8 @@ u8 Gamecard::readIO9(u32 address, bool final) {
 		val = (u8)(cartridgeReadData >> 24);
 		break;
 	default:
-		shared->log << fmt::format("[NDS9 Bus][Gamecard] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS9 Bus][Gamecard] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 
@@ -284,7 +335,7 @@ void Gamecard::writeIO9(u32 address, u8 value) {
 		ROMCTRL = (ROMCTRL & 0x00FFFFFF) | (((value & 0xFF) | 0x20) << 24);
 
 		if (blockStart && !oldStart) {
-			if (logGamecard)
+			if (Instrumentation::logging && logGamecard)
 				shared->log << "[NDS9 Bus]";
 			sendCommand();
 		}
@@ -348,7 +399,8 @@ void Gamecard::writeIO9(u32 address, u8 value) {
 	case 0x40001BB:
 		break;
 	default:
-		shared->log << fmt::format("[NDS9 Bus][Gamecard] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS9 Bus][Gamecard] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
 		break;
 	}
 }
@@ -405,7 +457,8 @@ u8 Gamecard::readIO7(u32 address, bool final) {
 		val = (u8)(cartridgeReadData >> 24);
 		break;
 	default:
-		shared->log << fmt::format("[NDS7 Bus][Gamecard] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][Gamecard] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 
@@ -451,7 +504,7 @@ void Gamecard::writeIO7(u32 address, u8 value) {
 		ROMCTRL = (ROMCTRL & 0x00FFFFFF) | (((value & 0xFF) | 0x20) << 24);
 
 		if (blockStart && !oldStart) {
-			if (logGamecard)
+			if (Instrumentation::logging && logGamecard)
 				shared->log << "[NDS7 Bus]";
 			sendCommand();
 		}
@@ -515,7 +568,8 @@ void Gamecard::writeIO7(u32 address, u8 value) {
 	case 0x40001BB:
 		break;
 	default:
-		shared->log << fmt::format("[NDS7 Bus][Gamecard] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][Gamecard] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
 		break;
 	}
 }
@@ -0,0 +1,191 @@
+#include "emulator/fastmem.hpp"
+
+#include <cerrno>
+#include <mutex>
+
+#ifdef __linux__
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Every reservation, so the handler can tell our faults apart from real crashes.
+// Slots are reused but never freed, so the handler can walk the list at any time without locking. There's no limit on
+// how many instances can have fastmem on at once.
+struct Fastmem::Reservation {
+	std::atomic<u8 *> start; // nullptr if the slot is free
+	Reservation *next; // Never changes once the slot is in the list
+};
+static std::atomic<Fastmem::Reservation *> reservations = nullptr;
+static size_t hostPageSize;
+static struct sigaction previousAction;
+
+static void faultHandler(int signal, siginfo_t *info, void *context) {
+	u8 *address = (u8 *)info->si_addr;
+	for (auto reservation = reservations.load(std::memory_order_acquire); reservation; reservation = reservation->next) {
+		u8 *start = reservation->start.load(std::memory_order_acquire);
+		if (!start || (address < start) || (address >= (start + Fastmem::RESERVATION_SIZE)))
+			continue;
+
+		// Give the access somewhere harmless to go. Everything in the reservation that isn't mapped to guest memory is
+		// anonymous memory with no access, so just let this one page be accessed. Whatever the access reads or writes is
+		// thrown away when recover() puts the page back. Unlike mmap, mprotect only changes the protection, which is safe here.
+		u8 *page = (u8 *)((uintptr_t)address & ~(hostPageSize - 1));
+		mprotect(page, hostPageSize, PROT_READ | PROT_WRITE);
+		Fastmem::faultPage = page;
+		return;
+	}
+
+	// Not ours, so let whoever was there before deal with it
+	if (previousAction.sa_flags & SA_SIGINFO) {
+		previousAction.sa_sigaction(signal, info, context);
+	} else if ((previousAction.sa_handler == SIG_DFL) || (previousAction.sa_handler == SIG_IGN)) {
+		sigaction(signal, &previousAction, nullptr); // Returning runs the access again, and this time it crashes
+	} else {
+		previousAction.sa_handler(signal);
+	}
+}
+
+// Only the first call does anything. The batch runner can have several instances turning fastmem on at once.
+static void installHandler() {
+	static std::once_flag installed;
+	std::call_once(installed, []() {
+		hostPageSize = sysconf(_SC_PAGESIZE); // Before the handler, which uses it
+
+		struct sigaction action = {};
+		action.sa_sigaction = faultHandler;
+		action.sa_flags = SA_SIGINFO;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGSEGV, &action, &previousAction);
+	});
+}
+#endif
+
+Fastmem::Fastmem() {
+	base = nullptr;
+	memory = nullptr;
+	slot = nullptr;
+}
+
+Fastmem::~Fastmem() {
+	disable();
+}
+
+int Fastmem::enable(GuestMemory &memory) {
+#ifdef __linux__
+	if (base)
+		return 0;
+
+	installHandler();
+	if (hostPageSize > PAGE_SIZE)
+		return EINVAL;
+
+	int error = memory.share();
+	if (error)
+		return error;
+
+	u8 *reservation = (u8 *)mmap(nullptr, RESERVATION_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (reservation == MAP_FAILED)
+		return errno;
+
+	// Take a free slot, or add one if they're all in use
+	for (auto free = reservations.load(std::memory_order_acquire); free; free = free->next) {
+		u8 *empty = nullptr;
+		if (free->start.compare_exchange_strong(empty, reservation, std::memory_order_release)) {
+			slot = free;
+			break;
+		}
+	}
+	if (!slot) {
+		slot = new Reservation;
+		slot->start.store(reservation, std::memory_order_relaxed);
+		slot->next = reservations.load(std::memory_order_relaxed);
+		while (!reservations.compare_exchange_weak(slot->next, slot, std::memory_order_release, std::memory_order_relaxed))
+			;
+	}
+	base = reservation;
+
+	this->memory = &memory;
+	shadow = std::make_unique<u8 *[]>(PAGE_COUNT); // Everything starts out unmapped
+	return 0;
+#else
+	return ENOSYS;
+#endif
+}
+
+void Fastmem::disable() {
+#ifdef __linux__
+	if (!base)
+		return;
+
+	slot->start.store(nullptr, std::memory_order_release);
+	slot = nullptr;
+	munmap(base, RESERVATION_SIZE);
+	base = nullptr;
+	shadow.reset();
+#endif
+}
+
+void Fastmem::remap(u8 *const *readTable, u8 *const *writeTable) {
+	if (!base)
+		return;
+
+	auto target = [&](u32 page) { return (readTable[page] == writeTable[page]) ? mappable(readTable[page]) : nullptr; };
+	for (u32 page = 0; page < PAGE_COUNT;) {
+		u8 *first = target(page);
+		if (first == shadow[page]) [[likely]] {
+			page++;
+			continue;
+		}
+
+		// Do as many pages as possible in one call. PSRAM's 4MB mirrors each go in one piece.
+		u32 count = 1;
+		while ((page + count) < PAGE_COUNT) {
+			u8 *next = target(page + count);
+			if ((next == shadow[page + count]) || (next != (first ? (first + (count * PAGE_SIZE)) : nullptr)))
+				break;
+			count++;
+		}
+
+		mapRun(page, count, first);
+		page += count;
+	}
+}
+
+// Only pages that are entirely inside guest memory can be mapped. Anything else has to stay on the slow path.
+u8 *Fastmem::mappable(u8 *pointer) {
+	if ((pointer < memory->base) || (pointer >= (memory->base + GuestMemory::SIZE)))
+		return nullptr;
+	if ((pointer - memory->base) % PAGE_SIZE)
+		return nullptr;
+	return pointer;
+}
+
+void Fastmem::mapRun(u32 firstPage, u32 count, u8 *target) {
+#ifdef __linux__
+	u8 *start = base + ((size_t)firstPage * PAGE_SIZE);
+	size_t size = (size_t)count * PAGE_SIZE;
+
+	// If mapping the file fails the pages are just left unmapped, which is slower but still right
+	if (target && (mmap(start, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, memory->fd, target - memory->base) == MAP_FAILED))
+		target = nullptr;
+	if (!target)
+		mmap(start, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+
+	for (u32 i = 0; i < count; i++)
+		shadow[firstPage + i] = target ? (target + (i * PAGE_SIZE)) : nullptr;
+#endif
+}
+
+void Fastmem::recover() {
+#ifdef __linux__
+	u8 *page = faultPage;
+	faultPage = nullptr;
+
+	size_t guestPage = (page - base) / PAGE_SIZE;
+	if (guestPage < PAGE_COUNT) {
+		mapRun(guestPage, 1, shadow[guestPage]);
+	} else {
+		mmap(page, hostPageSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+	}
+#endif
+}
@@ -0,0 +1,66 @@
+#include "emulator/framepacer.hpp"
+
+#include <thread>
+
+// If the emulator falls this far behind, give up on catching up instead of running at full speed until it does
+static constexpr auto MAX_LAG = std::chrono::milliseconds(100);
+
+FramePacer::FramePacer() {
+	mode = REALTIME;
+	fastForwardMultiplier = 4;
+	fastForwardAudio = AUDIO_DECIMATE;
+	reset();
+}
+
+FramePacer::~FramePacer() {
+	//
+}
+
+void FramePacer::reset() {
+	nextFrameTime = lastSpeedPoll = Clock::now();
+	framesSinceSpeedPoll = 0;
+	speedPercent = 0;
+}
+
+// Called once per emulated frame. Sleeps until it's time to start the next one.
+void FramePacer::frame() {
+	auto now = Clock::now();
+
+	++framesSinceSpeedPoll;
+	std::chrono::duration<double> sincePoll = now - lastSpeedPoll;
+	if (sincePoll >= std::chrono::seconds(1)) {
+		speedPercent = (framesSinceSpeedPoll / sincePoll.count()) / FRAME_RATE * 100;
+		framesSinceSpeedPoll = 0;
+		lastSpeedPoll = now;
+	}
+
+	double speed = targetSpeed();
+	if (speed == 0) {
+		nextFrameTime = now;
+		return;
+	}
+
+	nextFrameTime += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1 / (FRAME_RATE * speed)));
+	if (nextFrameTime > now) {
+		std::this_thread::sleep_until(nextFrameTime);
+	} else if ((now - nextFrameTime) > MAX_LAG) {
+		nextFrameTime = now;
+	}
+}
+
+// Returns how many times faster than a real DS to run, or 0 for no limit
+double FramePacer::targetSpeed() {
+	switch (mode) {
+	case REALTIME: return 1;
+	case FAST_FORWARD: return std::max(fastForwardMultiplier.load(), 1);
+	default: return 0;
+	}
+}
+
+bool FramePacer::audioMuted() {
+	return (mode == UNCAPPED) || ((mode == FAST_FORWARD) && (fastForwardAudio == AUDIO_MUTE));
+}
+
+int FramePacer::audioDecimation() {
+	return ((mode == FAST_FORWARD) && (fastForwardAudio == AUDIO_DECIMATE)) ? std::max(fastForwardMultiplier.load(), 1) : 1;
+}
@@ -0,0 +1,121 @@
+#include "emulator/guestmemory.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static constexpr bool layoutIsValid() {
+	for (int i = 1; i < GuestMemory::REGION_COUNT; i++) {
+		if (GuestMemory::layout[i].offset != (GuestMemory::layout[i - 1].offset + GuestMemory::layout[i - 1].size))
+			return false;
+	}
+	return true;
+}
+static_assert(layoutIsValid(), "Guest memory regions should be packed in order");
+
+GuestMemory::GuestMemory() {
+#ifdef _WIN32
+	// Large pages on Windows need a privilege most users don't have, so just make one normal allocation
+	base = (u8 *)VirtualAlloc(nullptr, SIZE, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (!base) {
+		// Nothing can run without it, and every component holds pointers into it
+		fmt::print(stderr, "GuestMemory: Failed to allocate {}MB (error {})\n", SIZE >> 20, GetLastError());
+		abort();
+	}
+	pageType = PAGES_NORMAL;
+	fd = -1;
+#else
+	base = (u8 *)MAP_FAILED;
+	pageType = PAGES_NORMAL;
+	fd = -1;
+#ifdef MAP_HUGETLB
+	// Only works if the system has huge pages reserved
+	base = (u8 *)mmap(nullptr, SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (base != MAP_FAILED)
+		pageType = PAGES_EXPLICIT_HUGE;
+#endif
+
+	if (base == MAP_FAILED) {
+		// Over-allocate so the block can start on a huge page boundary, then give back the ends
+		u8 *block = (u8 *)mmap(nullptr, SIZE + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (block == MAP_FAILED) {
+			fmt::print(stderr, "GuestMemory: Failed to allocate {}MB : {}\n", (SIZE + HUGE_PAGE_SIZE) >> 20, strerror(errno));
+			abort();
+		}
+
+		base = (u8 *)(((uintptr_t)block + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+		if (base != block)
+			munmap(block, base - block);
+		munmap(base + SIZE, (block + SIZE + HUGE_PAGE_SIZE) - (base + SIZE));
+
+#ifdef MADV_HUGEPAGE
+		if (!madvise(base, SIZE, MADV_HUGEPAGE))
+			pageType = PAGES_TRANSPARENT_HUGE;
+#endif
+	}
+#endif
+}
+
+GuestMemory::~GuestMemory() {
+	if (!base)
+		return;
+
+#ifdef _WIN32
+	VirtualFree(base, 0, MEM_RELEASE);
+#else
+	munmap(base, SIZE);
+	if (fd >= 0)
+		close(fd);
+#endif
+}
+
+int GuestMemory::share() {
+#ifdef __linux__
+	if (fd >= 0)
+		return 0;
+	if (!base)
+		return ENOMEM;
+
+	int file = memfd_create("ortin-guest-memory", MFD_CLOEXEC);
+	if (file < 0)
+		return errno;
+	if (ftruncate(file, SIZE)) {
+		int error = errno;
+		close(file);
+		return error;
+	}
+	for (size_t written = 0; written < SIZE;) {
+		ssize_t result = pwrite(file, base + written, SIZE - written, written);
+		if (result < 0) {
+			int error = errno;
+			close(file);
+			return error;
+		}
+		written += result;
+	}
+
+	// Swap the file in over the old pages. Everything pointing into the arena stays valid.
+	if (mmap(base, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, file, 0) == MAP_FAILED) {
+		int error = errno;
+		close(file);
+		return error;
+	}
+	fd = file;
+
+	// hugetlbfs can only be mapped in 2MB pieces, so the file is plain shmem and huge pages are just a hint now
+	pageType = PAGES_NORMAL;
+#ifdef MADV_HUGEPAGE
+	if (!madvise(base, SIZE, MADV_HUGEPAGE))
+		pageType = PAGES_TRANSPARENT_HUGE;
+#endif
+	return 0;
+#else
+	return ENOSYS;
+#endif
+}
@@ -0,0 +1,71 @@
+#include "emulator/idleloop.hpp"
+
+#include <unordered_map>
+
+// Games that misbehave when their polling loops are skipped, keyed by the 4 character game code at 0x00C in the header
+static const std::unordered_map<std::string, IdleLoopDetector::Override> overrides = {
+	// {"XXXX", {.arm9 = false, .arm7 = true}},
+};
+
+IdleLoopDetector::Override IdleLoopDetector::lookupOverride(const std::string &gameCode) {
+	auto it = overrides.find(gameCode);
+	if (it == overrides.end())
+		return {.arm9 = true, .arm7 = true};
+
+	return it->second;
+}
+
+IdleLoopDetector::IdleLoopDetector() {
+	enabled = true;
+	reset();
+}
+
+IdleLoopDetector::~IdleLoopDetector() {
+	//
+}
+
+void IdleLoopDetector::reset() {
+	idle = active = clean = false;
+	lastPc = loopStart = loopEnd = 0;
+	matches = 0;
+}
+
+// Something outside the CPU might have changed, so it has to prove the loop is idle again
+void IdleLoopDetector::wake() {
+	idle = false;
+	matches = 0;
+}
+
+// Memory and I/O registers that only change when an event happens or something gets written
+bool IdleLoopDetector::pollable(u32 address) {
+	if ((address < 0x4000000) || (address > 0x4FFFFFF))
+		return true;
+
+	switch (address) {
+	case 0x4000004 ... 0x4000007: // DISPSTAT, VCOUNT
+	case 0x4000130 ... 0x4000137: // KEYINPUT, KEYCNT, EXTKEYIN
+	case 0x4000180 ... 0x4000187: // IPCSYNC, IPCFIFOCNT. IPC wakes the other CPU whenever it changes these.
+	case 0x4000208 ... 0x4000217: // IME, IE, IF
+	case 0x4000300: // POSTFLG
+		return true;
+	default: // Timers, math busy flags, etc. can change on their own
+		return false;
+	}
+}
+
+bool IdleLoopDetector::loopHead(u32 pc, u32 branchPc, const u32 *reg, u32 cpsr) {
+	if (active && clean && (pc == loopStart) && (cpsr == savedCpsr) && !memcmp(reg, savedReg, sizeof(savedReg))) {
+		if (++matches >= REQUIRED_MATCHES)
+			idle = true;
+	} else { // Start watching a new loop
+		loopStart = pc;
+		loopEnd = branchPc;
+		matches = 0;
+		memcpy(savedReg, reg, sizeof(savedReg));
+		savedCpsr = cpsr;
+		active = true;
+	}
+
+	clean = true;
+	return idle;
+}
@@ -0,0 +1,31 @@
+#include "emulator/iotable.hpp"
+
+IoTable::IoTable() {
+	handlers.push_back({});
+	memset(readIndex, 0, sizeof(readIndex));
+	memset(writeIndex, 0, sizeof(writeIndex));
+}
+
+IoTable::~IoTable() {
+	//
+}
+
+void IoTable::setFallback(Handler handler) {
+	handlers[0] = handler;
+}
+
+void IoTable::add(u32 start, u32 end, Handler handler) {
+	if (handlers.size() > UINT16_MAX) {
+		fmt::print(stderr, "IoTable: Too many handlers to add 0x{:0>7X} - 0x{:0>7X}\n", start, end);
+		abort();
+	}
+	u16 id = handlers.size();
+	handlers.push_back(handler);
+
+	for (u32 address = start; address <= end; address++) {
+		if (handler.read8)
+			readIndex[toIndex(address)] = id;
+		if (handler.write8)
+			writeIndex[toIndex(address)] = id;
+	}
+}
@@ -20,6 +20,48 @@ void IPC::reset() {
 	fifo7to9 = {};
 }
 
+void IPC::saveState(StateWriter &state) {
+	state.beginChunk("IPC ", 1);
+	state.write(IPCSYNC9);
+	state.write(IPCSYNC7);
+	state.write(IPCFIFOCNT9);
+	state.write(IPCFIFOCNT7);
+	state.write(IPCFIFOSEND9);
+	state.write(IPCFIFOSEND7);
+	state.write(IPCFIFORECV9);
+	state.write(IPCFIFORECV7);
+	state.write(sendIrq9Status);
+	state.write(recvIrq9Status);
+	state.write(sendIrq7Status);
+	state.write(recvIrq7Status);
+	state.write(sendMask9);
+	state.write(sendMask7);
+	state.writeQueue(fifo9to7);
+	state.writeQueue(fifo7to9);
+	state.endChunk();
+}
+
+void IPC::loadState(StateReader &state) {
+	state.beginChunk("IPC ", 1);
+	state.read(IPCSYNC9);
+	state.read(IPCSYNC7);
+	state.read(IPCFIFOCNT9);
+	state.read(IPCFIFOCNT7);
+	state.read(IPCFIFOSEND9);
+	state.read(IPCFIFOSEND7);
+	state.read(IPCFIFORECV9);
+	state.read(IPCFIFORECV7);
+	state.read(sendIrq9Status);
+	state.read(recvIrq9Status);
+	state.read(sendIrq7Status);
+	state.read(recvIrq7Status);
+	state.read(sendMask9);
+	state.read(sendMask7);
+	state.readQueue(fifo9to7);
+	state.readQueue(fifo7to9);
+	state.endChunk();
+}
+
 u8 IPC::readIO9(u32 address, bool final) {
 	u8 val = 0;
 	switch (address) {
@@ -50,47 +92,54 @@ u8 IPC::readIO9(u32 address, bool final) {
 		val = (u8)(IPCFIFORECV9 >> 24);
 		break;
 	default:
-		shared->log << fmt::format("[NDS9 Bus][IPC] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS9 Bus][IPC] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 
-	// Pop value off the recieve FIFO
-	if (final && fifoEnable9) {
-		sendIrq7Status = sendFifoEmptyIrq7 && sendFifoEmpty7;
+	if (final && fifoEnable9)
+		popFifo9();
 
-		bool wasEmpty = true;
-		if (fifo7to9.empty()) {
-			fifoError9 = true;
-		} else {
-			wasEmpty = false;
-			fifo7to9.pop();
-		}
+	return val;
+}
 
-		if (fifo7to9.empty()) {
-			sendFifoEmpty7 = true;
-			sendFifoFull7 = false;
-			receiveFifoEmpty9 = true;
-			receiveFifoFull9 = false;
+// Pop value off the recieve FIFO
+void IPC::popFifo9() {
+	BusShared::requestWake(shared->wakeArm7);
+	sendIrq7Status = sendFifoEmptyIrq7 && sendFifoEmpty7;
+
+	bool wasEmpty = true;
+	if (fifo7to9.empty()) {
+		fifoError9 = true;
+	} else {
+		wasEmpty = false;
+		fifo7to9.pop();
+	}
 
-			//IPCFIFORECV9 = 0;
-		} else {
-			sendFifoEmpty7 = false;
-			sendFifoFull7 = false;
-			receiveFifoEmpty9 = false;
-			receiveFifoFull9 = false;
+	if (fifo7to9.empty()) {
+		sendFifoEmpty7 = true;
+		sendFifoFull7 = false;
+		receiveFifoEmpty9 = true;
+		receiveFifoFull9 = false;
 
-			IPCFIFORECV9 = fifo7to9.front();
-		}
+		//IPCFIFORECV9 = 0;
+	} else {
+		sendFifoEmpty7 = false;
+		sendFifoFull7 = false;
+		receiveFifoEmpty9 = false;
+		receiveFifoFull9 = false;
 
-		if (!sendIrq7Status && sendFifoEmptyIrq7 && sendFifoEmpty7)
-			shared->addEvent(0, EventType::IPC_SEND_FIFO7);
-		sendIrq7Status = sendFifoEmptyIrq7 && sendFifoEmpty7;
+		IPCFIFORECV9 = fifo7to9.front();
 	}
 
-	return val;
+	if (!sendIrq7Status && sendFifoEmptyIrq7 && sendFifoEmpty7)
+		shared->addEvent(0, EventType::IPC_SEND_FIFO7);
+	sendIrq7Status = sendFifoEmptyIrq7 && sendFifoEmpty7;
 }
 
 void IPC::writeIO9(u32 address, u8 value, bool final) {
+	// The other CPU might be polling IPCSYNC or IPCFIFOCNT
+	BusShared::requestWake(shared->wakeArm7);
 	switch (address) {
 	case 0x4000180:
 		return;
@@ -159,15 +208,14 @@ void IPC::writeIO9(u32 address, u8 value, bool final) {
 		sendMask9 |= 0xFF000000;
 		break;
 	default:
-		shared->log << fmt::format("[NDS9 Bus][IPC] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS9 Bus][IPC] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
 		return;
 	}
 
 	// Push value into FIFO
 	if (final) {
 		if (fifoEnable9) {
-			recvIrq7Status = receiveFifoNotEmptyIrq7 && !receiveFifoEmpty7;
-
 			// Mirror value if write is 8 or 16 bits
 			IPCFIFOSEND9 >>= std::countr_zero(sendMask9);
 			sendMask9 >>= std::countr_zero(sendMask9);
@@ -178,23 +226,7 @@ void IPC::writeIO9(u32 address, u8 value, bool final) {
 				IPCFIFOSEND9 |= IPCFIFOSEND9 << 16;
 			}
 
-			bool wasEmpty = fifo9to7.empty();
-			if (fifo9to7.size() == 16) {
-				fifoError9 = true;
-			} else {
-				fifo9to7.push(IPCFIFOSEND9);
-				IPCFIFORECV7 = fifo9to7.front();
-				bool full = fifo9to7.size() == 16;
-
-				sendFifoEmpty9 = false;
-				sendFifoFull9 = full;
-				receiveFifoEmpty7 = false;
-				receiveFifoFull7 = full;
-			}
-
-			if (!recvIrq7Status && receiveFifoNotEmptyIrq7 && !receiveFifoEmpty7)
-				shared->addEvent(0, EventType::IPC_RECV_FIFO7);
-			recvIrq7Status = receiveFifoNotEmptyIrq7 && !receiveFifoEmpty7;
+			pushFifo9(IPCFIFOSEND9);
 		}
 
 		IPCFIFOSEND9 = 0;
@@ -202,6 +234,44 @@ void IPC::writeIO9(u32 address, u8 value, bool final) {
 	}
 }
 
+void IPC::pushFifo9(u32 value) {
+	BusShared::requestWake(shared->wakeArm7);
+	recvIrq7Status = receiveFifoNotEmptyIrq7 && !receiveFifoEmpty7;
+
+	bool wasEmpty = fifo9to7.empty();
+	if (fifo9to7.size() == 16) {
+		fifoError9 = true;
+	} else {
+		fifo9to7.push(value);
+		IPCFIFORECV7 = fifo9to7.front();
+		bool full = fifo9to7.size() == 16;
+
+		sendFifoEmpty9 = false;
+		sendFifoFull9 = full;
+		receiveFifoEmpty7 = false;
+		receiveFifoFull7 = full;
+	}
+
+	if (!recvIrq7Status && receiveFifoNotEmptyIrq7 && !receiveFifoEmpty7)
+		shared->addEvent(0, EventType::IPC_RECV_FIFO7);
+	recvIrq7Status = receiveFifoNotEmptyIrq7 && !receiveFifoEmpty7;
+}
+
+// 32-bit accesses to IPCFIFOSEND and IPCFIFORECV, which don't need any of the mirroring the byte writes do
+void IPC::send9(u32 value) {
+	if (fifoEnable9)
+		pushFifo9(value);
+	IPCFIFOSEND9 = 0;
+	sendMask9 = 0;
+}
+
+u32 IPC::receive9() {
+	u32 val = IPCFIFORECV9;
+	if (fifoEnable9)
+		popFifo9();
+	return val;
+}
+
 u8 IPC::readIO7(u32 address, bool final) {
 	u8 val = 0;
 	switch (address) {
@@ -232,47 +302,54 @@ u8 IPC::readIO7(u32 address, bool final) {
 		val = (u8)(IPCFIFORECV7 >> 24);
 		break;
 	default:
-		shared->log << fmt::format("[NDS7 Bus][IPC] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][IPC] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 
-	// Pop value off the recieve FIFO
-	if (final && fifoEnable7) {
-		sendIrq9Status = sendFifoEmptyIrq9 && sendFifoEmpty9;
+	if (final && fifoEnable7)
+		popFifo7();
 
-		bool wasEmpty = true;
-		if (fifo9to7.empty()) {
-			fifoError7 = true;
-		} else {
-			wasEmpty = false;
-			fifo9to7.pop();
-		}
+	return val;
+}
 
-		if (fifo9to7.empty()) {
-			sendFifoEmpty9 = true;
-			sendFifoFull9 = false;
-			receiveFifoEmpty7 = true;
-			receiveFifoFull7 = false;
+// Pop value off the recieve FIFO
+void IPC::popFifo7() {
+	BusShared::requestWake(shared->wakeArm9);
+	sendIrq9Status = sendFifoEmptyIrq9 && sendFifoEmpty9;
+
+	bool wasEmpty = true;
+	if (fifo9to7.empty()) {
+		fifoError7 = true;
+	} else {
+		wasEmpty = false;
+		fifo9to7.pop();
+	}
 
-			//IPCFIFORECV7 = 0;
-		} else {
-			sendFifoEmpty9 = false;
-			sendFifoFull9 = false;
-			receiveFifoEmpty7 = false;
-			receiveFifoFull7 = false;
+	if (fifo9to7.empty()) {
+		sendFifoEmpty9 = true;
+		sendFifoFull9 = false;
+		receiveFifoEmpty7 = true;
+		receiveFifoFull7 = false;
 
-			IPCFIFORECV7 = fifo9to7.front();
-		}
+		//IPCFIFORECV7 = 0;
+	} else {
+		sendFifoEmpty9 = false;
+		sendFifoFull9 = false;
+		receiveFifoEmpty7 = false;
+		receiveFifoFull7 = false;
 
-		if (!sendIrq9Status && sendFifoEmptyIrq9 && sendFifoEmpty9)
-			shared->addEvent(0, EventType::IPC_SEND_FIFO9);
-		sendIrq9Status = sendFifoEmptyIrq9 && sendFifoEmpty9;
+		IPCFIFORECV7 = fifo9to7.front();
 	}
 
-	return val;
+	if (!sendIrq9Status && sendFifoEmptyIrq9 && sendFifoEmpty9)
+		shared->addEvent(0, EventType::IPC_SEND_FIFO9);
+	sendIrq9Status = sendFifoEmptyIrq9 && sendFifoEmpty9;
 }
 
 void IPC::writeIO7(u32 address, u8 value, bool final) {
+	// The other CPU might be polling IPCSYNC or IPCFIFOCNT
+	BusShared::requestWake(shared->wakeArm9);
 	switch (address) {
 	case 0x4000180:
 		return;
@@ -341,14 +418,13 @@ void IPC::writeIO7(u32 address, u8 value, bool final) {
 		sendMask7 |= 0xFF000000;
 		break;
 	default:
-		shared->log << fmt::format("[NDS7 Bus][IPC] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][IPC] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
 		return;
 	}
 
 	// Push value into FIFO
 	if (final) {
-		recvIrq9Status = receiveFifoNotEmptyIrq9 && !receiveFifoEmpty9;
-
 		if (fifoEnable7) {
 			// Mirror value if write is 8 or 16 bits
 			IPCFIFOSEND7 >>= std::countr_zero(sendMask7);
@@ -360,26 +436,47 @@ void IPC::writeIO7(u32 address, u8 value, bool final) {
 				IPCFIFOSEND7 |= IPCFIFOSEND7 << 16;
 			}
 
-			bool wasEmpty = fifo7to9.empty();
-			if (fifo7to9.size() == 16) {
-				fifoError7 = true;
-			} else {
-				fifo7to9.push(IPCFIFOSEND7);
-				IPCFIFORECV9 = fifo7to9.front();
-				bool full = fifo7to9.size() == 16;
-
-				sendFifoEmpty7 = false;
-				sendFifoFull7 = full;
-				receiveFifoEmpty9 = false;
-				receiveFifoFull9 = full;
-			}
+			pushFifo7(IPCFIFOSEND7);
 		}
 
 		IPCFIFOSEND7 = 0;
 		sendMask7 = 0;
+	}
+}
 
-		if (!recvIrq9Status && receiveFifoNotEmptyIrq9 && !receiveFifoEmpty9)
-			shared->addEvent(0, EventType::IPC_RECV_FIFO9);
-		recvIrq9Status = receiveFifoNotEmptyIrq9 && !receiveFifoEmpty9;
+void IPC::pushFifo7(u32 value) {
+	BusShared::requestWake(shared->wakeArm9);
+	recvIrq9Status = receiveFifoNotEmptyIrq9 && !receiveFifoEmpty9;
+
+	bool wasEmpty = fifo7to9.empty();
+	if (fifo7to9.size() == 16) {
+		fifoError7 = true;
+	} else {
+		fifo7to9.push(value);
+		IPCFIFORECV9 = fifo7to9.front();
+		bool full = fifo7to9.size() == 16;
+
+		sendFifoEmpty7 = false;
+		sendFifoFull7 = full;
+		receiveFifoEmpty9 = false;
+		receiveFifoFull9 = full;
 	}
+
+	if (!recvIrq9Status && receiveFifoNotEmptyIrq9 && !receiveFifoEmpty9)
+		shared->addEvent(0, EventType::IPC_RECV_FIFO9);
+	recvIrq9Status = receiveFifoNotEmptyIrq9 && !receiveFifoEmpty9;
+}
+
+void IPC::send7(u32 value) {
+	if (fifoEnable7)
+		pushFifo7(value);
+	IPCFIFOSEND7 = 0;
+	sendMask7 = 0;
+}
+
+u32 IPC::receive7() {
+	u32 val = IPCFIFORECV7;
+	if (fifoEnable7)
+		popFifo7();
+	return val;
 }
\ No newline at end of file
@@ -10,6 +10,13 @@
 #include "emulator/nds7/apu.hpp"
 #include "emulator/nds7/wifi.hpp"
 
+#include <cctype>
+#include <fstream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 NDS::NDS() {
 	shared = std::make_shared<BusShared>();
 	ppu = std::make_shared<PPU>(shared);
@@ -23,19 +30,75 @@ NDS::NDS() {
 
 	romInfo.romLoaded = romInfo.bios9Loaded = romInfo.bios7Loaded = romInfo.firmwareLoaded = false;
 	running = false;
-	stepArm9 = stepArm7 = 0;
+	stepArm9 = stepArm7 = false;
+	resumeLatency = 0;
+	frameEnded = false;
+	cycleLimit = UINT64_MAX;
+	syncQuantum = 64;
+	threadedArm7 = false;
+	idleLoopDetection = true;
+	idleCyclesSkipped = 0;
+	arm7ThreadExit = false;
+	arm7SliceRequested = arm7SliceFinished = 0;
+	arm7Sleeping = arm9Sleeping = false;
+	handoffTime = 0;
+	arm7CycleTime = 0;
+	parallelMinSlice = UINT64_MAX;
+	arm7TimedSlices = 0;
+	arm7ThreadUnavailable = false;
+	nds9timestamp = nds7timestamp = 0;
+	rewindEnabled = false;
+	rewindInterval = 2;
+	rewindBudget = 256;
+	rewinding = false;
+	framesSinceSnapshot = 0;
+	rewindCaptureTime = 0;
+	runAheadFrames = 0;
+	runAheadThreaded = false;
+	speculative = false;
+	aheadThreadExit = false;
+	aheadRequested = aheadFinished = 0;
+	aheadFrameReady = false;
+	bootCache = false;
+	bootCacheDirectory = std::filesystem::temp_directory_path() / "ortin-boot-cache";
+	bootSnapshotPending = false;
+	bootArm7Entered = false;
+	timeTravelEnabled = false;
+	keyframeInterval = 30;
+	timeTravelBudget = 1024;
 
 	disassembler9.defaultSettings();
 	disassembler7.defaultSettings();
+
+	// Events that need more than one component. Everything else is registered by the component itself.
+	shared->registerEvent(EventType::STOP, [](void *nds, int) { ((NDS *)nds)->running.store(false, std::memory_order_release); }, this);
+	shared->registerEvent(PPU_LINE_START, [](void *nds, int) { ((NDS *)nds)->lineStartEvent(); }, this);
+	shared->registerEvent(PPU_HBLANK, [](void *nds, int) { ((NDS *)nds)->hBlankEvent(); }, this);
+	shared->registerEvent(REFRESH_PAGES, [](void *nds, int) { ((NDS *)nds)->refreshPagesEvent(); }, this);
+	shared->registerEvent(GAMECARD_TRANSFER_READY, [](void *nds, int type) { ((NDS *)nds)->gamecardEvent((EventType)type); }, this, GAMECARD_TRANSFER_READY);
+	shared->registerEvent(GAMECARD_COMMAND_COMPLETE, [](void *nds, int type) { ((NDS *)nds)->gamecardEvent((EventType)type); }, this, GAMECARD_COMMAND_COMPLETE);
 }
 
 NDS::~NDS() {
-	//
+	stopAheadThread();
+
+	if (arm7Thread.joinable()) {
+		arm7ThreadExit = true;
+		arm7SliceRequested.fetch_add(1, std::memory_order_release);
+		arm7SliceRequested.notify_one();
+		arm7Thread.join();
+	}
 }
 
 void NDS::reset() {
-	running = false;
-	nds7->apu->soundRunning = false;
+	running.store(false, std::memory_order_release);
+	stopAheadThread(); // The ROM, BIOS, or firmware might have changed
+	if (bootSnapshotPending) {
+		nds9->cpu->removeBreakpoint(romInfo.arm9EntryPoint);
+		if (!bootArm7Entered)
+			nds7->cpu->removeBreakpoint(romInfo.arm7EntryPoint);
+		bootSnapshotPending = false;
+	}
 
 	shared->reset();
 	ipc->reset();
@@ -52,8 +115,20 @@ void NDS::reset() {
 
 	nds9->delay = 0;
 	nds7->delay = 0;
+	nds9timestamp = 0;
+	nds7timestamp = 0;
+	idleCyclesSkipped = 0;
+	pacer.reset();
+	rewind.clear();
+	framesSinceSnapshot = 0;
+	history.clear();
 
-	nds7->apu->soundRunning = true;
+	if (bootCache && romInfo.romLoaded && romInfo.bios9Loaded && romInfo.bios7Loaded && romInfo.firmwareLoaded && !loadBootSnapshot()) {
+		nds9->cpu->addBreakpoint(romInfo.arm9EntryPoint);
+		nds7->cpu->addBreakpoint(romInfo.arm7EntryPoint);
+		bootSnapshotPending = true;
+		bootArm7Entered = false;
+	}
 }
 
 void NDS::directBoot() {
@@ -107,205 +182,1103 @@ void NDS::directBoot() {
 	nds7->POSTFLG = 1;
 }
 
+void NDS::saveState(std::vector<u8> &buffer) {
+	StateWriter state(buffer);
+	saveState(state);
+}
+
+void NDS::saveState(StateWriter &state) {
+	char gameCode[4] = {0};
+	memcpy(gameCode, romInfo.gameCode.data(), std::min(romInfo.gameCode.size(), sizeof(gameCode)));
+	state.beginChunk("NDS ", 1);
+	state.write(gameCode);
+	state.write(nds9timestamp);
+	state.write(nds7timestamp);
+	state.endChunk();
+
+	// The big fixed size chunks go first. Anything after a FIFO moves around as it fills up, which makes rewind deltas bigger.
+	shared->saveState(state);
+	ppu->saveState(state);
+	gamecard->saveState(state);
+	nds9->saveState(state);
+	nds7->saveState(state);
+	ipc->saveState(state);
+}
+
+int NDS::loadState(const u8 *data, size_t size) {
+	StateReader state(data, size);
+
+	// Check everything that can be checked before overwriting anything
+	char gameCode[4];
+	state.beginChunk("NDS ", 1);
+	state.read(gameCode);
+	std::string savedGameCode(gameCode, strnlen(gameCode, sizeof(gameCode)));
+	if (!state.failed() && (savedGameCode != romInfo.gameCode))
+		state.fail(fmt::format("Save state is for {}, not {}", savedGameCode, romInfo.gameCode));
+	if (state.failed()) {
+		shared->log << fmt::format("Failed to load save state : {}\n", state.error);
+		return -1;
+	}
+	state.read(nds9timestamp);
+	state.read(nds7timestamp);
+	state.endChunk();
+
+	shared->loadState(state);
+	ppu->loadState(state);
+	gamecard->loadState(state);
+	nds9->loadState(state);
+	nds7->loadState(state);
+	ipc->loadState(state);
+	if (state.failed()) {
+		shared->log << fmt::format("Failed to load save state : {}\n", state.error);
+		return -1;
+	}
+
+	// Rebuild every page table from the registers that were just loaded
+	shared->dirtyPages = BusShared::PAGES_WRAM | BusShared::PAGES_VRAM | BusShared::PAGES_ROM;
+	refreshPagesEvent();
+
+	// Now that memory is back, refill the pipelines from the instruction each CPU was about to execute.
+	// The reads aren't something the game did, so they don't cost anything.
+	auto refillPipeline = [](auto &bus) {
+		i64 delay = bus.delay;
+		bus.cpu->reg.R[15] -= bus.cpu->reg.thumbMode ? 4 : 8;
+		bus.cpu->flushPipeline();
+		bus.delay = delay;
+	};
+	refillPipeline(*nds9);
+	refillPipeline(*nds7);
+
+	return 0;
+}
+
+int NDS::saveStateFile(std::filesystem::path path) {
+	std::vector<u8> buffer;
+	saveState(buffer);
+
+	std::ofstream file(path, std::ios::binary);
+	file.write((const char *)buffer.data(), buffer.size());
+	if (!file) {
+		shared->log << fmt::format("Failed to write save state : {}\n", path.string());
+		return -1;
+	}
+
+	return 0;
+}
+
+int NDS::loadStateFile(std::filesystem::path path) {
+	std::error_code error;
+	mio::ummap_source stateMap;
+
+	stateMap.map(path.c_str(), error);
+	if (error) {
+		shared->log << fmt::format("Failed to load save state {} : {}\n", path.string(), error.message());
+		return error.value();
+	}
+
+	// Components are loaded one after another, so a state that's broken partway through would leave a mix of the two.
+	// Keep the current state around to go back to.
+	std::vector<u8> backup;
+	saveState(backup);
+	if (loadState(stateMap.data(), stateMap.mapped_length())) {
+		loadState(backup.data(), backup.size());
+		return -1;
+	}
+
+	history.clear(); // The new state has no past
+	return 0;
+}
+
+void NDS::captureRewind() {
+	if (!rewindEnabled || (++framesSinceSnapshot < rewindInterval))
+		return;
+
+	auto start = std::chrono::steady_clock::now();
+	rewind.budget = (size_t)rewindBudget << 20;
+	saveState(rewindScratch);
+	rewind.push(rewindScratch);
+	framesSinceSnapshot = 0;
+	rewindCaptureTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Goes back to the last snapshot, or the one before it if nothing has run since it was taken
+bool NDS::stepBack() {
+	if (rewind.empty())
+		return false;
+	if ((framesSinceSnapshot == 0) && !rewind.stepBack())
+		return false;
+
+	framesSinceSnapshot = 0;
+	loadState(rewind.newest().data(), rewind.newest().size());
+	history.clear();
+	if (runAheadFrames > 0) {
+		memcpy(runAheadFramebuffer[0], ppu->framebufferA, sizeof(ppu->framebufferA));
+		memcpy(runAheadFramebuffer[1], ppu->framebufferB, sizeof(ppu->framebufferB));
+	}
+	ppu->updateScreen = true;
+	return true;
+}
+
+void NDS::runAhead() {
+	if (runAheadThreaded) {
+		if (!aheadInstance)
+			startAheadThread();
+
+		// Skip this frame if the second instance is still busy with one that timed out. It only reads runAheadState and
+		// writes its framebuffers while it has a request, so both are safe to touch here.
+		if (!aheadInstance || (aheadFinished.load(std::memory_order_acquire) != aheadRequested.load(std::memory_order_relaxed)))
+			return;
+
+		auto showAheadFrame = [&]() {
+			if (aheadFrameReady.exchange(false, std::memory_order_relaxed)) {
+				memcpy(runAheadFramebuffer[0], aheadInstance->ppu->framebufferA, sizeof(aheadInstance->ppu->framebufferA));
+				memcpy(runAheadFramebuffer[1], aheadInstance->ppu->framebufferB, sizeof(aheadInstance->ppu->framebufferB));
+				ppu->updateScreen = true;
+			}
+		};
+		showAheadFrame(); // One that timed out is a frame late, but still better than nothing
+
+		saveState(runAheadState);
+		u64 requested = aheadRequested.fetch_add(1, std::memory_order_release) + 1;
+		aheadRequested.notify_one();
+
+		// Wait for this frame's result, so it doesn't show up a frame late. Waiting longer than a frame would slow the
+		// emulator down though, so if it's not done by then it gets shown at the end of a later frame instead.
+		std::unique_lock lock(aheadMutex);
+		if (aheadDone.wait_for(lock, std::chrono::duration<double>(1 / FramePacer::FRAME_RATE), [&]() { return aheadFinished.load(std::memory_order_acquire) == requested; }))
+			showAheadFrame();
+		return;
+	}
+
+	saveState(runAheadState);
+	auto position = history.position;
+	speculative = true;
+	nds7->apu->discardOutput = true;
+	for (int i = 0; i < runAheadFrames; i++) {
+		runFrame();
+		if (!frameEnded) // A breakpoint in the future will be hit again for real, so don't stop for it now
+			break;
+	}
+
+	memcpy(runAheadFramebuffer[0], ppu->framebufferA, sizeof(ppu->framebufferA));
+	memcpy(runAheadFramebuffer[1], ppu->framebufferB, sizeof(ppu->framebufferB));
+	loadState(runAheadState.data(), runAheadState.size());
+	history.position = position;
+	nds7->apu->discardOutput = false;
+	speculative = false;
+	running.store(true, std::memory_order_relaxed);
+	frameEnded = true;
+	ppu->updateScreen = true;
+}
+
+void NDS::startAheadThread() {
+	auto ahead = std::make_unique<NDS>();
+	if (ahead->loadBios9(romInfo.bios9FilePath) || ahead->loadBios7(romInfo.bios7FilePath) || ahead->loadFirmware(romInfo.firmwareFilePath) || ahead->loadRom(romInfo.filePath)) {
+		shared->log << "Failed to start the run-ahead instance. Falling back to rolling back.\n";
+		runAheadThreaded = false;
+		return;
+	}
+
+	aheadFirmware.assign(ahead->firmwareMap.data(), ahead->firmwareMap.data() + ahead->firmwareMap.mapped_length());
+	ahead->nds7->spi->firmware.data = aheadFirmware.data();
+	ahead->reset();
+	ahead->nds7->apu->discardOutput = true;
+	ahead->ppu->hideFrames = true;
+	ahead->threadedArm7 = false;
+
+	aheadInstance = std::move(ahead);
+	aheadThreadExit = false;
+	aheadRequested = aheadFinished = 0;
+	aheadFrameReady = false;
+	aheadThread = std::thread(&NDS::aheadThreadLoop, this);
+}
+
+void NDS::stopAheadThread() {
+	if (aheadThread.joinable()) {
+		aheadThreadExit = true;
+		aheadRequested.fetch_add(1, std::memory_order_release);
+		aheadRequested.notify_one();
+		aheadThread.join();
+	}
+
+	aheadInstance.reset();
+}
+
+void NDS::aheadThreadLoop() {
+	u64 handled = 0;
+	while (true) {
+		aheadRequested.wait(handled, std::memory_order_acquire);
+		if (aheadThreadExit)
+			return;
+		handled = aheadRequested.load(std::memory_order_acquire);
+
+		// Both instances have to run exactly the same way for the future to be right
+		auto& ahead = *aheadInstance;
+		ahead.syncQuantum = syncQuantum;
+		ahead.idleLoopDetection = idleLoopDetection;
+		if (!ahead.loadState(runAheadState.data(), runAheadState.size())) {
+			for (int i = 0; i < runAheadFrames; i++) {
+				ahead.runFrame();
+				if (!ahead.frameEnded)
+					break;
+			}
+
+			// The emulator thread copies it out once this request is marked finished
+			aheadFrameReady.store(true, std::memory_order_relaxed);
+		}
+
+		{
+			std::lock_guard lock(aheadMutex);
+			aheadFinished.store(handled, std::memory_order_release);
+		}
+		aheadDone.notify_one();
+	}
+}
+
+std::filesystem::path NDS::bootSnapshotPath() {
+	std::string gameCode = romInfo.gameCode;
+	for (auto& c : gameCode) {
+		if (!isalnum((unsigned char)c))
+			c = '_';
+	}
+
+	u16 headerCrc = romMap[0x15E] | (romMap[0x15F] << 8);
+	return bootCacheDirectory / fmt::format("{}-{:0>4X}.ost", gameCode, headerCrc);
+}
+
+// Header, NDS9 BIOS, NDS7 BIOS, firmware
+void NDS::bootHashes(u64 hashes[4]) {
+	hashes[0] = StateHasher::hash(romMap.data(), std::min(romMap.mapped_length(), (size_t)0x180));
+	hashes[1] = StateHasher::hash(nds9->bios, 0x8000);
+	hashes[2] = StateHasher::hash(nds7->bios, 0x4000);
+	hashes[3] = StateHasher::hash(firmwareMap.data(), firmwareMap.mapped_length());
+}
+
+// Returns true if a snapshot was loaded
+bool NDS::loadBootSnapshot() {
+	std::error_code error;
+	auto path = bootSnapshotPath();
+	if (!std::filesystem::exists(path, error))
+		return false;
+
+	mio::ummap_source snapshotMap;
+	snapshotMap.map(path.c_str(), error);
+	if (error)
+		return false;
+
+	// Compare against what the snapshot was made with
+	u64 expected[4];
+	bootHashes(expected);
+
+	StateReader snapshot(snapshotMap.data(), snapshotMap.mapped_length());
+	snapshot.beginChunk("BOOT", 1);
+	u64 hashes[4];
+	snapshot.read(hashes);
+	snapshot.endChunk();
+	if (snapshot.failed() || memcmp(hashes, expected, sizeof(hashes))) {
+		shared->log << fmt::format("Boot snapshot {} is out of date\n", path.string());
+		return false;
+	}
+
+	// Same as loadStateFile(), go back to the freshly reset state if it breaks partway through
+	std::vector<u8> backup;
+	saveState(backup);
+	if (loadState(snapshotMap.data(), snapshotMap.mapped_length())) {
+		// Something's wrong with it beyond the hashes, so get rid of it. reset() boots normally and makes a new one.
+		loadState(backup.data(), backup.size());
+		snapshotMap.unmap();
+		std::filesystem::remove(path, error);
+		if (error)
+			shared->log << fmt::format("Failed to remove broken boot snapshot {} : {}\n", path.string(), error.message());
+		return false;
+	}
+
+	shared->log << fmt::format("Loaded boot snapshot {}\n", path.string());
+	return true;
+}
+
+// Called when the emulator stops while waiting for the entry points
+void NDS::captureBootSnapshot() {
+	// R[15] is ahead of the instruction that's about to run
+	auto atEntryPoint = [](auto &cpu, u32 entryPoint) { return (cpu->reg.R[15] - (cpu->reg.thumbMode ? 4 : 8)) == entryPoint; };
+
+	// The ARM7 usually gets there first
+	bool arm7Stopped = false;
+	if (!bootArm7Entered && atEntryPoint(nds7->cpu, romInfo.arm7EntryPoint)) {
+		nds7->cpu->removeBreakpoint(romInfo.arm7EntryPoint);
+		bootArm7Entered = true;
+		arm7Stopped = true;
+	}
+
+	if (!atEntryPoint(nds9->cpu, romInfo.arm9EntryPoint)) {
+		if (arm7Stopped)
+			running.store(true, std::memory_order_relaxed);
+		return; // Otherwise stopped for some other reason
+	}
+
+	nds9->cpu->removeBreakpoint(romInfo.arm9EntryPoint);
+	bootSnapshotPending = false;
+	if (!bootArm7Entered) {
+		// The ARM7 is still in the BIOS, so this isn't a clean point to start from
+		nds7->cpu->removeBreakpoint(romInfo.arm7EntryPoint);
+		shared->log << "ARM9 reached its entry point before the ARM7, not saving a boot snapshot\n";
+		running.store(true, std::memory_order_relaxed);
+		return;
+	}
+
+	u64 hashes[4];
+	bootHashes(hashes);
+	std::vector<u8> buffer;
+	StateWriter state(buffer);
+	state.beginChunk("BOOT", 1);
+	state.write(hashes);
+	state.endChunk();
+	saveState(state);
+
+	// Write to a temporary file first so nothing else ever sees half a snapshot (the batch runner has a lot of instances doing this at once)
+	std::error_code error;
+	auto path = bootSnapshotPath();
+	auto temporaryPath = path;
+	temporaryPath += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+	std::filesystem::create_directories(bootCacheDirectory, error);
+	{
+		std::ofstream file(temporaryPath, std::ios::binary);
+		file.write((const char *)buffer.data(), buffer.size());
+	}
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error) {
+		shared->log << fmt::format("Failed to save boot snapshot {} : {}\n", path.string(), error.message());
+		std::filesystem::remove(temporaryPath, error);
+	} else {
+		shared->log << fmt::format("Saved boot snapshot {}\n", path.string());
+	}
+
+	running.store(true, std::memory_order_relaxed); // Keep going
+}
+
+void NDS::hashFrame() {
+	StateHasher::FrameHash hashes;
+	auto& component = hashes.component;
+
+	component[StateHasher::PSRAM] = StateHasher::hash(shared->psram, 0x400000);
+	component[StateHasher::WRAM] = StateHasher::hash(nds7->wram, 0x10000, StateHasher::hash(shared->wram, 0x8000));
+	component[StateHasher::VRAM] = StateHasher::hash(ppu->vramAll, VRAM_SIZE);
+	component[StateHasher::OAM] = StateHasher::hash(ppu->oam, 0x800);
+	component[StateHasher::PALETTE] = StateHasher::hash(ppu->pram, 0x800);
+	component[StateHasher::TCM] = StateHasher::hash(nds9->dtcm, 0x4000, StateHasher::hash(nds9->itcm, 0x8000));
+
+	// Registers are copied out one by one since the structs they live in have padding
+	u32 arm9[20];
+	memcpy(arm9, nds9->cpu->reg.R, 16 * sizeof(u32));
+	arm9[16] = nds9->cpu->reg.CPSR;
+	arm9[17] = nds9->cpu->cp15.control;
+	arm9[18] = nds9->cpu->cp15.dtcmConfig;
+	arm9[19] = nds9->cpu->cp15.itcmConfig;
+	component[StateHasher::ARM9] = StateHasher::hash(arm9, sizeof(arm9));
+
+	u32 arm7[17];
+	memcpy(arm7, nds7->cpu->reg.R, 16 * sizeof(u32));
+	arm7[16] = nds7->cpu->reg.CPSR;
+	component[StateHasher::ARM7] = StateHasher::hash(arm7, sizeof(arm7));
+
+	u64 io[64];
+	int ioCount = 0;
+	for (u64 value : {shared->currentTime, shared->pendingEvents, (u64)shared->KEYINPUT, (u64)shared->EXTKEYIN,
+			(u64)nds9->IME, (u64)nds9->IE, (u64)nds9->IF, (u64)nds7->IME, (u64)nds7->IE, (u64)nds7->IF, (u64)nds7->HALTCNT,
+			(u64)ipc->IPCSYNC9, (u64)ipc->IPCSYNC7, (u64)ipc->IPCFIFOCNT9, (u64)ipc->IPCFIFOCNT7,
+			(u64)ppu->DISPSTAT9, (u64)ppu->DISPSTAT7, (u64)ppu->VCOUNT, (u64)ppu->engineA.DISPCNT, (u64)ppu->engineB.DISPCNT})
+		io[ioCount++] = value;
+	for (int i = 0; i < 4; i++) {
+		io[ioCount++] = ((u64)nds9->timer->timer[i].reload << 32) | (nds9->timer->timer[i].TIMCNT_L << 16) | nds9->timer->timer[i].TIMCNT_H;
+		io[ioCount++] = ((u64)nds7->timer->timer[i].reload << 32) | (nds7->timer->timer[i].TIMCNT_L << 16) | nds7->timer->timer[i].TIMCNT_H;
+		io[ioCount++] = ((u64)nds9->dma->channel[i].DMASAD << 32) | nds9->dma->channel[i].DMACNT;
+		io[ioCount++] = ((u64)nds7->dma->channel[i].DMASAD << 32) | nds7->dma->channel[i].DMACNT;
+	}
+	component[StateHasher::IO] = StateHasher::hash(io, ioCount * sizeof(u64));
+
+	if (!hasher.frame(hashes)) {
+		shared->log << hasher.divergence << "\n";
+		shared->addEvent(0, EventType::STOP);
+	}
+}
+
+// Used in place of runStep() while recording history
+void NDS::recordStep() {
+	constexpr u64 frameCycles = 263 * 4260;
+	if (history.keyframes.empty() || ((shared->currentTime - history.keyframes.back().time) >= ((u64)keyframeInterval * frameCycles))) {
+		history.budget = (size_t)timeTravelBudget << 20;
+		saveState(keyframeScratch);
+		history.addKeyframe(keyframeScratch, shared->currentTime);
+	}
+
+	runLockstep();
+}
+
+void NDS::loadKeyframe(const TimeTravel::Keyframe &keyframe) {
+	loadState(keyframe.state.data(), keyframe.state.size());
+	history.position = keyframe.position;
+	history.nextInput = std::lower_bound(history.inputs.begin(), history.inputs.end(), keyframe.position.ticks, [](auto &input, u64 ticks) { return input.ticks < ticks; }) - history.inputs.begin();
+
+	// Nothing that happens during a replay is new, so it shouldn't be heard or hashed again
+	speculative = true;
+	nds7->apu->discardOutput = true;
+	stepArm9.store(false, std::memory_order_relaxed);
+	stepArm7.store(false, std::memory_order_relaxed);
+}
+
+// Runs one tick of a replay with the inputs that were logged for it. Returns true if a breakpoint or something else
+// stopped the emulator during the original run.
+bool NDS::replayTick() {
+	while ((history.nextInput < history.inputs.size()) && (history.inputs[history.nextInput].ticks == history.position.ticks)) {
+		auto& input = history.inputs[history.nextInput++];
+		setKeys(input.keys);
+		setTouch(input.touchX, input.touchY);
+	}
+
+	running.store(true, std::memory_order_relaxed);
+	runLockstep();
+	return !running.load(std::memory_order_relaxed);
+}
+
+void NDS::seekTick(u64 ticks) {
+	auto keyframe = std::find_if(history.keyframes.rbegin(), history.keyframes.rend(), [&](auto &k) { return k.position.ticks <= ticks; });
+	if (keyframe == history.keyframes.rend())
+		return;
+
+	loadKeyframe(*keyframe);
+	while (history.position.ticks < ticks)
+		replayTick();
+	endReplay();
+}
+
+// Goes back to right after the CPU's previous instruction, which is where stepping forward would have stopped
+bool NDS::reverseStep(bool arm9) {
+	auto instructions = [arm9](const TimeTravel::Position &position) { return arm9 ? position.instructions9 : position.instructions7; };
+	if (history.keyframes.empty() || (instructions(history.position) == 0))
+		return false;
+
+	// The target is the first tick with this count, so the keyframe has to be from before the count got there
+	u64 current = history.position.ticks;
+	u64 target = instructions(history.position) - 1;
+	auto keyframe = std::find_if(history.keyframes.rbegin(), history.keyframes.rend(), [&](auto &k) { return instructions(k.position) < target; });
+	if (keyframe == history.keyframes.rend()) {
+		if (instructions(history.keyframes.front().position) > target) {
+			shared->log << "Reverse step : Not enough history\n";
+			return false;
+		}
+		keyframe = std::prev(history.keyframes.rend());
+	}
+
+	loadKeyframe(*keyframe);
+	while ((instructions(history.position) < target) && (history.position.ticks < current))
+		replayTick();
+	endReplay();
+	return true;
+}
+
+// Goes back to the last time something stopped the emulator, usually a breakpoint.
+// Each keyframe interval is replayed from newest to oldest until one has a stop in it.
+bool NDS::reverseContinue() {
+	if (history.keyframes.empty())
+		return false;
+
+	u64 current = history.position.ticks;
+	u64 intervalEnd = current;
+	for (auto keyframe = history.keyframes.rbegin(); keyframe != history.keyframes.rend(); keyframe++) {
+		if (keyframe->position.ticks >= current)
+			continue;
+
+		u64 lastStop = UINT64_MAX;
+		loadKeyframe(*keyframe);
+		while (history.position.ticks < intervalEnd) {
+			if (replayTick() && (history.position.ticks != current))
+				lastStop = history.position.ticks;
+		}
+
+		if (lastStop != UINT64_MAX) {
+			seekTick(lastStop);
+			return true;
+		}
+		intervalEnd = keyframe->position.ticks;
+	}
+
+	// Nothing stopped it, so go as far back as possible
+	loadKeyframe(history.keyframes.front());
+	endReplay();
+	shared->log << "Reverse continue : Reached the start of the history\n";
+	return false;
+}
+
+void NDS::endReplay() {
+	nds7->apu->discardOutput = false;
+	speculative = false;
+	running.store(false, std::memory_order_release);
+	history.truncate();
+
+	if (runAheadFrames > 0) {
+		memcpy(runAheadFramebuffer[0], ppu->framebufferA, sizeof(ppu->framebufferA));
+		memcpy(runAheadFramebuffer[1], ppu->framebufferB, sizeof(ppu->framebufferB));
+	}
+	ppu->updateScreen = true;
+}
+
+// Main loop for the emulator thread
 void NDS::run() {
-	u64 nds9timestamp = 0;
-	u64 nds7timestamp = 0;
 	while (true) {
-		while (running && nds7->apu->soundRunning) { [[likely]]
-			//if (nds9->cpu->reg.R[15] == 0x2000808) traceArm9 = true;
-			if (nds9timestamp <= shared->currentTime) {
-				if (traceArm9) {
-					if (nds9->cpu->reg.thumbMode) {
-						std::string disasm = disassembler9.disassemble(nds9->cpu->reg.R[15] - 4, nds9->cpu->pipelineOpcode3, true);
-						shared->log << fmt::format("0x{:0>7X} |     0x{:0>4X} | {}\n", nds9->cpu->reg.R[15] - 4, nds9->cpu->pipelineOpcode3, disasm);
-					} else {
-						std::string disasm = disassembler9.disassemble(nds9->cpu->reg.R[15] - 8, nds9->cpu->pipelineOpcode3, false);
-						shared->log << fmt::format("0x{:0>7X} | 0x{:0>8X} | {}\n", nds9->cpu->reg.R[15] - 8, nds9->cpu->pipelineOpcode3, disasm);
-					}
-				}
-
-				nds9->delay = 0;
-				nds9->cpu->cycle();
-				nds9->delay = 1;
-				nds9timestamp = shared->currentTime + nds9->delay;
-
-				if (stepArm9 && !nds9->cpu->cp15.halted) [[unlikely]]
-					running = stepArm9 = false;
+		while (running.load(std::memory_order_relaxed)) { [[likely]]
+			if (rewinding.load(std::memory_order_relaxed)) [[unlikely]] {
+				stepBack();
+				pacer.frame();
+				handleThreadQueue();
+				continue;
 			}
-			if ((nds7timestamp <= shared->currentTime) && !nds7->HALTCNT) {
-				if (traceArm7) {
-					if (nds7->cpu->reg.thumbMode) {
-						std::string disasm = disassembler7.disassemble(nds7->cpu->reg.R[15] - 4, nds7->cpu->pipelineOpcode3, true);
-						shared->log << fmt::format("0x{:0>7X} |     0x{:0>4X} | {}\n", nds7->cpu->reg.R[15] - 4, nds7->cpu->pipelineOpcode3, disasm);
-					} else {
-						std::string disasm = disassembler7.disassemble(nds7->cpu->reg.R[15] - 8, nds7->cpu->pipelineOpcode3, false);
-						shared->log << fmt::format("0x{:0>7X} | 0x{:0>8X} | {}\n", nds7->cpu->reg.R[15] - 8, nds7->cpu->pipelineOpcode3, disasm);
-					}
-				}
-
-				nds7->delay = 0;
-				nds7->cpu->cycle();
-				nds7timestamp = shared->currentTime + nds7->delay;
-
-				if (stepArm7) [[unlikely]]
-					running = stepArm7 = false;
+
+			ppu->hideFrames = runAheadFrames > 0;
+			runFrame();
+
+			if (frameEnded) {
+				if (Instrumentation::debugger && !timeTravelEnabled && !history.keyframes.empty()) // Turned off, and anything recorded now would have a gap in it
+					history.clear();
+				captureRewind();
+
+				// Keys pressed during the frame have to be in before running ahead, or the predicted frames won't have them
+				handleThreadQueue();
+				if ((runAheadFrames > 0) && running.load(std::memory_order_relaxed))
+					runAhead();
+				pacer.frame();
+				nds7->apu->sampleDecimation = pacer.audioDecimation();
+
+				handleThreadQueue();
 			}
+		}
 
-			while (shared->eventQueue.top().timeStamp <= shared->currentTime) {
-				auto type = shared->eventQueue.top().type;
-				shared->eventQueue.pop();
+		// Nothing can happen until the GUI asks for something, so sleep until then
+		threadQueue.wait();
+		handleThreadQueue();
+	}
+}
 
-				switch (type) {
-				default:
-					shared->log << "Invalid event " << shared->eventQueue.top().type;
-				case EventType::STOP:
-					running = false;
-					break;
-				case IPC_SYNC9: nds9->requestInterrupt(BusARM9::INT_IPC_SYNC); break;
-				case IPC_SYNC7: nds7->requestInterrupt(BusARM7::INT_IPC_SYNC); break;
-				case IPC_SEND_FIFO9: nds9->requestInterrupt(BusARM9::INT_IPC_SEND_FIFO); break;
-				case IPC_SEND_FIFO7: nds7->requestInterrupt(BusARM7::INT_IPC_SEND_FIFO); break;
-				case IPC_RECV_FIFO9: nds9->requestInterrupt(BusARM9::INT_IPC_RECV_FIFO); break;
-				case IPC_RECV_FIFO7: nds7->requestInterrupt(BusARM7::INT_IPC_RECV_FIFO); break;
-				case PPU_LINE_START:
-					ppu->lineStart();
-
-					if (ppu->vBlankIrq9) { nds9->requestInterrupt(BusARM9::INT_VBLANK); ppu->vBlankIrq9 = false; }
-					if (ppu->vBlankIrq7) { nds7->requestInterrupt(BusARM7::INT_VBLANK); ppu->vBlankIrq7 = false; }
-					if (ppu->vCounterIrq9) { nds9->requestInterrupt(BusARM9::INT_VCOUNT); ppu->vCounterIrq9 = false; }
-					if (ppu->vCounterIrq7) { nds7->requestInterrupt(BusARM7::INT_VCOUNT); ppu->vCounterIrq7 = false; }
-
-					if (ppu->currentScanline == 192) {
-						nds9->dma->checkDma(DMA<true>::DmaStart::DMA_VBLANK);
-						nds7->dma->checkDma(DMA<false>::DmaStart::DMA_VBLANK);
-					}
-
-					if (ppu->currentScanline == 0)
-						handleThreadQueue();
-					break;
-				case PPU_HBLANK:
-					ppu->hBlank();
+// Runs until the start of the next frame. Returns early if a breakpoint, step, or STOP event stops the emulator.
+void NDS::runFrame() {
+	running.store(true, std::memory_order_relaxed);
+	frameEnded = false;
 
-					if (ppu->hBlankIrq9) { nds9->requestInterrupt(BusARM9::INT_HBLANK); ppu->hBlankIrq9 = false; }
-					if (ppu->hBlankIrq7) { nds7->requestInterrupt(BusARM7::INT_HBLANK); ppu->hBlankIrq7 = false; }
+	while (!frameEnded && running.load(std::memory_order_relaxed)) {
+		runStep();
 
-					if (ppu->currentScanline < 192)
-						nds9->dma->checkDma(DMA<true>::DmaStart::DMA_HBLANK);
-					break;
-				case REFRESH_WRAM_PAGES:
-					nds9->refreshWramPages();
-					nds7->refreshWramPages();
-					break;
-				case REFRESH_VRAM_PAGES:
-					ppu->refreshVramPages();
-					nds9->refreshVramPages();
-					nds7->refreshVramPages();
-					break;
-				case REFRESH_ROM_PAGES:
-					nds9->refreshRomPages();
-					nds7->refreshRomPages();
-					break;
-				case SPI_FINISHED: nds7->requestInterrupt(BusARM7::INT_SPI); break;
-				case RTC_REFRESH: nds7->rtc->refresh<true>(); break;
-				case SERIAL_INTERRUPT: nds7->requestInterrupt(BusARM7::INT_SERIAL); break;
-				case TIMER_OVERFLOW_9:
-					nds9->timer->checkOverflow();
-					if (nds9->timer->timer[0].interruptRequested) { nds9->timer->timer[0].interruptRequested = false; nds9->requestInterrupt(BusARM9::INT_TIMER_0); }
-					if (nds9->timer->timer[1].interruptRequested) { nds9->timer->timer[1].interruptRequested = false; nds9->requestInterrupt(BusARM9::INT_TIMER_1); }
-					if (nds9->timer->timer[2].interruptRequested) { nds9->timer->timer[2].interruptRequested = false; nds9->requestInterrupt(BusARM9::INT_TIMER_2); }
-					if (nds9->timer->timer[3].interruptRequested) { nds9->timer->timer[3].interruptRequested = false; nds9->requestInterrupt(BusARM9::INT_TIMER_3); }
-					break;
-				case TIMER_OVERFLOW_7:
-					nds7->timer->checkOverflow();
-					if (nds7->timer->timer[0].interruptRequested) { nds7->timer->timer[0].interruptRequested = false; nds7->requestInterrupt(BusARM7::INT_TIMER_0); }
-					if (nds7->timer->timer[1].interruptRequested) { nds7->timer->timer[1].interruptRequested = false; nds7->requestInterrupt(BusARM7::INT_TIMER_1); }
-					if (nds7->timer->timer[2].interruptRequested) { nds7->timer->timer[2].interruptRequested = false; nds7->requestInterrupt(BusARM7::INT_TIMER_2); }
-					if (nds7->timer->timer[3].interruptRequested) { nds7->timer->timer[3].interruptRequested = false; nds7->requestInterrupt(BusARM7::INT_TIMER_3); }
-					break;
-				case GAMECARD_TRANSFER_READY:
-					if (shared->ndsSlotAccess) {
-						nds7->dma->checkDma(DMA<false>::DmaStart::DMA_DS_SLOT);
-					} else {
-						nds9->dma->checkDma(DMA<true>::DmaStart::DMA_DS_SLOT);
-					}
-					break;
-				case GAMECARD_COMMAND_COMPLETE:
-					if (shared->ndsSlotAccess) {
-						nds7->requestInterrupt(BusARM7::INT_NDS_SLOT_DATA);
-					} else {
-						nds9->requestInterrupt(BusARM9::INT_NDS_SLOT_DATA);
-					}
-					//nds7->requestInterrupt(BusARM7::INT_NDS_SLOT_DATA);
-					//nds9->requestInterrupt(BusARM9::INT_NDS_SLOT_DATA);
-					break;
-				case APU_SAMPLE:
-					nds7->apu->doSample();
-					break;
-				}
+		if (bootSnapshotPending && !running.load(std::memory_order_relaxed)) [[unlikely]]
+			captureBootSnapshot();
+	}
+}
+
+// Runs for at least the given number of cycles (at 67MHz). Returns early if the emulator is stopped.
+void NDS::runCycles(u64 cycles) {
+	running.store(true, std::memory_order_relaxed);
+	cycleLimit = shared->currentTime + cycles;
+
+	while ((shared->currentTime < cycleLimit) && running.load(std::memory_order_relaxed))
+		runStep();
+
+	cycleLimit = UINT64_MAX;
+}
+
+void NDS::runStep() {
+	if constexpr (Instrumentation::debugger) {
+		if (timeTravelEnabled && !speculative) [[unlikely]] {
+			recordStep();
+			return;
+		}
+
+		// Tracing and stepping need to see every instruction, so they always use the slow path
+		if (traceArm9 || traceArm7 || stepArm9.load(std::memory_order_relaxed) || stepArm7.load(std::memory_order_relaxed)) [[unlikely]] {
+			runLockstep();
+			return;
+		}
+	}
+
+	if (syncQuantum > 0) { [[likely]]
+		runSlice();
+	} else {
+		runLockstep();
+	}
+}
+
+const u16 *NDS::getFramebuffer(int engine) {
+	if (runAheadFrames > 0)
+		return &runAheadFramebuffer[engine][0][0];
+	return engine ? &ppu->framebufferB[0][0] : &ppu->framebufferA[0][0];
+}
+
+// Copies out the oldest finished block of stereo samples. Returns the number of sample pairs copied, or 0 if nothing new is ready.
+// Only one thread (the audio callback) can pull.
+int NDS::pullAudio(i16 *buffer, int maxSamples) {
+	APU::SampleBlock block;
+	if (!nds7->apu->outputBlocks.pop(block))
+		return 0;
+
+	int count = std::min(maxSamples, SAMPLE_BUFFER_SIZE);
+	memcpy(buffer, block.data(), count * 2 * sizeof(i16));
+	return count;
+}
+
+// Same bit layout as UPDATE_KEYS: bits 0-9 are KEYINPUT, 10-11 are X/Y, and 16 is the pen
+void NDS::setKeys(u32 keys) {
+	shared->KEYINPUT = ~keys & 0x03FF;
+	shared->EXTKEYIN = ((~keys >> 10) & 0x0043) | 0x003C;
+
+	// Either CPU might be sitting in a loop polling the keys
+	BusShared::requestWake(shared->wakeArm9);
+	BusShared::requestWake(shared->wakeArm7);
+}
+
+void NDS::setTouch(u8 x, u8 y) {
+	nds7->spi->touchscreen.xPosition = x << 4;
+	nds7->spi->touchscreen.yPosition = y << 4;
+}
+
+int NDS::setFastmem(bool enable) {
+	if (!enable) {
+		nds9->fastmem.disable();
+		nds7->fastmem.disable();
+		return 0;
+	}
+
+	int error = nds9->fastmem.enable(shared->memory);
+	if (!error)
+		error = nds7->fastmem.enable(shared->memory);
+	if (error) {
+		nds9->fastmem.disable();
+		nds7->fastmem.disable();
+		shared->log << fmt::format("Failed to enable fastmem : {}\n", std::error_code(error, std::generic_category()).message());
+		return error;
+	}
+
+	nds9->fastmem.remap(nds9->readTable, nds9->writeTable);
+	nds7->fastmem.remap(nds7->readTable, nds7->writeTable);
+	return 0;
+}
+
+// Runs each CPU for as many instructions as it can before the next event or sync point.
+// The ARM7 can end up behind the ARM9 by up to syncQuantum cycles, but both CPUs always stop at events.
+// On the ARM7 thread, one CPU can already be past an event the other one schedules, and only stops once it sees it.
+// That CPU sees the event's effects late, by at most the length of the slice (see threadedArm7 in nds.hpp).
+void NDS::runSlice() {
+	// The other CPU might have written whatever a polling loop is waiting on.
+	// A CPU that isn't asleep yet keeps its matches, or one that writes PSRAM all the time would keep it from ever sleeping.
+	if (shared->wakeArm9.load(std::memory_order_relaxed)) {
+		shared->wakeArm9.store(false, std::memory_order_relaxed);
+		if (nds9->idleLoop.idle)
+			nds9->idleLoop.wake();
+	}
+	if (shared->wakeArm7.load(std::memory_order_relaxed)) {
+		shared->wakeArm7.store(false, std::memory_order_relaxed);
+		if (nds7->idleLoop.idle)
+			nds7->idleLoop.wake();
+	}
+
+	bool halted9 = (nds9->cpu->cp15.halted && !nds9->cpu->processIrq) || nds9->idleLoop.idle;
+	bool halted7 = (nds7->HALTCNT != 0) || nds7->idleLoop.idle;
+	u64 sliceEnd = shared->nextEventTime;
+	if (!halted9 || !halted7)
+		sliceEnd = std::min(sliceEnd, shared->currentTime + syncQuantum);
+	sliceEnd = std::min(sliceEnd, cycleLimit);
+
+	if (threadedArm7 && !arm7Thread.joinable() && !arm7ThreadUnavailable.load(std::memory_order_relaxed)) [[unlikely]]
+		startArm7Thread();
+
+	// With the ARM7 on its own thread, how the CPUs interleave depends on the host, so hashes would never match.
+	// Slices that are too short to make up for the handoff stay on this thread.
+	bool parallel = threadedArm7 && arm7Thread.joinable() && !halted7 && !hasher.active() && (sliceEnd > nds7timestamp) && ((sliceEnd - nds7timestamp) >= parallelMinSlice.load(std::memory_order_relaxed));
+	bool timed = threadedArm7 && ((++arm7TimedSlices & 63) == 0); // Only every so often, since reading the clock isn't free
+
+	if (parallel) {
+		// Neither thread can run the scheduler, so events added during the slice just end it early for both CPUs.
+		// A WRAMCNT write, an IPC IRQ, etc. gets handled here before either CPU can run past it on stale state.
+		shared->sliceEnd.store(sliceEnd, std::memory_order_relaxed);
+		shared->parallelSlice = true;
+		requestArm7Slice();
+
+		if (!halted9)
+			runArm9<true>(sliceEnd);
+
+		waitForArm7();
+		shared->parallelSlice = false;
+		sliceEnd = shared->sliceEnd.load(std::memory_order_relaxed);
+		shared->log.merge();
+	} else {
+		// Anything scheduled by a CPU (IPC, breakpoints, etc.) shortens the slice
+		if (!halted9)
+			runArm9<false>(sliceEnd);
+		if (!halted7) {
+			if (timed) [[unlikely]] {
+				auto start = std::chrono::steady_clock::now();
+				u64 before = nds7timestamp;
+				runArm7<false>(sliceEnd);
+				timeArm7(nds7timestamp - before, start);
+			} else {
+				runArm7<false>(sliceEnd);
 			}
+		}
 
-			shared->currentTime += std::min((u64)std::min((nds7->HALTCNT == 0x80) ? LLONG_MAX : nds7->delay, (nds9->cpu->cp15.halted && !nds9->cpu->processIrq) ? LLONG_MAX : nds9->delay), shared->eventQueue.top().timeStamp - shared->currentTime);
+		sliceEnd = std::min(sliceEnd, shared->nextEventTime);
+	}
+
+	shared->currentTime = sliceEnd;
+
+	// A halted CPU doesn't need to catch up on the time it spent sleeping
+	if (nds9->idleLoop.idle && (nds9timestamp < sliceEnd))
+		idleCyclesSkipped += sliceEnd - nds9timestamp;
+	if (nds7->idleLoop.idle && (nds7timestamp < sliceEnd))
+		idleCyclesSkipped += sliceEnd - nds7timestamp;
+	if ((nds9->cpu->cp15.halted && !nds9->cpu->processIrq) || nds9->idleLoop.idle)
+		nds9timestamp = std::max(nds9timestamp, sliceEnd);
+	if (nds7->HALTCNT || nds7->idleLoop.idle)
+		nds7timestamp = std::max(nds7timestamp, sliceEnd);
+
+	handleEvents();
+}
+
+// The scheduler can only be read from one thread at a time, so parallel slices go by shared->sliceEnd instead.
+// Adding an event pulls it in for both threads.
+template <bool parallel>
+void NDS::runArm9(u64 sliceEnd) {
+	while (nds9timestamp < (parallel ? shared->sliceEnd.load(std::memory_order_relaxed) : std::min(sliceEnd, shared->nextEventTime))) {
+		shared->currentTime = nds9timestamp;
+
+		// Sleep until the next event if the CPU is just polling something
+		if (idleLoopDetection && nds9->idleLoop.enabled && nds9->idleLoop.instruction(nds9->cpu->reg.R[15], nds9->cpu->reg.R, nds9->cpu->reg.CPSR)) [[unlikely]]
+			break;
+
+		nds9->delay = 0;
+		nds9->cpu->cycle();
+		nds9->delay = 1;
+		nds9timestamp = shared->currentTime + nds9->delay;
+
+		if (nds9->cpu->cp15.halted) [[unlikely]]
+			break;
+	}
+}
+
+template <bool parallel>
+void NDS::runArm7(u64 sliceEnd) {
+	while (nds7timestamp < (parallel ? shared->sliceEnd.load(std::memory_order_relaxed) : std::min(sliceEnd, shared->nextEventTime))) {
+		shared->time() = nds7timestamp;
+
+		if (idleLoopDetection && nds7->idleLoop.enabled && nds7->idleLoop.instruction(nds7->cpu->reg.R[15], nds7->cpu->reg.R, nds7->cpu->reg.CPSR)) [[unlikely]]
+			break;
+
+		nds7->delay = 0;
+		nds7->cpu->cycle();
+		nds7timestamp = shared->time() + nds7->delay;
+
+		if (nds7->HALTCNT) [[unlikely]]
+			break;
+	}
+}
+
+// Tells the CPU this is a spin loop, so it goes easy on the other hyperthread and the memory bus
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+	_mm_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+// How many times each side checks before blocking. A parallel slice is usually over well within this, and blocking
+// costs a few microseconds on both ends, so it's only worth it when the other thread isn't coming back soon.
+static constexpr int SPIN_LIMIT = 2000;
+
+// Starts the ARM7 thread and measures how long a handoff takes with nothing to run
+void NDS::startArm7Thread() {
+	// With one host CPU the threads would only take turns, and spinning would waste the other one's time
+	if (std::thread::hardware_concurrency() < 2) {
+		shared->log << "Only one host CPU, so the ARM7 is staying on the emulator thread\n";
+		arm7ThreadUnavailable = true;
+		return;
+	}
+
+	arm7ThreadExit = false;
+	arm7Thread = std::thread(&NDS::arm7ThreadLoop, this);
+
+	// The ARM7 is already past a slice that ends at 0, so these come straight back
+	constexpr int warmup = 16;
+	constexpr int samples = 256;
+	shared->sliceEnd.store(0, std::memory_order_relaxed);
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < (warmup + samples); i++) {
+		if (i == warmup)
+			start = std::chrono::steady_clock::now();
+		requestArm7Slice();
+		waitForArm7();
+	}
+	handoffTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / samples;
+
+	// Nothing runs in parallel until the ARM7 has been timed
+	arm7CycleTime = 0;
+	parallelMinSlice = UINT64_MAX;
+}
+
+// Keeps a running average of how long an ARM7 cycle takes, and the break-even slice length that goes with it.
+// Called from whichever thread just ran the ARM7.
+void NDS::timeArm7(u64 cycles, std::chrono::steady_clock::time_point start) {
+	if (cycles == 0)
+		return;
+
+	double cycleTime = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / cycles;
+	arm7CycleTime = (arm7CycleTime == 0) ? cycleTime : (((arm7CycleTime * 15) + cycleTime) / 16);
+	parallelMinSlice.store((u64)(handoffTime / arm7CycleTime), std::memory_order_relaxed);
+}
+
+// Only pays for a wakeup if the ARM7 thread already gave up spinning.
+// Both sides store their own flag and then load the other's with seq_cst, so at least one of them sees the other.
+void NDS::requestArm7Slice() {
+	arm7SliceRequested.fetch_add(1, std::memory_order_seq_cst);
+	if (arm7Sleeping.load(std::memory_order_seq_cst))
+		arm7SliceRequested.notify_one();
+}
+
+void NDS::waitForArm7() {
+	u64 requested = arm7SliceRequested.load(std::memory_order_relaxed);
+	for (int i = 0; (i < SPIN_LIMIT) && (arm7SliceFinished.load(std::memory_order_acquire) != requested); i++)
+		cpuRelax();
+
+	u64 finished = arm7SliceFinished.load(std::memory_order_acquire);
+	if (finished != requested) {
+		arm9Sleeping.store(true, std::memory_order_seq_cst);
+		while ((finished = arm7SliceFinished.load(std::memory_order_seq_cst)) != requested)
+			arm7SliceFinished.wait(finished, std::memory_order_seq_cst);
+		arm9Sleeping.store(false, std::memory_order_relaxed);
+	}
+}
+
+// Waits for runSlice() to hand over a slice, then runs the ARM7 through it
+void NDS::arm7ThreadLoop() {
+	BusShared::onArm7Thread = true;
+
+	u64 slice = arm7SliceFinished.load(std::memory_order_relaxed);
+	while (true) {
+		for (int i = 0; (i < SPIN_LIMIT) && (arm7SliceRequested.load(std::memory_order_acquire) == slice); i++)
+			cpuRelax();
+		if (arm7SliceRequested.load(std::memory_order_acquire) == slice) {
+			arm7Sleeping.store(true, std::memory_order_seq_cst);
+			arm7SliceRequested.wait(slice, std::memory_order_seq_cst);
+			arm7Sleeping.store(false, std::memory_order_relaxed);
 		}
+		if (arm7ThreadExit)
+			return;
 
-		handleThreadQueue();
+		++slice;
+		if ((arm7TimedSlices & 63) == 0) [[unlikely]] {
+			auto start = std::chrono::steady_clock::now();
+			u64 before = nds7timestamp;
+			runArm7<true>(shared->sliceEnd.load(std::memory_order_relaxed));
+			timeArm7(nds7timestamp - before, start);
+		} else {
+			runArm7<true>(shared->sliceEnd.load(std::memory_order_relaxed));
+		}
+
+		arm7SliceFinished.store(slice, std::memory_order_seq_cst);
+		if (arm9Sleeping.load(std::memory_order_seq_cst))
+			arm7SliceFinished.notify_one();
+	}
+}
+
+// Interleaves the CPUs one instruction at a time. Used for tracing, stepping, and when syncQuantum is 0.
+void NDS::runLockstep() {
+	if (nds9timestamp <= shared->currentTime) {
+		if (Instrumentation::debugger && traceArm9 && !speculative) {
+			if (nds9->cpu->reg.thumbMode) {
+				std::string disasm = disassembler9.disassemble(nds9->cpu->reg.R[15] - 4, nds9->cpu->pipelineOpcode3, true);
+				shared->log << fmt::format("0x{:0>7X} |     0x{:0>4X} | {}\n", nds9->cpu->reg.R[15] - 4, nds9->cpu->pipelineOpcode3, disasm);
+			} else {
+				std::string disasm = disassembler9.disassemble(nds9->cpu->reg.R[15] - 8, nds9->cpu->pipelineOpcode3, false);
+				shared->log << fmt::format("0x{:0>7X} | 0x{:0>8X} | {}\n", nds9->cpu->reg.R[15] - 8, nds9->cpu->pipelineOpcode3, disasm);
+			}
+		}
+
+		nds9->delay = 0;
+		nds9->cpu->cycle();
+		nds9->delay = 1;
+		nds9timestamp = shared->currentTime + nds9->delay;
+
+		if (!nds9->cpu->cp15.halted) {
+			++history.position.instructions9;
+
+			if (Instrumentation::debugger && stepArm9.load(std::memory_order_relaxed)) [[unlikely]] {
+				stepArm9.store(false, std::memory_order_relaxed);
+				running.store(false, std::memory_order_release);
+			}
+		}
+	}
+	if ((nds7timestamp <= shared->currentTime) && !nds7->HALTCNT) {
+		if (Instrumentation::debugger && traceArm7 && !speculative) {
+			if (nds7->cpu->reg.thumbMode) {
+				std::string disasm = disassembler7.disassemble(nds7->cpu->reg.R[15] - 4, nds7->cpu->pipelineOpcode3, true);
+				shared->log << fmt::format("0x{:0>7X} |     0x{:0>4X} | {}\n", nds7->cpu->reg.R[15] - 4, nds7->cpu->pipelineOpcode3, disasm);
+			} else {
+				std::string disasm = disassembler7.disassemble(nds7->cpu->reg.R[15] - 8, nds7->cpu->pipelineOpcode3, false);
+				shared->log << fmt::format("0x{:0>7X} | 0x{:0>8X} | {}\n", nds7->cpu->reg.R[15] - 8, nds7->cpu->pipelineOpcode3, disasm);
+			}
+		}
+
+		nds7->delay = 0;
+		nds7->cpu->cycle();
+		nds7timestamp = shared->currentTime + nds7->delay;
+		++history.position.instructions7;
+
+		if (Instrumentation::debugger && stepArm7.load(std::memory_order_relaxed)) [[unlikely]] {
+			stepArm7.store(false, std::memory_order_relaxed);
+			running.store(false, std::memory_order_release);
+		}
+	}
+
+	handleEvents();
+	++history.position.ticks;
+
+	shared->currentTime += std::min((u64)std::min((nds7->HALTCNT == 0x80) ? LLONG_MAX : nds7->delay, (nds9->cpu->cp15.halted && !nds9->cpu->processIrq) ? LLONG_MAX : nds9->delay), shared->nextEventTime - shared->currentTime);
+}
+
+void NDS::handleEvents() {
+	while (shared->nextEventTime <= shared->currentTime) {
+		auto type = shared->popEvent();
+
+		// Any event can change what a polling loop is waiting on
+		nds9->idleLoop.wake();
+		nds7->idleLoop.wake();
+
+		shared->dispatchEvent(type);
+	}
+}
+
+void NDS::lineStartEvent() {
+	ppu->lineStart();
+
+	if (ppu->vBlankIrq9) { nds9->requestInterrupt(BusARM9::INT_VBLANK); ppu->vBlankIrq9 = false; }
+	if (ppu->vBlankIrq7) { nds7->requestInterrupt(BusARM7::INT_VBLANK); ppu->vBlankIrq7 = false; }
+	if (ppu->vCounterIrq9) { nds9->requestInterrupt(BusARM9::INT_VCOUNT); ppu->vCounterIrq9 = false; }
+	if (ppu->vCounterIrq7) { nds7->requestInterrupt(BusARM7::INT_VCOUNT); ppu->vCounterIrq7 = false; }
+
+	if (ppu->currentScanline == 192) {
+		if (hasher.active() && !speculative) [[unlikely]]
+			hashFrame();
+
+		nds9->dma->checkDma(DMA<true>::DmaStart::DMA_VBLANK);
+		nds7->dma->checkDma(DMA<false>::DmaStart::DMA_VBLANK);
+	}
+
+	if (ppu->currentScanline == 0)
+		frameEnded = true;
+}
+
+void NDS::hBlankEvent() {
+	ppu->hBlank();
+
+	if (ppu->hBlankIrq9) { nds9->requestInterrupt(BusARM9::INT_HBLANK); ppu->hBlankIrq9 = false; }
+	if (ppu->hBlankIrq7) { nds7->requestInterrupt(BusARM7::INT_HBLANK); ppu->hBlankIrq7 = false; }
+
+	if (ppu->currentScanline < 192)
+		nds9->dma->checkDma(DMA<true>::DmaStart::DMA_HBLANK);
+}
+
+void NDS::refreshPagesEvent() {
+	u8 pages = shared->dirtyPages;
+	shared->dirtyPages = 0;
+
+	if (pages & BusShared::PAGES_WRAM) {
+		nds9->refreshWramPages();
+		nds7->refreshWramPages();
+	}
+	if (pages & BusShared::PAGES_VRAM) {
+		ppu->refreshVramPages();
+		nds9->refreshVramPages();
+		nds7->refreshVramPages();
+	}
+	if (pages & BusShared::PAGES_ROM) {
+		nds9->refreshRomPages();
+		nds7->refreshRomPages();
+	}
+}
+
+// The gamecard can be owned by either CPU
+void NDS::gamecardEvent(EventType type) {
+	if (type == GAMECARD_TRANSFER_READY) {
+		if (shared->ndsSlotAccess) {
+			nds7->dma->checkDma(DMA<false>::DmaStart::DMA_DS_SLOT);
+		} else {
+			nds9->dma->checkDma(DMA<true>::DmaStart::DMA_DS_SLOT);
+		}
+	} else {
+		if (shared->ndsSlotAccess) {
+			nds7->requestInterrupt(BusARM7::INT_NDS_SLOT_DATA);
+		} else {
+			nds9->requestInterrupt(BusARM9::INT_NDS_SLOT_DATA);
+		}
 	}
 }
 
 // Thread-safe queue
 void NDS::handleThreadQueue() {
-	threadQueueMutex.lock();
-	while (!threadQueue.empty()) {
-		threadEvent currentEvent = threadQueue.front();
-		threadQueue.pop();
+	if (threadQueue.empty()) [[likely]]
+		return;
 
+	threadEvent currentEvent;
+	while (threadQueue.pop(currentEvent)) {
 		switch (currentEvent.type) {
 		case START:
 			if (romInfo.romLoaded && romInfo.bios9Loaded && romInfo.bios7Loaded && romInfo.firmwareLoaded) {
-				running = true;
+				running.store(true, std::memory_order_release);
+				pacer.reset();
+
+				resumeLatency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - currentEvent.queuedTime).count();
 			} else {
-				threadQueue = {};
+				threadQueue.clear();
 			}
 			break;
 		case STOP:
-			running = false;
+			running.store(false, std::memory_order_release);
 			break;
 		case RESET:
 			reset();
 			break;
 		case STEP_ARM9:
-			running = true;
-			stepArm9 = true;
+			if constexpr (!Instrumentation::debugger) // Would just keep running
+				break;
+			stepArm9.store(true, std::memory_order_relaxed);
+			running.store(true, std::memory_order_release);
 			//shared->addEvent(nds9->delay - 1, EventType::STOP);
 			break;
 		case STEP_ARM7:
-			running = true;
-			stepArm7 = true;
+			if constexpr (!Instrumentation::debugger) // Would just keep running
+				break;
+			stepArm7.store(true, std::memory_order_relaxed);
+			running.store(true, std::memory_order_release);
 			//shared->addEvent(nds7->delay - 1, EventType::STOP);
 			break;
 		case LOAD_ROM:
-			if (loadRom(*(std::filesystem::path *)currentEvent.ptrArg)) {
-				threadQueue = {};
+			if (loadRom(std::get<std::filesystem::path>(currentEvent.arg))) {
+				threadQueue.clear();
 			} else {
 				romInfo.romLoaded = true;
 			}
 			break;
 		case LOAD_BIOS9:
-			if (loadBios9(*(std::filesystem::path *)currentEvent.ptrArg)) {
-				threadQueue = {};
+			if (loadBios9(std::get<std::filesystem::path>(currentEvent.arg))) {
+				threadQueue.clear();
 			} else {
 				romInfo.bios9Loaded = true;
 			}
 			break;
 		case LOAD_BIOS7:
-			if (loadBios7(*(std::filesystem::path *)currentEvent.ptrArg)) {
-				threadQueue = {};
+			if (loadBios7(std::get<std::filesystem::path>(currentEvent.arg))) {
+				threadQueue.clear();
 			} else {
 				romInfo.bios7Loaded = true;
 			}
 			break;
 		case LOAD_FIRMWARE:
-			if (loadFirmware(*(std::filesystem::path *)currentEvent.ptrArg)) {
-				threadQueue = {};
+			if (loadFirmware(std::get<std::filesystem::path>(currentEvent.arg))) {
+				threadQueue.clear();
 			} else {
 				romInfo.firmwareLoaded = true;
 			}
@@ -313,32 +1286,70 @@ void NDS::handleThreadQueue() {
 		case CLEAR_LOG:
 			shared->log.str("");
 			break;
-		case UPDATE_KEYS:
-			shared->KEYINPUT = ~currentEvent.intArg & 0x03FF;
-			shared->EXTKEYIN = ((~currentEvent.intArg >> 10) & 0x0043) | 0x003C;
+		case UPDATE_KEYS: {
+			auto& keyState = std::get<KeyState>(currentEvent.arg);
+			setKeys(keyState.keys);
+			setTouch(keyState.touchX, keyState.touchY);
+			if (timeTravelEnabled)
+				history.addInput(keyState.keys, keyState.touchX, keyState.touchY);
+			} break;
+		case SAVE_STATE:
+			saveStateFile(std::get<std::filesystem::path>(currentEvent.arg));
+			break;
+		case LOAD_STATE:
+			loadStateFile(std::get<std::filesystem::path>(currentEvent.arg));
+			break;
+		case REWIND:
+			stepBack();
+			break;
+		case RECORD_HASHES:
+			hasher.stop();
+			if (hasher.record(std::get<std::filesystem::path>(currentEvent.arg))) {
+				shared->log << fmt::format("Failed to open {}\n", std::get<std::filesystem::path>(currentEvent.arg).string());
+			} else if (threadedArm7) {
+				shared->log << "The ARM7 won't run on its own thread while hashing, since it isn't deterministic\n";
+			}
+			break;
+		case CHECK_HASHES:
+			hasher.stop();
+			if (hasher.check(std::get<std::filesystem::path>(currentEvent.arg))) {
+				shared->log << fmt::format("Failed to open {}\n", std::get<std::filesystem::path>(currentEvent.arg).string());
+			} else if (threadedArm7) {
+				shared->log << "The ARM7 won't run on its own thread while hashing, since it isn't deterministic\n";
+			}
+			break;
+		case STOP_HASHES:
+			hasher.stop();
+			break;
+		case REVERSE_STEP_ARM9:
+			reverseStep(true);
+			break;
+		case REVERSE_STEP_ARM7:
+			reverseStep(false);
+			break;
+		case REVERSE_CONTINUE:
+			reverseContinue();
+			break;
+		case ENABLE_FASTMEM:
+			setFastmem(true);
+			break;
+		case DISABLE_FASTMEM:
+			setFastmem(false);
 			break;
 		case SET_TIME: {
-			auto tt = time(0);
+			auto tt = std::get<RealTime>(currentEvent.arg).time;
 			nds7->rtc->syncToRealTime(&tt);
+			history.clear(); // Isn't logged, so replaying across it would go differently
 			} break;
 		default:
 			printf("Unknown thread event:  %d\n", currentEvent.type);
 			break;
 		}
 	}
-	threadQueueMutex.unlock();
 }
 
-void NDS::addThreadEvent(threadEventType type) { addThreadEvent(type, 0, nullptr); }
-
-void NDS::addThreadEvent(threadEventType type, u64 intArg) { addThreadEvent(type, intArg, nullptr); }
-
-void NDS::addThreadEvent(threadEventType type, void *ptrArg) { addThreadEvent(type, 0, ptrArg); }
-
-void NDS::addThreadEvent(threadEventType type, u64 intArg, void *ptrArg) {
-	threadQueueMutex.lock();
-	threadQueue.push(NDS::threadEvent{type, intArg, ptrArg});
-	threadQueueMutex.unlock();
+void NDS::addThreadEvent(threadEventType type, threadEventArg arg) {
+	threadQueue.push(threadEvent{type, std::move(arg), std::chrono::steady_clock::now()});
 }
 
 int NDS::loadRom(std::filesystem::path romFilePath) {
@@ -371,6 +1382,15 @@ int NDS::loadRom(std::filesystem::path romFilePath) {
 		name[i] = romMap[i];
 	romInfo.name = name;
 
+	char gameCode[5] = {0};
+	for (int i = 0; i < 4; i++)
+		gameCode[i] = romMap[0x00C + i];
+	romInfo.gameCode = gameCode;
+
+	auto idleLoopOverride = IdleLoopDetector::lookupOverride(romInfo.gameCode);
+	nds9->idleLoop.enabled = idleLoopOverride.arm9;
+	nds7->idleLoop.enabled = idleLoopOverride.arm7;
+
 	romInfo.version = romMap[0x01E];
 	romInfo.autostart = romMap[0x01F] >> 2;
 
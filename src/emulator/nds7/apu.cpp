@@ -17,7 +17,8 @@ APU::APU(std::shared_ptr<BusShared> shared, BusARM7& bus) : shared(shared), bus(
 	//newSamples = new i16[SAMPLE_BUFFER_SIZE * 2];
 	//outputSamples = new i16[SAMPLE_BUFFER_SIZE * 2];
 
-	soundRunning = false;
+	sampleDecimation = 1;
+	discardOutput = false;
 }
 
 APU::~APU() {
@@ -27,6 +28,7 @@ APU::~APU() {
 
 void APU::reset() {
 	sampleIndex = 0;
+	decimationCounter = 0;
 
 	for (int i = 0; i < 16; i++) {
 		AudioChannel& chan = channel[i];
@@ -56,10 +58,66 @@ void APU::reset() {
 	shared->addEvent(67108864 / 32768, APU_SAMPLE);
 }
 
+void APU::saveState(StateWriter &state) {
+	state.beginChunk("APU ", 1);
+	for (auto& chan : channel) {
+		state.write(chan.SOUNDCNT);
+		state.write(chan.SOUNDSAD);
+		state.write(chan.SOUNDTMR);
+		state.write(chan.SOUNDPNT);
+		state.write(chan.SOUNDLEN);
+		state.writeQueue(chan.inFifo);
+		state.write(chan.fifoOffset);
+		state.write(chan.wordsRead);
+		state.write(chan.lastSample);
+		state.write(chan.lastSampleTimestamp);
+		state.write(chan.timerPeriod);
+		state.write(chan.lfsr);
+	}
+	state.write(SOUNDCNT);
+	state.write(SOUNDBIAS);
+	state.write(SNDCAP0CNT);
+	state.write(SNDCAP1CNT);
+	state.write(SNDCAP0DAD);
+	state.write(SNDCAP0LEN);
+	state.write(SNDCAP1DAD);
+	state.write(SNDCAP1LEN);
+	state.write(sampleIndex);
+	state.write(newSamples);
+	state.endChunk();
+}
+
+void APU::loadState(StateReader &state) {
+	state.beginChunk("APU ", 1);
+	for (auto& chan : channel) {
+		state.read(chan.SOUNDCNT);
+		state.read(chan.SOUNDSAD);
+		state.read(chan.SOUNDTMR);
+		state.read(chan.SOUNDPNT);
+		state.read(chan.SOUNDLEN);
+		state.readQueue(chan.inFifo);
+		state.read(chan.fifoOffset);
+		state.read(chan.wordsRead);
+		state.read(chan.lastSample);
+		state.read(chan.lastSampleTimestamp);
+		state.read(chan.timerPeriod);
+		state.read(chan.lfsr);
+	}
+	state.read(SOUNDCNT);
+	state.read(SOUNDBIAS);
+	state.read(SNDCAP0CNT);
+	state.read(SNDCAP1CNT);
+	state.read(SNDCAP0DAD);
+	state.read(SNDCAP0LEN);
+	state.read(SNDCAP1DAD);
+	state.read(SNDCAP1LEN);
+	state.read(sampleIndex);
+	state.read(newSamples);
+	state.endChunk();
+}
+
 void APU::doSample() {
 	u16 leftSample, rightSample;
-	static int num = 0;
-	num++;
 
 	if (masterEnable) {
 		i32 totalLeft = 0;
@@ -72,7 +130,7 @@ void APU::doSample() {
 				break;
 
 			// 0 Incoming PCM16 Data          16.0  -8000h     +7FFFh
-			while ((chan.lastSampleTimestamp + chan.timerPeriod) <= shared->currentTime) {
+			while ((chan.lastSampleTimestamp + chan.timerPeriod) <= shared->time()) {
 				switch (chan.format) {
 				case 0: // PCM-8
 					chan.lastSample = (chan.inFifo.front() >> (8 * chan.fifoOffset)) & 0xFF;
@@ -135,15 +193,23 @@ void APU::doSample() {
 		leftSample = std::clamp(totalLeft, 0, 0x3FF);
 		rightSample = std::clamp(totalRight, 0, 0x3FF);
 	} else {
-		leftSample = rightSample = 0;
+		leftSample = rightSample = 0x200; // Silence is the middle of the range
 	}
 
-	//newSamples[sampleIndex++] = (num & 4) ? 0x7FFF : 0x8000;//(leftSample << 6) | (leftSample >> 4);
-	//newSamples[sampleIndex++] = (num & 4) ? 0x7FFF : 0x8000;//(rightSample << 6) | (rightSample >> 4);
-	if (sampleIndex >= SAMPLE_BUFFER_SIZE * 2) {
-		std::swap(newSamples, outputSamples);
-		soundRunning = false;
-		sampleIndex = 0;
+	if (++decimationCounter >= sampleDecimation) {
+		decimationCounter = 0;
+
+		// 10 bit unsigned to 16 bit signed
+		newSamples[sampleIndex++] = (i16)((leftSample - 0x200) << 6);
+		newSamples[sampleIndex++] = (i16)((rightSample - 0x200) << 6);
+		if (sampleIndex >= SAMPLE_BUFFER_SIZE * 2) {
+			if (!discardOutput) {
+				SampleBlock block;
+				std::copy(std::begin(newSamples), std::end(newSamples), block.begin());
+				outputBlocks.tryPush(block);
+			}
+			sampleIndex = 0;
+		}
 	}
 
 	shared->addEvent(67108864 / 32768, APU_SAMPLE);
@@ -176,7 +242,7 @@ void APU::startChannel(int chanNum) {
 	fillFifo(chanNum);
 
 	chan.lastSample = 0;
-	chan.lastSampleTimestamp = shared->currentTime;
+	chan.lastSampleTimestamp = shared->time();
 	chan.timerPeriod = ((BUS_CLOCK_SPEED / 2) / chan.SOUNDTMR) * (INTERNAL_CLOCK_SPEED / BUS_CLOCK_SPEED);
 
 	if (chanNum >= 14)
@@ -232,7 +298,8 @@ u8 APU::readIO7(u32 address) {
 	case 0x400051B:
 		return (u8)(SNDCAP0DAD >> 24);
 	default:
-		shared->log << fmt::format("[NDS7 Bus][APU] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][APU] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 }
@@ -359,7 +426,8 @@ void APU::writeIO7(u32 address, u8 value) {
 	case 0x400051F:
 		break;
 	default:
-		shared->log << fmt::format("[NDS7 Bus][APU] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][APU] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
 		break;
 	}
 }
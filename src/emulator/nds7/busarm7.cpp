@@ -20,6 +20,9 @@ static constexpr u32 toAddress(u32 page) {
 	return page << 14;
 }
 
+// Regions fastmem is used for: PSRAM, WRAM, and VRAM. The BIOS isn't in the page tables, and everything else is I/O or the GBA slot.
+static constexpr u16 fastmemRegions = (1 << 0x2) | (1 << 0x3) | (1 << 0x6);
+
 BusARM7::BusARM7(std::shared_ptr<BusShared> shared, std::shared_ptr<IPC> ipc, std::shared_ptr<PPU> ppu, std::shared_ptr<Gamecard> gamecard) :
 	shared(shared),
 	log(shared->log),
@@ -34,10 +37,8 @@ BusARM7::BusARM7(std::shared_ptr<BusShared> shared, std::shared_ptr<IPC> ipc, st
 	apu = std::make_unique<APU>(shared, *this);
 	wifi = std::make_unique<WiFi>(shared);
 
-	wram = new u8[0x10000]; // 64KB
-	memset(wram, 0, 0x10000);
-	bios = new u8[0x4000]; // 16KB
-	memset(bios, 0, 0x4000);
+	wram = shared->memory[GuestMemory::ARM7_WRAM]; // 64KB
+	bios = shared->memory[GuestMemory::ARM7_BIOS]; // 16KB
 
 	POSTFLG = 0;
 
@@ -67,15 +68,85 @@ BusARM7::BusARM7(std::shared_ptr<BusShared> shared, std::shared_ptr<IPC> ipc, st
 		  { 2,  2,  2,  2,  2,  2,  2,  2,  0,  0,  0,  2,  2,  2,  2,  2}}}  // Code Sequential 16
 	};
 	memcpy(waitstates, startingWaitstates, 2 * 2 * 2 * 16 * sizeof(int));
+	fetchPage = FETCH_NONE;
+
+	// I/O registers. WiFi is outside the table and handled in read() and write().
+	io.setFallback({.object = this,
+		.read8 = [](void *bus, u32 address, bool final) { return ((BusARM7 *)bus)->readIO(address, final); },
+		.write8 = [](void *bus, u32 address, u8 value, bool final) { ((BusARM7 *)bus)->writeIO(address, value, final); }});
+	IoTable::Handler interruptIo = {.object = this,
+		.read8 = [](void *bus, u32 address, bool final) { return ((BusARM7 *)bus)->readIO(address, final); },
+		.read32 = [](void *bus, u32 address, bool final) { return ((BusARM7 *)bus)->readIO32(address); },
+		.write8 = [](void *bus, u32 address, u8 value, bool final) { ((BusARM7 *)bus)->writeIO(address, value, final); },
+		.write32 = [](void *bus, u32 address, u32 value, bool final) { ((BusARM7 *)bus)->writeIO32(address, value); }};
+	io.add(0x4000208, 0x400020B, interruptIo);
+	io.add(0x4000210, 0x4000217, interruptIo);
+
+	IoTable::Handler sharedIo = {.object = shared.get(),
+		.read8 = [](void *shared, u32 address, bool final) { std::lock_guard lock(((BusShared *)shared)->ioMutex); return ((BusShared *)shared)->readIO7(address); },
+		.write8 = [](void *shared, u32 address, u8 value, bool final) { std::lock_guard lock(((BusShared *)shared)->ioMutex); ((BusShared *)shared)->writeIO7(address, value); }};
+	io.add(0x4000130, 0x4000137, sharedIo);
+	io.add(0x4000204, 0x4000205, sharedIo);
+	io.add(0x4000241, 0x4000241, {.object = shared.get(), .read8 = sharedIo.read8}); // WRAMSTAT
+
+	io.add(0x4000180, 0x4000187, {.object = this,
+		.read8 = [](void *bus, u32 address, bool final) { std::lock_guard lock(((BusARM7 *)bus)->shared->ioMutex); return ((BusARM7 *)bus)->ipc->readIO7(address, final); },
+		.write8 = [](void *bus, u32 address, u8 value, bool final) { std::lock_guard lock(((BusARM7 *)bus)->shared->ioMutex); ((BusARM7 *)bus)->ipc->writeIO7(address, value, final); }});
+	io.add(0x4000188, 0x400018B, {.object = this,
+		.write8 = [](void *bus, u32 address, u8 value, bool final) { std::lock_guard lock(((BusARM7 *)bus)->shared->ioMutex); ((BusARM7 *)bus)->ipc->writeIO7(address, value, final); },
+		.write32 = [](void *bus, u32 address, u32 value, bool final) { std::lock_guard lock(((BusARM7 *)bus)->shared->ioMutex); ((BusARM7 *)bus)->ipc->send7(value); }});
+	io.add(0x4100000, 0x4100003, {.object = this,
+		.read8 = [](void *bus, u32 address, bool final) { std::lock_guard lock(((BusARM7 *)bus)->shared->ioMutex); return ((BusARM7 *)bus)->ipc->readIO7(address, final); },
+		.read32 = [](void *bus, u32 address, bool final) { std::lock_guard lock(((BusARM7 *)bus)->shared->ioMutex); return ((BusARM7 *)bus)->ipc->receive7(); }});
+
+	IoTable::Handler ppuIo = {.object = ppu.get(),
+		.read8 = [](void *ppu, u32 address, bool final) { return ((PPU *)ppu)->readIO7(address); },
+		.write8 = [](void *ppu, u32 address, u8 value, bool final) { ((PPU *)ppu)->writeIO7(address, value); }};
+	io.add(0x4000004, 0x4000007, ppuIo);
+	io.add(0x4000240, 0x4000240, {.object = this, // VRAMSTAT
+		.read8 = [](void *bus, u32 address, bool final) { std::lock_guard lock(((BusARM7 *)bus)->shared->ioMutex); return ((BusARM7 *)bus)->ppu->readIO7(address); }});
+
+	IoTable::Handler gamecardIo = {.object = this,
+		.read8 = [](void *bus, u32 address, bool final) { std::lock_guard lock(((BusARM7 *)bus)->shared->ioMutex); return ((BusARM7 *)bus)->gamecard->readIO7(address, final); },
+		.write8 = [](void *bus, u32 address, u8 value, bool final) { std::lock_guard lock(((BusARM7 *)bus)->shared->ioMutex); ((BusARM7 *)bus)->gamecard->writeIO7(address, value); }};
+	io.add(0x40001A0, 0x40001BB, gamecardIo);
+	io.add(0x4100010, 0x4100014, gamecardIo);
+
+	io.addRegisters<dma7Registers>(static_cast<DmaRegisters *>(dma.get()), 0);
+	io.add(0x4000100, 0x400010F, {.object = timer.get(),
+		.read8 = [](void *timer, u32 address, bool final) { return ((Timer *)timer)->readIO(address); },
+		.write8 = [](void *timer, u32 address, u8 value, bool final) { ((Timer *)timer)->writeIO(address, value); }});
+	io.add(0x4000138, 0x4000138, {.object = rtc.get(),
+		.read8 = [](void *rtc, u32 address, bool final) { return ((RTC *)rtc)->readIO7(); },
+		.write8 = [](void *rtc, u32 address, u8 value, bool final) { ((RTC *)rtc)->writeIO7(value); }});
+	io.add(0x40001C0, 0x40001C3, {.object = spi.get(),
+		.read8 = [](void *spi, u32 address, bool final) { return ((SPI *)spi)->readIO7(address); },
+		.write8 = [](void *spi, u32 address, u8 value, bool final) { ((SPI *)spi)->writeIO7(address, value); }});
+	io.add(0x4000400, 0x400051F, {.object = apu.get(),
+		.read8 = [](void *apu, u32 address, bool final) { return ((APU *)apu)->readIO7(address); },
+		.write8 = [](void *apu, u32 address, u8 value, bool final) { ((APU *)apu)->writeIO7(address, value); }});
+
+	// Events
+	auto irqEvent = [](void *bus, int type) { ((BusARM7 *)bus)->requestInterrupt((InterruptType)type); };
+	shared->registerEvent(IPC_SYNC7, irqEvent, this, INT_IPC_SYNC);
+	shared->registerEvent(IPC_SEND_FIFO7, irqEvent, this, INT_IPC_SEND_FIFO);
+	shared->registerEvent(IPC_RECV_FIFO7, irqEvent, this, INT_IPC_RECV_FIFO);
+	shared->registerEvent(SPI_FINISHED, irqEvent, this, INT_SPI);
+	shared->registerEvent(SERIAL_INTERRUPT, irqEvent, this, INT_SERIAL);
+	shared->registerEvent(RTC_REFRESH, [](void *bus, int) { ((BusARM7 *)bus)->rtc->refresh<true>(); }, this);
+	shared->registerEvent(APU_SAMPLE, [](void *bus, int) { ((BusARM7 *)bus)->apu->doSample(); }, this);
+	for (int i = 0; i < 4; i++)
+		shared->registerEvent(timer->overflowEvent(i), timerEvent, this, i);
 }
 
 BusARM7::~BusARM7() {
-	delete[] wram;
-	delete[] bios;
+	//
 }
 
 void BusARM7::reset() {
 	delay = 0;
+	idleLoop.reset();
+	fetchPage = FETCH_NONE;
 
 	memset(wram, 0, 0x10000);
 
@@ -96,12 +167,69 @@ void BusARM7::reset() {
 	cpu->resetARM7TDMI();
 }
 
+void BusARM7::saveState(StateWriter &state) {
+	state.beginChunk("BUS7", 1);
+	state.write(IME);
+	state.write(IE);
+	state.write(IF);
+	state.write(POSTFLG);
+	state.write(HALTCNT);
+	state.write(delay);
+	state.writeBytes(wram, 0x10000);
+	state.endChunk();
+
+	// The pipeline isn't saved. NDS::loadState() refills it from R15 once all of memory is back.
+	state.beginChunk("CPU7", 1);
+	state.write(cpu->reg);
+	state.endChunk();
+
+	dma->saveState(state);
+	timer->saveState(state);
+	rtc->saveState(state);
+	spi->saveState(state);
+	apu->saveState(state);
+	wifi->saveState(state);
+}
+
+void BusARM7::loadState(StateReader &state) {
+	state.beginChunk("BUS7", 1);
+	state.read(IME);
+	state.read(IE);
+	state.read(IF);
+	state.read(POSTFLG);
+	state.read(HALTCNT);
+	state.read(delay);
+	state.readBytes(wram, 0x10000);
+	state.endChunk();
+
+	state.beginChunk("CPU7", 1);
+	state.read(cpu->reg);
+	state.endChunk();
+
+	dma->loadState(state);
+	timer->loadState(state);
+	rtc->loadState(state);
+	spi->loadState(state);
+	apu->loadState(state);
+	wifi->loadState(state);
+
+	idleLoop.reset();
+	refreshInterrupts();
+}
+
 void BusARM7::requestInterrupt(InterruptType type) {
 	IF |= type;
 
 	refreshInterrupts();
 }
 
+void BusARM7::timerEvent(void *bus, int channel) {
+	auto self = (BusARM7 *)bus;
+	u8 irqMask = self->timer->checkOverflow(channel);
+	if (irqMask)
+		self->requestInterrupt((InterruptType)(irqMask * INT_TIMER_0));
+}
+
 void BusARM7::refreshInterrupts() {
 	if (IE & IF)
 		HALTCNT = 0;
@@ -149,6 +277,9 @@ void BusARM7::refreshWramPages() {
 		readTable[i + 2] = writeTable[i + 2] = readTable[toPage(0x3008000)];
 		readTable[i + 3] = writeTable[i + 3] = readTable[toPage(0x300C000)];
 	}
+
+	fetchPage = FETCH_NONE;
+	fastmem.remap(readTable, writeTable);
 }
 
 void BusARM7::refreshVramPages() {
@@ -182,12 +313,26 @@ void BusARM7::refreshVramPages() {
 	// Mirror and copy to write table
 	for (int i = toPage(0x6000000); i < toPage(0x7000000); i++)
 		readTable[i] = writeTable[i] = readTable[i & toPage(0xF03FFFF)];
+
+	fetchPage = FETCH_NONE;
+	fastmem.remap(readTable, writeTable);
 }
 
 void BusARM7::refreshRomPages() {
 	//
 }
 
+// The cache holds a pointer to memory, not decoded instructions, so writes to the page show up on their own.
+// Only changing what the page points to (a table refresh) has to drop it.
+void BusARM7::setFetchPage(u32 address, u8 *pagePointer) {
+	fetchPage = address >> 14;
+	fetchPointer = pagePointer;
+	for (int sequential = 0; sequential < 2; sequential++) {
+		for (int word = 0; word < 2; word++)
+			fetchWaitstates[sequential][word] = waitstates[1][sequential][word][(address >> 24) & 0xF];
+	}
+}
+
 void BusARM7::hacf() {
 	shared->addEvent(0, EventType::STOP);
 }
@@ -195,33 +340,44 @@ void BusARM7::hacf() {
 template <typename T, bool code>
 T BusARM7::read(u32 address, bool sequential) {
 	u32 alignedAddress = address & ~(sizeof(T) - 1);
+	T val = 0;
+
+	// Sequential fetches almost always land on the same page as the last one
+	if constexpr (code) {
+		if ((alignedAddress >> 14) == fetchPage) [[likely]] {
+			delay += fetchWaitstates[sequential][sizeof(T) == 4];
+			val = GuestMemory::load<T>(fetchPointer + (alignedAddress & 0x3FFF));
+			return val;
+		}
+	}
+
 	u32 page = toPage(alignedAddress & 0x0FFFFFFF);
 	u32 offset = alignedAddress & 0x3FFF;
 
 	delay += waitstates[code][sequential][sizeof(T) == 4][(alignedAddress >> 24) & 0xF];
 	//delay += 2;
 
+	// Instruction fetches skip fastmem so they can fill the fetch cache
+	if (!code && fastmem.base && Fastmem::covers(address, fastmemRegions) && fastmem.read(alignedAddress, val)) [[likely]]
+		return val;
+
 	u8 *ptr = readTable[page];
-	T val = 0;
 	if ((address < 0x10000000) && (ptr != NULL)) { [[likely]]
-		memcpy(&val, ptr + offset, sizeof(T));
+		val = GuestMemory::load<T>(ptr + offset);
+		if constexpr (code)
+			setFetchPage(alignedAddress, ptr);
 	} else {
+		if (!code && idleLoop.active)
+			idleLoop.read(alignedAddress);
+
 		switch (address) {
 		case 0x0000000 ... 0x0004000: // ARM7-BIOS
 			memcpy(&val, bios + alignedAddress, sizeof(T));
+			if (code && (alignedAddress < 0x4000))
+				setFetchPage(alignedAddress, bios);
 			break;
 		case 0x4000000 ... 0x47FFFFF: // ARM7-I/O Ports
-			if constexpr (sizeof(T) == 4) {
-				val |= (readIO(alignedAddress | 0, false) << 0);
-				val |= (readIO(alignedAddress | 1, false) << 8);
-				val |= (readIO(alignedAddress | 2, false) << 16);
-				val |= (readIO(alignedAddress | 3, true) << 24);
-			} else if constexpr (sizeof(T) == 2) {
-				val |= (readIO(alignedAddress | 0, false) << 0);
-				val |= (readIO(alignedAddress | 1, true) << 8);
-			} else {
-				val = readIO(alignedAddress, true);
-			}
+			val = io.read<T>(alignedAddress, true);
 			break;
 		case 0x4800000 ... 0x4808FFF: // Wifi
 			if constexpr (sizeof(T) == 2) {
@@ -231,17 +387,19 @@ T BusARM7::read(u32 address, bool sequential) {
 			}
 			// Byte reads aren't allowed
 			break;
-		case 0x6000000 ... 0x6FFFFFF: // Fallback for when VRAM banks overlap
+		case 0x6000000 ... 0x6FFFFFF: { // Fallback for when VRAM banks overlap
 			offset = alignedAddress & 0x1FFFF;
+			std::lock_guard lock(shared->ioMutex); // The ARM9 might be changing the mapping
 
 			if (ppu->vramCMapped7 && (((alignedAddress >> 17) & 1) == (ppu->vramCOffset & 1)))
-				memcpy(&val, ppu->vramC + offset, sizeof(T));
+				val = GuestMemory::load<T>(ppu->vramC + offset);
 			if (ppu->vramDMapped7 && (((alignedAddress >> 17) & 1) == (ppu->vramDOffset & 1)))
-				memcpy(&val, ppu->vramD + offset, sizeof(T));
+				val = GuestMemory::load<T>(ppu->vramD + offset);
 
 			if (!(ppu->vramCMapped7 && (((alignedAddress >> 17) & 1) == (ppu->vramCOffset & 1))) && !(ppu->vramDMapped7 && (((alignedAddress >> 17) & 1) == (ppu->vramDOffset & 1))))
 				delay -= waitstates[code][sequential][sizeof(T) == 4][0x6] + 2;
 			break;
+		}
 		case 0x8000000 ... 0x9FFFFFF: // GBA Slot ROM (open bus for now)
 			if (sizeof(T) == 4) {
 				val = ((alignedAddress / 2) & 0xFFFF) | (((alignedAddress / 2) + 1) & 0xFFFF);
@@ -252,7 +410,8 @@ T BusARM7::read(u32 address, bool sequential) {
 		default:
 			delay -= waitstates[code][sequential][sizeof(T) == 4][(alignedAddress >> 24) & 0xF] + 2;
 
-			shared->log << fmt::format("[NDS7 Bus] Read from unknown location 0x{:0>8X}\n", address);
+			if constexpr (Instrumentation::logging)
+				shared->log << fmt::format("[NDS7 Bus] Read from unknown location 0x{:0>8X}\n", address);
 			break;
 		}
 	}
@@ -273,23 +432,21 @@ void BusARM7::write(u32 address, T value, bool sequential) {
 
 	delay += waitstates[0][sequential][sizeof(T) == 4][(alignedAddress >> 24) & 0xF];
 
+	if (idleLoop.active)
+		idleLoop.write();
+	if ((address >= 0x2000000) && (address < 0x3800000)) // PSRAM and shared WRAM
+		BusShared::requestWake(shared->wakeArm9);
+
+	if (fastmem.base && Fastmem::covers(address, fastmemRegions) && fastmem.write(alignedAddress, value)) [[likely]]
+		return;
+
 	u8 *ptr = writeTable[page];
 	if ((address < 0x10000000) && (ptr != NULL)) { [[likely]]
-		memcpy(ptr + offset, &value, sizeof(T));
+		GuestMemory::store<T>(ptr + offset, value);
 	} else {
 		switch (address) {
 		case 0x4000000 ... 0x47FFFFF: // I/O
-			if constexpr (sizeof(T) == 4) {
-				writeIO(alignedAddress | 0, (u8)(value >> 0), false);
-				writeIO(alignedAddress | 1, (u8)(value >> 8), false);
-				writeIO(alignedAddress | 2, (u8)(value >> 16), false);
-				writeIO(alignedAddress | 3, (u8)(value >> 24), true);
-			} else if constexpr (sizeof(T) == 2) {
-				writeIO(alignedAddress | 0, (u8)(value >> 0), false);
-				writeIO(alignedAddress | 1, (u8)(value >> 8), true);
-			} else {
-				writeIO(alignedAddress, value, true);
-			}
+			io.write<T>(alignedAddress, value, true);
 			break;
 		case 0x4800000 ... 0x4808FFF: // Wifi
 			if constexpr (sizeof(T) == 2) {
@@ -300,20 +457,23 @@ void BusARM7::write(u32 address, T value, bool sequential) {
 			}
 			// Byte writes aren't allowed
 			break;
-		case 0x6000000 ... 0x6FFFFFF: // Fallback for when VRAM banks overlap
+		case 0x6000000 ... 0x6FFFFFF: { // Fallback for when VRAM banks overlap
 			offset = alignedAddress & 0x1FFFF;
+			std::lock_guard lock(shared->ioMutex);
 
 			if (ppu->vramCMapped7 && (((alignedAddress >> 17) & 1) == (ppu->vramCOffset & 1)))
-				memcpy(ppu->vramC + offset, &value, sizeof(T));
+				GuestMemory::store<T>(ppu->vramC + offset, value);
 			if (ppu->vramDMapped7 && (((alignedAddress >> 17) & 1) == (ppu->vramDOffset & 1)))
-				memcpy(ppu->vramD + offset, &value, sizeof(T));
+				GuestMemory::store<T>(ppu->vramD + offset, value);
 
 			if (!(ppu->vramCMapped7 && (((alignedAddress >> 17) & 1) == (ppu->vramCOffset & 1))) && !(ppu->vramDMapped7 && (((alignedAddress >> 17) & 1) == (ppu->vramDOffset & 1))))
 				delay -= waitstates[0][sequential][sizeof(T) == 4][0x6] + 2;
 			break;
+		}
 		default:
 			delay -= waitstates[0][sequential][sizeof(T) == 4][(alignedAddress >> 24) & 0xF] + 2;
-			shared->log << fmt::format("[NDS7 Bus] Write to unknown location 0x{:0>8X} with {} byte value 0x{:0>{}X}\n", address, sizeof(T), value, sizeof(T) * 2);
+			if constexpr (Instrumentation::logging)
+				shared->log << fmt::format("[NDS7 Bus] Write to unknown location 0x{:0>8X} with {} byte value 0x{:0>{}X}\n", address, sizeof(T), value, sizeof(T) * 2);
 			break;
 		}
 	}
@@ -330,42 +490,12 @@ void BusARM7::breakpoint() {
 	shared->addEvent(0, EventType::STOP);
 }
 
+// Registers the bus owns, and anything io doesn't have a handler for. Components are reached through io.
 u8 BusARM7::readIO(u32 address, bool final) {
 	switch (address) {
-	case 0x4000130 ... 0x4000137:
-	case 0x4000204: case 0x4000205:
-	case 0x4000241:
-		return shared->readIO7(address);
-
-	case 0x4000180 ... 0x4000187:
-	case 0x4100000 ... 0x4100003:
-		return ipc->readIO7(address, final);
-
-	case 0x4000004 ... 0x4000007:
-	case 0x4000240:
-		return ppu->readIO7(address);
-
-	case 0x40001A0 ... 0x40001BB:
-	case 0x4100010 ... 0x4100014:
-		return gamecard->readIO7(address, final);
-
-	case 0x40000B0 ... 0x40000DF:
-		return dma->readIO7(address);
-
-	case 0x4000100 ... 0x400010F:
-		return timer->readIO(address);
-
-	case 0x4000138:
-		return rtc->readIO7();
 	case 0x4000139:
 		return 0;
 
-	case 0x40001C0 ... 0x40001C3:
-		return spi->readIO7(address);
-
-	case 0x4000400 ... 0x400051F:
-		return apu->readIO7(address);
-
 	case 0x4000208:
 		return (u8)IME;
 	case 0x4000209 ... 0x400020B:
@@ -392,53 +522,17 @@ u8 BusARM7::readIO(u32 address, bool final) {
 		return HALTCNT;
 
 	default:
-		shared->log << fmt::format("[NDS7 Bus] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 }
 
 void BusARM7::writeIO(u32 address, u8 value, bool final) {
 	switch (address) {
-	case 0x4000130 ... 0x4000137:
-	case 0x4000204: case 0x4000205:
-		shared->writeIO7(address, value);
-		break;
-
-	case 0x4000180 ... 0x400018B:
-		ipc->writeIO7(address, value, final);
-		break;
-
-	case 0x4000004 ... 0x4000007:
-		ppu->writeIO7(address, value);
-		break;
-
-	case 0x40001A0 ... 0x40001BB:
-	case 0x4100010 ... 0x4100014:
-		gamecard->writeIO7(address, value);
-		break;
-
-	case 0x40000B0 ... 0x40000DF:
-		dma->writeIO7(address, value);
-		break;
-
-	case 0x4000100 ... 0x400010F:
-		timer->writeIO(address, value);
-		break;
-
-	case 0x4000138:
-		rtc->writeIO7(value);
-		break;
 	case 0x4000139:
 		break;
 
-	case 0x40001C0 ... 0x40001C3:
-		spi->writeIO7(address, value);
-		break;
-
-	case 0x4000400 ... 0x400051F:
-		apu->writeIO7(address, value);
-		break;
-
 	case 0x4000208:
 		IME = value & 1;
 		refreshInterrupts();
@@ -495,7 +589,33 @@ void BusARM7::writeIO(u32 address, u8 value, bool final) {
 		break;
 
 	default:
-		shared->log << fmt::format("[NDS7 Bus] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		break;
+	}
+}
+
+u32 BusARM7::readIO32(u32 address) {
+	switch (address) {
+	case 0x4000208: return IME;
+	case 0x4000210: return IE;
+	case 0x4000214: return IF;
+	default: return 0;
+	}
+}
+
+// Interrupt handlers acknowledge with a word write to IF, so only refresh once
+void BusARM7::writeIO32(u32 address, u32 value) {
+	switch (address) {
+	case 0x4000208:
+		IME = value & 1;
+		break;
+	case 0x4000210:
+		IE = value & 0x01DF3FFF;
+		break;
+	case 0x4000214:
+		IF &= ~value;
 		break;
 	}
+	refreshInterrupts();
 }
@@ -56,6 +56,42 @@ void RTC::reset() {
 	freeRegister = 0;
 }
 
+void RTC::saveState(StateWriter &state) {
+	state.beginChunk("RTC ", 1);
+	state.write(bitsSent);
+	state.write(sentData);
+	state.write(readBuf);
+	state.write(rtcTime);
+	state.write(bus);
+	state.write(commandRegister);
+	state.write(statusRegister1);
+	state.write(statusRegister2);
+	state.write(dateTimeRegister);
+	state.write(alarm1);
+	state.write(alarm2);
+	state.write(clockAdjustmentRegister);
+	state.write(freeRegister);
+	state.endChunk();
+}
+
+void RTC::loadState(StateReader &state) {
+	state.beginChunk("RTC ", 1);
+	state.read(bitsSent);
+	state.read(sentData);
+	state.read(readBuf);
+	state.read(rtcTime);
+	state.read(bus);
+	state.read(commandRegister);
+	state.read(statusRegister1);
+	state.read(statusRegister2);
+	state.read(dateTimeRegister);
+	state.read(alarm1);
+	state.read(alarm2);
+	state.read(clockAdjustmentRegister);
+	state.read(freeRegister);
+	state.endChunk();
+}
+
 void RTC::syncToRealTime(time_t *tt) {
 	std::tm* tm = localtime(tt);
 
@@ -76,12 +112,11 @@ static const int monthLengths[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 3
 
 template <bool scheduled> // My code really should be structured to work without this, but it allows me to ignore a lot of special cases in normal operation.
 void RTC::refresh() {
-	if (scheduled && (toRtcTime(shared->currentTime) == rtcTime))
-		return;
-	rtcTime = toRtcTime(shared->currentTime);
+	rtcTime = toRtcTime(shared->time());
 	bool oldInterruptRequested = interrupt1Flag || interrupt2Flag;
+	u64 nextRefresh = (rtcTime | 0xFFFF) + 1; // There's only one RTC_REFRESH slot, so always wake up for the next second at the latest
 
-	bool newSecond = (toRtcTime(shared->currentTime) & 0xFFFF) == 0; // One second has passed
+	bool newSecond = (toRtcTime(shared->time()) & 0xFFFF) == 0; // One second has passed
 	if (newSecond) { // Update time
 		second = fromBcd(second) + 1;
 		if (second == 60) {
@@ -129,8 +164,6 @@ void RTC::refresh() {
 		} else {
 			second = fromBcd(second);
 		}
-
-		shared->addEvent(fromRtcTime(0x10000), RTC_REFRESH);
 	}
 
 	switch (interrupt1Mode) {
@@ -148,13 +181,13 @@ void RTC::refresh() {
 			interrupt1Flag = true;
 			//u64 temp = _pdep_u64((_pext_u64(rtcTime, ~adjustedFrequency) + (1 << std::countr_zero(adjustedFrequency))) & ~((1 << std::countr_zero(adjustedFrequency)) - 1), ~adjustedFrequency) | adjustedFrequency;
 			u64 temp = (((rtcTime | adjustedFrequency) + (adjustedFrequency & -adjustedFrequency)) | adjustedFrequency) & mask;
-			shared->addEventAbsolute(fromRtcTime(temp), RTC_REFRESH);
+			nextRefresh = std::min(nextRefresh, temp);
 			if (scheduled) shared->addEvent(0, SERIAL_INTERRUPT); // Stupid workaround
 			//printf("%02llX  %016llX  %016llX\n", adjustedFrequency, rtcTime, temp);
 		} else {
 			interrupt1Flag = false;
 			u64 temp = (rtcTime | adjustedFrequency) & mask;
-			shared->addEventAbsolute(fromRtcTime(temp), RTC_REFRESH);
+			nextRefresh = std::min(nextRefresh, temp);
 			//printf("%02llX  %016llX  %016llX\n", adjustedFrequency, rtcTime, temp);
 		}
 		} break;
@@ -177,14 +210,14 @@ void RTC::refresh() {
 		// Documentation says 7.9ms high. I'm going with 7.8125 because it makes more sense.
 		if ((second == 0) && ((rtcTime & 0xFFFF) < 512)) {
 			interrupt1Flag = true;
-			shared->addEvent(fromRtcTime(512 - (rtcTime & 0xFFFF)), RTC_REFRESH);
+			nextRefresh = std::min(nextRefresh, rtcTime + 512 - (rtcTime & 0xFFFF));
 		} else {
 			interrupt1Flag = false;
 		}
 		break;
 	case 0b1000 ... 0b1111: // 32kHz interrupt
 		interrupt1Flag = rtcTime & 1;
-		shared->addEvent(fromRtcTime(1), RTC_REFRESH);
+		nextRefresh = rtcTime + 1;
 		break;
 	}
 
@@ -200,6 +233,8 @@ void RTC::refresh() {
 
 	if (!oldInterruptRequested && (interrupt1Flag || interrupt2Flag))
 		shared->addEvent(0, SERIAL_INTERRUPT);
+
+	shared->addEventAbsolute(fromRtcTime(nextRefresh), RTC_REFRESH);
 }
 template void RTC::refresh<false>();
 template void RTC::refresh<true>();
@@ -209,7 +244,7 @@ u8 RTC::readIO7() {
 	if (dataDirection) {
 		return bus;
 	} else {
-		if (logRtc)
+		if (Instrumentation::logging && logRtc)
 			shared->log << fmt::format("[NDS7][RTC] Read bit: {}\n", readBuf & 1);
 		return (bus & 0xFE) | (readBuf & 1);
 	}
@@ -239,7 +274,7 @@ void RTC::writeIO7(u8 value) {
 							commandRegister = reverseBits(commandRegister);
 						if ((commandRegister & 0xF0) != 0b0110'0000)
 							shared->log << fmt::format("[NDS7][RTC] Invalid control command {:0>8b}\n", reverseBits(commandRegister));
-						if (logRtc)
+						if (Instrumentation::logging && logRtc)
 							shared->log << fmt::format("[NDS7][RTC] Command: {:0>8b} {} register {}\n", commandRegister, parameterReadWrite ? "Reading" : "Writing", (u8)command);
 
 						if (parameterReadWrite) { // Reading register
@@ -286,7 +321,7 @@ void RTC::writeIO7(u8 value) {
 						}
 					} else {
 						u8 writtenData = sentData >> (bitsSent - 8);
-						if (logRtc)
+						if (Instrumentation::logging && logRtc)
 							shared->log << fmt::format("[NDS7][RTC] Parameter: {:0>8b}\n", writtenData);
 
 						switch (command) {
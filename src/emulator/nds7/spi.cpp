@@ -36,6 +36,38 @@ void SPI::reset() {
 	touchscreen.yPosition = 0;
 }
 
+void SPI::saveState(StateWriter &state) {
+	state.beginChunk("SPI ", 1);
+	state.write(writeNumber);
+	state.write(SPICNT);
+	state.write(SPIDATA);
+	state.write(touchscreen);
+	state.write(firmware.status);
+	state.write(firmware.currentCommand);
+	state.write(firmware.address);
+	state.write(firmware.deepPowerDown);
+	state.write(firmware.powerDownPending);
+	state.write(firmware.powerUpPending);
+	state.write(firmware.writeProtect);
+	state.endChunk();
+}
+
+void SPI::loadState(StateReader &state) {
+	state.beginChunk("SPI ", 1);
+	state.read(writeNumber);
+	state.read(SPICNT);
+	state.read(SPIDATA);
+	state.read(touchscreen);
+	state.read(firmware.status);
+	state.read(firmware.currentCommand);
+	state.read(firmware.address);
+	state.read(firmware.deepPowerDown);
+	state.read(firmware.powerDownPending);
+	state.read(firmware.powerUpPending);
+	state.read(firmware.writeProtect);
+	state.endChunk();
+}
+
 void SPI::chipSelectLow() {
 	writeNumber = 0;
 
@@ -58,7 +90,8 @@ u8 SPI::readIO7(u32 address) {
 	case 0x40001C3:
 		return 0;
 	default:
-		shared->log << fmt::format("[NDS7 Bus][SPI] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][SPI] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 }
@@ -78,7 +111,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 		SPIDATA = value;
 
 		if (spiBusEnable) {
-			if (logSpi) {
+			if (Instrumentation::logging && logSpi) {
 				shared->log << fmt::format("[NDS7][SPI] Transferring {:0>2X} to ", SPIDATA);
 				switch (deviceSelect) {
 				case 0: shared->log << "Power Manager"; break;
@@ -103,7 +136,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 				switch (firmware.currentCommand) {
 				case 0x06: // WREN - Write Enable
 					if (writeNumber == 0) {
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0x06: WREN - Write Enable\n";
 
 						firmware.writeEnableLatch = true;
@@ -111,7 +144,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 					break;
 				case 0x04: // WRDI - Write Disable
 					if (writeNumber == 0) {
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0x04: WRDI - Write Disable\n";
 
 						firmware.writeEnableLatch = false;
@@ -122,34 +155,34 @@ void SPI::writeIO7(u32 address, u8 value) {
 					case 0:
 						rejectIfWrite();
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0x95: RDID - Read JEDEC Identification\n";
 						break;
 					case 1: // Manufacturer Identification
 						SPIDATA = 0x20;
 
-						if (firmware.logFirmware) {
+						if (Instrumentation::logging && firmware.logFirmware) {
 							shared->log << "[NDS7][SPI][Firmware] Read Manufacturer Identification: 0x20\n";
 						}
 						break;
 					case 2: // Memory Type
 						SPIDATA = 0x40;
 
-						if (firmware.logFirmware) {
+						if (Instrumentation::logging && firmware.logFirmware) {
 							shared->log << "[NDS7][SPI][Firmware] Read Memory Type: 0x40\n";
 						}
 						break;
 					case 3: // Manufacturer Identification
 						SPIDATA = 0x12;
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Read Memory Capacity: 0x12\n";
 						break;
 					}
 					break;
 				case 0x05: // RDSR - Read Status Register
 					if (writeNumber == 0) {
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0x05: RDSR - Read Status Register\n";
 					} else {
 						SPIDATA = firmware.status;
@@ -161,21 +194,21 @@ void SPI::writeIO7(u32 address, u8 value) {
 						rejectIfWrite();
 						firmware.address = 0;
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0x03: READ - Read Data Bytes\n";
 						break;
 					case 1 ... 3: // Address
 						firmware.address = (firmware.address << 8) | SPIDATA;
 						firmware.address &= 0x3FFFF;
 
-						if (firmware.logFirmware && (writeNumber == 3))
+						if (Instrumentation::logging && firmware.logFirmware && (writeNumber == 3))
 							shared->log << fmt::format("[NDS7][SPI][Firmware] Selected Address: 0x{:0>5X}\n", firmware.address);
 						break;
 					default: // Continuously read bytes
 						SPIDATA = firmware.data[firmware.address++];
 						firmware.address &= 0x3FFFF;
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << fmt::format("[NDS7][SPI][Firmware] Read Byte: 0x{:0>2X}\n", SPIDATA);
 						break;
 					}
@@ -186,14 +219,14 @@ void SPI::writeIO7(u32 address, u8 value) {
 						rejectIfWrite();
 						firmware.address = 0;
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0x0B: FAST - Read Data Bytes at Higher Speed\n";
 						break;
 					case 1 ... 3: // Address
 						firmware.address = (firmware.address << 8) | SPIDATA;
 						firmware.address &= 0x3FFFF;
 
-						if (firmware.logFirmware && (writeNumber == 3))
+						if (Instrumentation::logging && firmware.logFirmware && (writeNumber == 3))
 							shared->log << fmt::format("[NDS7][SPI][Firmware] Selected Address: 0x{:0>5X}\n", firmware.address);
 						break;
 					case 4: // Dummy byte
@@ -202,7 +235,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 						SPIDATA = firmware.data[firmware.address++];
 						firmware.address &= 0x3FFFF;
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << fmt::format("[NDS7][SPI][Firmware] Read Byte: 0x{:0>2X}\n", SPIDATA);
 						break;
 					}
@@ -213,14 +246,14 @@ void SPI::writeIO7(u32 address, u8 value) {
 						rejectIfWrite();
 						firmware.address = 0;
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0x0A: PW - Page Write\n";
 						break;
 					case 1 ... 3: // Address
 						firmware.address = (firmware.address << 8) | SPIDATA;
 						firmware.address &= 0x3FFFF;
 
-						if (firmware.logFirmware && (writeNumber == 3))
+						if (Instrumentation::logging && firmware.logFirmware && (writeNumber == 3))
 							shared->log << fmt::format("[NDS7][SPI][Firmware] Selected Address: 0x{:0>5X}\n", firmware.address);
 						break;
 					case 4: // Erase page
@@ -237,7 +270,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 						firmware.data[firmware.address] = SPIDATA;
 						firmware.address = (firmware.address & 0x3FF00) | ((firmware.address + 1) & 0xFF);
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << fmt::format("[NDS7][SPI][Firmware] Wrote Byte: 0x{:0>2X}\n", SPIDATA);
 						break;
 					}
@@ -248,14 +281,14 @@ void SPI::writeIO7(u32 address, u8 value) {
 						rejectIfWrite();
 						firmware.address = 0;
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0x02: PP - Page Program\n";
 						break;
 					case 1 ... 3: // Address
 						firmware.address = (firmware.address << 8) | SPIDATA;
 						firmware.address &= 0x3FFFF;
 
-						if (firmware.logFirmware && (writeNumber == 3))
+						if (Instrumentation::logging && firmware.logFirmware && (writeNumber == 3))
 							shared->log << fmt::format("[NDS7][SPI][Firmware] Selected Address: 0x{:0>5X}\n", firmware.address);
 						break;
 					case 4:
@@ -268,7 +301,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 						firmware.data[firmware.address] &= SPIDATA;
 						firmware.address = (firmware.address & 0x3FF00) | ((firmware.address + 1) & 0xFF);
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << fmt::format("[NDS7][SPI][Firmware] Programmed Byte: 0x{:0>2X}\n", SPIDATA);
 						break;
 					}
@@ -279,7 +312,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 						rejectIfWrite();
 						firmware.address = 0;
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0xDB: PE - Page Erase 100h bytes\n";
 						break;
 					case 1 ... 3: // Address
@@ -297,7 +330,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 								firmware.data[(firmware.address & 0x3FF00) | i] = 0xFF;
 							}
 
-							if (firmware.logFirmware)
+							if (Instrumentation::logging && firmware.logFirmware)
 								shared->log << fmt::format("[NDS7][SPI][Firmware] Selected Page: 0x{:0>3X}\n", firmware.address >> 8);
 						}
 						break;
@@ -309,7 +342,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 						rejectIfWrite();
 						firmware.address = 0;
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0xD8: SE - Sector Erase 10000h bytes\n";
 						break;
 					case 1 ... 3: // Address
@@ -327,7 +360,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 								firmware.data[(firmware.address & 0x30000) | i] = 0xFF;
 							}
 
-							if (firmware.logFirmware)
+							if (Instrumentation::logging && firmware.logFirmware)
 								shared->log << fmt::format("[NDS7][SPI][Firmware] Selected Sector: {}\n", firmware.address >> 16);
 						}
 						break;
@@ -343,7 +376,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 						// tion is not executed.
 						firmware.powerUpPending = true;
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0xB9: DP - Deep Power-down\n";
 					} else {
 						firmware.powerUpPending = false;
@@ -359,7 +392,7 @@ void SPI::writeIO7(u32 address, u8 value) {
 						// cuted.
 						firmware.powerDownPending = true;
 
-						if (firmware.logFirmware)
+						if (Instrumentation::logging && firmware.logFirmware)
 							shared->log << "[NDS7][SPI][Firmware] Command 0xAB: RDP - Release from Deep Power-down\n";
 					} else {
 						firmware.powerDownPending = false;
@@ -411,7 +444,8 @@ void SPI::writeIO7(u32 address, u8 value) {
 	case 0x40001C3:
 		break;
 	default:
-		shared->log << fmt::format("[NDS7 Bus][SPI] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][SPI] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
 		break;
 	}
 }
@@ -3,17 +3,29 @@
 WiFi::WiFi(std::shared_ptr<BusShared> shared) : shared(shared) {
 	logWifi = false;
 
-    wifiRam = new u8[0x2000]; // 8KB
+    wifiRam = shared->memory[GuestMemory::WIFI_RAM]; // 8KB
 }
 
 WiFi::~WiFi() {
-	delete[] wifiRam;
+	//
 }
 
 void WiFi::reset() {
 	memset(wifiRam, 0, 0x2000);
 }
 
+void WiFi::saveState(StateWriter &state) {
+	state.beginChunk("WIFI", 1);
+	state.writeBytes(wifiRam, 0x2000);
+	state.endChunk();
+}
+
+void WiFi::loadState(StateReader &state) {
+	state.beginChunk("WIFI", 1);
+	state.readBytes(wifiRam, 0x2000);
+	state.endChunk();
+}
+
 u16 WiFi::readIO7(u32 address) {
 	switch (address) {
     case 0x4808000:
@@ -23,7 +35,8 @@ u16 WiFi::readIO7(u32 address) {
     case 0x4804000 ... 0x4805FFF:
         return *(u16 *)(wifiRam + (address & 0x1FFF));
 	default:
-		shared->log << fmt::format("[NDS7 Bus][Wifi] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][Wifi] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 }
@@ -34,7 +47,8 @@ void WiFi::writeIO7(u32 address, u16 value) {
         *(u16 *)(wifiRam + (address & 0x1FFF)) = value;
         break;
 	default:
-		shared->log << fmt::format("[NDS7 Bus][Wifi] Write to unknown IO register 0x{:0>7X} with value 0x{:0>4X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][Wifi] Write to unknown IO register 0x{:0>7X} with value 0x{:0>4X}\n", address, value);
 		break;
 	}
 }
@@ -17,6 +17,10 @@ static constexpr u32 toAddress(u32 page) {
 	return page << 14;
 }
 
+// Regions fastmem is used for: ITCM, PSRAM (and usually DTCM), shared WRAM, and VRAM. Byte reads skip VRAM since readTable8 doesn't map it.
+static constexpr u16 fastmemRegions = (1 << 0x0) | (1 << 0x1) | (1 << 0x2) | (1 << 0x3) | (1 << 0x6);
+static constexpr u16 fastmemRegions8 = (1 << 0x0) | (1 << 0x1) | (1 << 0x2) | (1 << 0x3);
+
 BusARM9::BusARM9(std::shared_ptr<BusShared> shared, std::shared_ptr<IPC> ipc, std::shared_ptr<PPU> ppu, std::shared_ptr<Gamecard> gamecard) :
 	shared(shared),
 	log(shared->log),
@@ -28,20 +32,88 @@ BusARM9::BusARM9(std::shared_ptr<BusShared> shared, std::shared_ptr<IPC> ipc, st
 	timer = std::make_unique<Timer>(true, shared);
 	dsmath = std::make_unique<DSMath>(shared);
 
-	bios = new u8[0x8000]; // 32KB
-	memset(bios, 0, 0x8000);
+	bios = shared->memory[GuestMemory::ARM9_BIOS]; // 32KB
+	itcm = shared->memory[GuestMemory::ITCM];
+	dtcm = shared->memory[GuestMemory::DTCM];
 
 	// Fill page tables
 	memset(&readTable, 0, sizeof(readTable));
 	memset(&readTable8, 0, sizeof(readTable8));
 	memset(&writeTable, 0, sizeof(writeTable));
+	memset(&codeTable, 0, sizeof(codeTable));
+	fetchPage = FETCH_NONE;
 
 	// PSRAM/Main Memory (4MB mirrored 0x2000000 - 0x3000000)
 	for (int i = toPage(0x2000000); i < toPage(0x3000000); i++) {
-		readTable[i] = readTable8[i] = writeTable[i] = shared->psram + ((toAddress(i) - 0x2000000)) % 0x400000;
+		readTable[i] = readTable8[i] = writeTable[i] = codeTable[i] = shared->psram + ((toAddress(i) - 0x2000000)) % 0x400000;
 	}
 
 	POSTFLG = 0;
+
+	// I/O registers. Later entries replace earlier ones where they overlap.
+	io.setFallback({.object = this,
+		.read8 = [](void *bus, u32 address, bool final) { return ((BusARM9 *)bus)->readIO(address, final); },
+		.write8 = [](void *bus, u32 address, u8 value, bool final) { ((BusARM9 *)bus)->writeIO(address, value, final); }});
+	IoTable::Handler interruptIo = {.object = this,
+		.read8 = [](void *bus, u32 address, bool final) { return ((BusARM9 *)bus)->readIO(address, final); },
+		.read32 = [](void *bus, u32 address, bool final) { return ((BusARM9 *)bus)->readIO32(address); },
+		.write8 = [](void *bus, u32 address, u8 value, bool final) { ((BusARM9 *)bus)->writeIO(address, value, final); },
+		.write32 = [](void *bus, u32 address, u32 value, bool final) { ((BusARM9 *)bus)->writeIO32(address, value); }};
+	io.add(0x4000208, 0x400020B, interruptIo);
+	io.add(0x4000210, 0x4000217, interruptIo);
+
+	IoTable::Handler sharedIo = {.object = shared.get(),
+		.read8 = [](void *shared, u32 address, bool final) { std::lock_guard lock(((BusShared *)shared)->ioMutex); return ((BusShared *)shared)->readIO9(address); },
+		.write8 = [](void *shared, u32 address, u8 value, bool final) { std::lock_guard lock(((BusShared *)shared)->ioMutex); ((BusShared *)shared)->writeIO9(address, value); }};
+	io.add(0x4000130, 0x4000137, sharedIo);
+	io.add(0x4000204, 0x4000205, sharedIo);
+	io.add(0x4000247, 0x4000247, sharedIo);
+
+	io.add(0x4000180, 0x4000187, {.object = this,
+		.read8 = [](void *bus, u32 address, bool final) { std::lock_guard lock(((BusARM9 *)bus)->shared->ioMutex); return ((BusARM9 *)bus)->ipc->readIO9(address, final); },
+		.write8 = [](void *bus, u32 address, u8 value, bool final) { std::lock_guard lock(((BusARM9 *)bus)->shared->ioMutex); ((BusARM9 *)bus)->ipc->writeIO9(address, value, final); }});
+	io.add(0x4000188, 0x400018B, {.object = this,
+		.write8 = [](void *bus, u32 address, u8 value, bool final) { std::lock_guard lock(((BusARM9 *)bus)->shared->ioMutex); ((BusARM9 *)bus)->ipc->writeIO9(address, value, final); },
+		.write32 = [](void *bus, u32 address, u32 value, bool final) { std::lock_guard lock(((BusARM9 *)bus)->shared->ioMutex); ((BusARM9 *)bus)->ipc->send9(value); }});
+	io.add(0x4100000, 0x4100003, {.object = this,
+		.read8 = [](void *bus, u32 address, bool final) { std::lock_guard lock(((BusARM9 *)bus)->shared->ioMutex); return ((BusARM9 *)bus)->ipc->readIO9(address, final); },
+		.read32 = [](void *bus, u32 address, bool final) { std::lock_guard lock(((BusARM9 *)bus)->shared->ioMutex); return ((BusARM9 *)bus)->ipc->receive9(); }});
+
+	IoTable::Handler ppuIo = {.object = ppu.get(),
+		.read8 = [](void *ppu, u32 address, bool final) { return ((PPU *)ppu)->readIO9(address); },
+		.write8 = [](void *ppu, u32 address, u8 value, bool final) { ((PPU *)ppu)->writeIO9(address, value); }};
+	io.add(0x4000000, 0x400006F, ppuIo);
+	io.add(0x4000304, 0x4000307, ppuIo);
+	io.add(0x4001000, 0x400106F, ppuIo);
+	io.addRegisters<ppuEngineRegisters>(&ppu->engineA, 0);
+	io.addRegisters<ppuEngineRegisters>(&ppu->engineB, 0x1000);
+	// Bank changes also change what the ARM7 sees at 0x6000000 and in VRAMSTAT
+	IoTable::Handler vramcntIo = {.object = this,
+		.write8 = [](void *bus, u32 address, u8 value, bool final) { std::lock_guard lock(((BusARM9 *)bus)->shared->ioMutex); ((BusARM9 *)bus)->ppu->writeIO9(address, value); }};
+	io.add(0x4000240, 0x4000246, vramcntIo); // VRAMCNT is write only
+	io.add(0x4000248, 0x4000249, vramcntIo);
+
+	IoTable::Handler gamecardIo = {.object = this,
+		.read8 = [](void *bus, u32 address, bool final) { std::lock_guard lock(((BusARM9 *)bus)->shared->ioMutex); return ((BusARM9 *)bus)->gamecard->readIO9(address, final); },
+		.write8 = [](void *bus, u32 address, u8 value, bool final) { std::lock_guard lock(((BusARM9 *)bus)->shared->ioMutex); ((BusARM9 *)bus)->gamecard->writeIO9(address, value); }};
+	io.add(0x40001A0, 0x40001BB, gamecardIo);
+	io.add(0x4100010, 0x4100014, gamecardIo);
+
+	io.addRegisters<dma9Registers>(static_cast<DmaRegisters *>(dma.get()), 0);
+	io.add(0x4000100, 0x400010F, {.object = timer.get(),
+		.read8 = [](void *timer, u32 address, bool final) { return ((Timer *)timer)->readIO(address); },
+		.write8 = [](void *timer, u32 address, u8 value, bool final) { ((Timer *)timer)->writeIO(address, value); }});
+	io.add(0x4000280, 0x40002BF, {.object = dsmath.get(),
+		.read8 = [](void *dsmath, u32 address, bool final) { return ((DSMath *)dsmath)->readIO9(address, final); },
+		.write8 = [](void *dsmath, u32 address, u8 value, bool final) { ((DSMath *)dsmath)->writeIO9(address, value, final); }});
+
+	// Events
+	auto irqEvent = [](void *bus, int type) { ((BusARM9 *)bus)->requestInterrupt((InterruptType)type); };
+	shared->registerEvent(IPC_SYNC9, irqEvent, this, INT_IPC_SYNC);
+	shared->registerEvent(IPC_SEND_FIFO9, irqEvent, this, INT_IPC_SEND_FIFO);
+	shared->registerEvent(IPC_RECV_FIFO9, irqEvent, this, INT_IPC_RECV_FIFO);
+	for (int i = 0; i < 4; i++)
+		shared->registerEvent(timer->overflowEvent(i), timerEvent, this, i);
 }
 
 BusARM9::~BusARM9() {
@@ -50,6 +122,8 @@ BusARM9::~BusARM9() {
 
 void BusARM9::reset() {
 	delay = 0;
+	idleLoop.reset();
+	fetchPage = FETCH_NONE;
 
 	IME = false;
 	IE = IF = 0;
@@ -62,6 +136,64 @@ void BusARM9::reset() {
 	dsmath->reset();
 	timer->reset();
 	cpu->resetARM946E();
+	refreshTcmPages();
+}
+
+void BusARM9::saveState(StateWriter &state) {
+	state.beginChunk("BUS9", 1);
+	state.write(IME);
+	state.write(IE);
+	state.write(IF);
+	state.write(POSTFLG);
+	state.write(delay);
+	state.endChunk();
+
+	// The pipeline isn't saved. NDS::loadState() refills it from R15 once all of memory is back.
+	state.beginChunk("CPU9", 1);
+	state.write(cpu->reg);
+	state.write<bool>(cpu->cp15.halted);
+	state.write<u32>(cpu->cp15.control);
+	state.write<u32>(cpu->cp15.dtcmConfig);
+	state.write<u32>(cpu->cp15.itcmConfig);
+	state.writeBytes(itcm, 0x8000);
+	state.writeBytes(dtcm, 0x4000);
+	state.endChunk();
+
+	dma->saveState(state);
+	timer->saveState(state);
+	dsmath->saveState(state);
+}
+
+void BusARM9::loadState(StateReader &state) {
+	state.beginChunk("BUS9", 1);
+	state.read(IME);
+	state.read(IE);
+	state.read(IF);
+	state.read(POSTFLG);
+	state.read(delay);
+	state.endChunk();
+
+	state.beginChunk("CPU9", 1);
+	state.read(cpu->reg);
+	cpu->cp15.halted = state.read<bool>();
+	u32 control = state.read<u32>();
+	u32 dtcmConfig = state.read<u32>();
+	u32 itcmConfig = state.read<u32>();
+	state.readBytes(itcm, 0x8000);
+	state.readBytes(dtcm, 0x4000);
+	state.endChunk();
+
+	// Go through the normal register writes so everything derived from them gets recalculated
+	coprocessorWrite(15, 0, 1, 0, 0, control);
+	coprocessorWrite(15, 0, 9, 1, 0, dtcmConfig);
+	coprocessorWrite(15, 0, 9, 1, 1, itcmConfig);
+
+	dma->loadState(state);
+	timer->loadState(state);
+	dsmath->loadState(state);
+
+	idleLoop.reset();
+	refreshInterrupts();
 }
 
 void BusARM9::requestInterrupt(InterruptType type) {
@@ -70,6 +202,13 @@ void BusARM9::requestInterrupt(InterruptType type) {
 	refreshInterrupts();
 }
 
+void BusARM9::timerEvent(void *bus, int channel) {
+	auto self = (BusARM9 *)bus;
+	u8 irqMask = self->timer->checkOverflow(channel);
+	if (irqMask)
+		self->requestInterrupt((InterruptType)(irqMask * INT_TIMER_0));
+}
+
 void BusARM9::refreshInterrupts() {
 	if (IME && (IE & IF)) {
 		cpu->processIrq = true;
@@ -79,6 +218,8 @@ void BusARM9::refreshInterrupts() {
 }
 
 void BusARM9::refreshWramPages() {
+	unmapTcm();
+
 	// Set the first two pages in one table
 	switch (shared->WRAMCNT) { // > ARM9/ARM7 (0-3 = 32K/0K, 2nd 16K/1st 16K, 1st 16K/2nd 16K, 0K/32K)
 	case 0:
@@ -101,12 +242,18 @@ void BusARM9::refreshWramPages() {
 
 	// Mirror it across the full 16MB in all tables
 	for (int i = toPage(0x3000000); i < toPage(0x4000000); i += 2) {
-		readTable[i] = readTable8[i] = writeTable[i] = readTable[toPage(0x3000000)];
-		readTable[i + 1] = readTable8[i + 1] = writeTable[i + 1] = readTable[toPage(0x3004000)];
+		readTable[i] = readTable8[i] = writeTable[i] = codeTable[i] = readTable[toPage(0x3000000)];
+		readTable[i + 1] = readTable8[i + 1] = writeTable[i + 1] = codeTable[i + 1] = readTable[toPage(0x3004000)];
 	}
+
+	mapTcm();
+	fetchPage = FETCH_NONE;
+	fastmem.remap(readTable, writeTable);
 }
 
 void BusARM9::refreshVramPages() {
+	unmapTcm();
+
 	// Clear the VRAM section of the table
 	for (int i = toPage(0x6000000); i < toPage(0x7000000); i++)
 		readTable[i] = NULL;
@@ -155,13 +302,88 @@ void BusARM9::refreshVramPages() {
 
 	// readTable and writeTable will always be the same for VRAM
 	for (int i = toPage(0x6000000); i < toPage(0x7000000); i++)
-		writeTable[i] = readTable[i];
+		writeTable[i] = codeTable[i] = readTable[i];
+
+	mapTcm();
+	fetchPage = FETCH_NONE;
+	fastmem.remap(readTable, writeTable);
 }
 
 void BusARM9::refreshRomPages() {
 	//
 }
 
+void BusARM9::refreshTcmPages() {
+	unmapTcm();
+	mapTcm();
+	fetchPage = FETCH_NONE;
+	fastmem.remap(readTable, writeTable);
+}
+
+// The cache holds a pointer to memory, not decoded instructions, so writes to the page show up on their own.
+// Only changing what the page points to (a table refresh) has to drop it.
+void BusARM9::setFetchPage(u32 address, u8 *pagePointer) {
+	fetchPage = address >> 14;
+	fetchPointer = pagePointer;
+}
+
+// ITCM takes priority over DTCM, and a write-only TCM still takes writes while reads see the memory under it
+void BusARM9::mapTcm() {
+	auto& cp15 = cpu->cp15;
+	u64 itcmEnd = cp15.itcmEnable ? std::min<u64>(cp15.itcmEnd, 0x10000000) : 0;
+	u64 dtcmStart = cp15.dtcmEnable ? std::min<u64>(cp15.dtcmStart, 0x10000000) : 0;
+	u64 dtcmEnd = cp15.dtcmEnable ? std::min<u64>(cp15.dtcmEnd, 0x10000000) : 0;
+
+	auto coverage = [](u32 page, u64 start, u64 end) { // 0 = none, 1 = part, 2 = all
+		u64 pageStart = toAddress(page);
+		u64 pageEnd = pageStart + 0x4000;
+		if ((start >= pageEnd) || (end <= pageStart))
+			return 0;
+		return ((start <= pageStart) && (end >= pageEnd)) ? 2 : 1;
+	};
+	auto mapPage = [&](u32 page) {
+		TcmPage original = {page, readTable[page], readTable8[page], writeTable[page], codeTable[page]};
+		tcmPages.push_back(original);
+
+		int itcmCoverage = coverage(page, 0, itcmEnd);
+		int dtcmCoverage = coverage(page, dtcmStart, dtcmEnd);
+		if ((itcmCoverage == 1) || (dtcmCoverage == 1)) {
+			partialTcmPages.push_back(original);
+			readTable[page] = readTable8[page] = writeTable[page] = codeTable[page] = NULL;
+			return;
+		}
+
+		u8 *itcmPage = itcm + (toAddress(page) & 0x7FFF);
+		if (dtcmCoverage) {
+			writeTable[page] = dtcm;
+			if (!cp15.dtcmWriteOnly)
+				readTable[page] = readTable8[page] = dtcm; // Can't be executed from, so codeTable keeps the memory under it
+		}
+		if (itcmCoverage) {
+			writeTable[page] = itcmPage;
+			if (!cp15.itcmWriteOnly)
+				readTable[page] = readTable8[page] = codeTable[page] = itcmPage;
+		}
+	};
+
+	u32 itcmPages = toPage(itcmEnd + 0x3FFF);
+	for (u32 page = 0; page < itcmPages; page++)
+		mapPage(page);
+	for (u32 page = std::max(toPage(dtcmStart), itcmPages); page < toPage(dtcmEnd + 0x3FFF); page++)
+		mapPage(page);
+}
+
+void BusARM9::unmapTcm() {
+	for (auto& original : tcmPages) {
+		readTable[original.page] = original.read;
+		readTable8[original.page] = original.read8;
+		writeTable[original.page] = original.write;
+		codeTable[original.page] = original.code;
+	}
+	tcmPages.clear();
+	partialTcmPages.clear();
+}
+
 void BusARM9::hacf() {
 	shared->addEvent(0, EventType::STOP);
 }
@@ -169,59 +391,80 @@ void BusARM9::hacf() {
 template <typename T, bool code>
 T BusARM9::read(u32 address, bool sequential) {
 	u32 alignedAddress = address & ~(sizeof(T) - 1);
+	T val = 0;
+
+	// Sequential fetches almost always land on the same page as the last one
+	if constexpr (code) {
+		if ((alignedAddress >> 14) == fetchPage) [[likely]] {
+			val = GuestMemory::load<T>(fetchPointer + (alignedAddress & 0x3FFF));
+			return val;
+		}
+	}
+
 	u32 page = toPage(alignedAddress & 0x0FFFFFFF);
 	u32 offset = alignedAddress & 0x3FFF;
 
-	// TCM
-	T val = 0;
-	if (cpu->cp15.itcmEnable && !cpu->cp15.itcmWriteOnly && (address < cpu->cp15.itcmEnd)) {
-		memcpy(&val, &cpu->cp15.itcm[alignedAddress & 0x7FFF], sizeof(T));
-		return val;
-	} else if (!code && cpu->cp15.dtcmEnable && !cpu->cp15.dtcmWriteOnly && (address >= cpu->cp15.dtcmStart) && (address < cpu->cp15.dtcmEnd)) {
-		memcpy(&val, &cpu->cp15.dtcm[alignedAddress & 0x3FFF], sizeof(T));
+	// Fastmem follows readTable, which has DTCM in it, so instruction fetches always use codeTable
+	if (!code && fastmem.base && Fastmem::covers(address, (sizeof(T) == 1) ? fastmemRegions8 : fastmemRegions) && fastmem.read(alignedAddress, val)) [[likely]]
 		return val;
-	}
 
 	u8 *ptr;
-	if constexpr (sizeof(T) == 1) {
+	if constexpr (code) {
+		ptr = codeTable[page];
+	} else if constexpr (sizeof(T) == 1) {
 		ptr = readTable8[page];
 	} else {
 		ptr = readTable[page];
 	}
 
 	if ((address < 0x10000000) && (ptr != NULL)) { [[likely]]
-		memcpy(&val, ptr + offset, sizeof(T));
+		val = GuestMemory::load<T>(ptr + offset);
+		if constexpr (code)
+			setFetchPage(alignedAddress, ptr);
 	} else {
+		// TCM that only covers part of a page, or is above 0x10000000, isn't in the tables
+		if (cpu->cp15.itcmEnable && !cpu->cp15.itcmWriteOnly && (address < cpu->cp15.itcmEnd)) {
+			memcpy(&val, &itcm[alignedAddress & 0x7FFF], sizeof(T));
+			return val;
+		} else if (!code && cpu->cp15.dtcmEnable && !cpu->cp15.dtcmWriteOnly && (address >= cpu->cp15.dtcmStart) && (address < cpu->cp15.dtcmEnd)) {
+			memcpy(&val, &dtcm[alignedAddress & 0x3FFF], sizeof(T));
+			return val;
+		}
+		if (!partialTcmPages.empty() && (address < 0x10000000)) [[unlikely]] {
+			for (auto& partial : partialTcmPages) {
+				if (partial.page == page) {
+					ptr = code ? partial.code : ((sizeof(T) == 1) ? partial.read8 : partial.read);
+					break;
+				}
+			}
+			if (ptr) {
+				val = GuestMemory::load<T>(ptr + offset);
+				return val;
+			}
+		}
+
+		if (!code && idleLoop.active)
+			idleLoop.read(alignedAddress);
+
 		switch (address) {
 		case 0x4000000 ... 0x4FFFFFF: // ARM9 I/O Ports
-			if constexpr (sizeof(T) == 4) {
-				val |= (readIO(alignedAddress | 0, false) << 0);
-				val |= (readIO(alignedAddress | 1, false) << 8);
-				val |= (readIO(alignedAddress | 2, false) << 16);
-				val |= (readIO(alignedAddress | 3, true) << 24);
-			} else if constexpr (sizeof(T) == 2) {
-				val |= (readIO(alignedAddress | 0, false) << 0);
-				val |= (readIO(alignedAddress | 1, true) << 8);
-			} else {
-				val = readIO(alignedAddress, true);
-			}
+			val = io.read<T>(alignedAddress, true);
 			break;
 		case 0x5000000 ... 0x5FFFFFF: // PRAM
 			memcpy(&val, ppu->pram + (alignedAddress & 0x7FF), sizeof(T));
 			break;
 		case 0x6000000 ... 0x67FFFFF: { // VRAM fallback
 			PPU::VramInfoEntry entry = ppu->vramInfoTable[toPage(alignedAddress - 0x6000000)];
-			T tmpVal = 0;
-
-			if (entry.enableA) { memcpy(&tmpVal, ppu->vramA + (entry.bankA * 0x4000) + offset, sizeof(T)); val |= tmpVal; }
-			if (entry.enableB) { memcpy(&tmpVal, ppu->vramB + (entry.bankB * 0x4000) + offset, sizeof(T)); val |= tmpVal; }
-			if (entry.enableC) { memcpy(&tmpVal, ppu->vramC + (entry.bankC * 0x4000) + offset, sizeof(T)); val |= tmpVal; }
-			if (entry.enableD) { memcpy(&tmpVal, ppu->vramD + (entry.bankD * 0x4000) + offset, sizeof(T)); val |= tmpVal; }
-			if (entry.enableE) { memcpy(&tmpVal, ppu->vramE + (entry.bankE * 0x4000) + offset, sizeof(T)); val |= tmpVal; }
-			if (entry.enableF) { memcpy(&tmpVal, ppu->vramF + offset, sizeof(T)); val |= tmpVal; }
-			if (entry.enableG) { memcpy(&tmpVal, ppu->vramG + offset, sizeof(T)); val |= tmpVal; }
-			if (entry.enableH) { memcpy(&tmpVal, ppu->vramH + (entry.bankH * 0x4000) + offset, sizeof(T)); val |= tmpVal; }
-			if (entry.enableI) { memcpy(&tmpVal, ppu->vramI + offset, sizeof(T)); val |= tmpVal; }
+
+			if (entry.enableA) val |= GuestMemory::load<T>(ppu->vramA + (entry.bankA * 0x4000) + offset);
+			if (entry.enableB) val |= GuestMemory::load<T>(ppu->vramB + (entry.bankB * 0x4000) + offset);
+			if (entry.enableC) val |= GuestMemory::load<T>(ppu->vramC + (entry.bankC * 0x4000) + offset);
+			if (entry.enableD) val |= GuestMemory::load<T>(ppu->vramD + (entry.bankD * 0x4000) + offset);
+			if (entry.enableE) val |= GuestMemory::load<T>(ppu->vramE + (entry.bankE * 0x4000) + offset);
+			if (entry.enableF) val |= GuestMemory::load<T>(ppu->vramF + offset);
+			if (entry.enableG) val |= GuestMemory::load<T>(ppu->vramG + offset);
+			if (entry.enableH) val |= GuestMemory::load<T>(ppu->vramH + (entry.bankH * 0x4000) + offset);
+			if (entry.enableI) val |= GuestMemory::load<T>(ppu->vramI + offset);
 			} break;
 		case 0x7000000 ... 0x7FFFFFF: // OAM
 			memcpy(&val, ppu->oam + (alignedAddress & 0x7FF), sizeof(T));
@@ -235,9 +478,12 @@ T BusARM9::read(u32 address, bool sequential) {
 			break;
 		case 0xFFFF0000 ... 0xFFFFFFFF: // ARM9-BIOS
 			memcpy(&val, bios + (alignedAddress - 0xFFFF0000), sizeof(T));
+			if (code && (alignedAddress < 0xFFFF8000)) // Interrupt handlers run from here
+				setFetchPage(alignedAddress, bios + ((alignedAddress - 0xFFFF0000) & ~0x3FFF));
 			break;
 		default:
-			shared->log << fmt::format("[NDS9 Bus] Read from unknown location 0x{:0>8X}\n", address);
+			if constexpr (Instrumentation::logging)
+				shared->log << fmt::format("[NDS9 Bus] Read from unknown location 0x{:0>8X}\n", address);
 			break;
 		}
 	}
@@ -255,37 +501,47 @@ void BusARM9::write(u32 address, T value, bool sequential) {
 	u32 alignedAddress = address & ~(sizeof(T) - 1);
 	u32 page = toPage(alignedAddress & 0x0FFFFFFF);
 	u32 offset = alignedAddress & 0x3FFF;
-	u8 *ptr = readTable[page];
+	u8 *ptr = writeTable[page];
 
 	//if (address == 0x21FEEB8) {
 	//	printf("test\n");
 	//}
 
-	// TCM
-	if (cpu->cp15.itcmEnable && (address < cpu->cp15.itcmEnd)) {
-		memcpy(&cpu->cp15.itcm[alignedAddress & 0x7FFF], &value, sizeof(T));
-		return;
-	} else if (cpu->cp15.dtcmEnable && (address >= cpu->cp15.dtcmStart) && (address < cpu->cp15.dtcmEnd)) {
-		memcpy(&cpu->cp15.dtcm[alignedAddress & 0x3FFF], &value, sizeof(T));
+	if (idleLoop.active)
+		idleLoop.write();
+	if ((address >= 0x2000000) && (address < 0x4000000)) // PSRAM and shared WRAM
+		BusShared::requestWake(shared->wakeArm7);
+
+	if (fastmem.base && Fastmem::covers(address, fastmemRegions) && fastmem.write(alignedAddress, value)) [[likely]]
 		return;
-	}
 
 	if ((address < 0x10000000) && (ptr != NULL)) { [[likely]]
-		memcpy(ptr + offset, &value, sizeof(T));
+		GuestMemory::store<T>(ptr + offset, value);
 	} else {
+		// TCM that only covers part of a page, or is above 0x10000000, isn't in the tables
+		if (cpu->cp15.itcmEnable && (address < cpu->cp15.itcmEnd)) {
+			memcpy(&itcm[alignedAddress & 0x7FFF], &value, sizeof(T));
+			return;
+		} else if (cpu->cp15.dtcmEnable && (address >= cpu->cp15.dtcmStart) && (address < cpu->cp15.dtcmEnd)) {
+			memcpy(&dtcm[alignedAddress & 0x3FFF], &value, sizeof(T));
+			return;
+		}
+		if (!partialTcmPages.empty() && (address < 0x10000000)) [[unlikely]] {
+			for (auto& partial : partialTcmPages) {
+				if (partial.page == page) {
+					ptr = partial.write;
+					break;
+				}
+			}
+			if (ptr) {
+				GuestMemory::store<T>(ptr + offset, value);
+				return;
+			}
+		}
+
 		switch (address) {
 		case 0x4000000 ... 0x4FFFFFF: // NDS9 I/O Ports
-			if constexpr (sizeof(T) == 4) {
-				writeIO(alignedAddress | 0, (u8)(value >> 0), false);
-				writeIO(alignedAddress | 1, (u8)(value >> 8), false);
-				writeIO(alignedAddress | 2, (u8)(value >> 16), false);
-				writeIO(alignedAddress | 3, (u8)(value >> 24), true);
-			} else if constexpr (sizeof(T) == 2) {
-				writeIO(alignedAddress | 0, (u8)(value >> 0), false);
-				writeIO(alignedAddress | 1, (u8)(value >> 8), true);
-			} else {
-				writeIO(alignedAddress, value, true);
-			}
+			io.write<T>(alignedAddress, value, true);
 			break;
 		case 0x5000000 ... 0x5FFFFFF: // PRAM
 			memcpy(ppu->pram + (alignedAddress & 0x7FF), &value, sizeof(T));
@@ -293,21 +549,22 @@ void BusARM9::write(u32 address, T value, bool sequential) {
 		case 0x6000000 ... 0x67FFFFF: { // VRAM fallback
 			PPU::VramInfoEntry entry = ppu->vramInfoTable[toPage(alignedAddress - 0x6000000)];
 
-			if (entry.enableA) memcpy(ppu->vramA + (entry.bankA * 0x4000) + offset, &value, sizeof(T));
-			if (entry.enableB) memcpy(ppu->vramB + (entry.bankB * 0x4000) + offset, &value, sizeof(T));
-			if (entry.enableC) memcpy(ppu->vramC + (entry.bankC * 0x4000) + offset, &value, sizeof(T));
-			if (entry.enableD) memcpy(ppu->vramD + (entry.bankD * 0x4000) + offset, &value, sizeof(T));
-			if (entry.enableE) memcpy(ppu->vramE + (entry.bankE * 0x4000) + offset, &value, sizeof(T));
-			if (entry.enableF) memcpy(ppu->vramF + offset, &value, sizeof(T));
-			if (entry.enableG) memcpy(ppu->vramG + offset, &value, sizeof(T));
-			if (entry.enableH) memcpy(ppu->vramH + (entry.bankH * 0x4000) + offset, &value, sizeof(T));
-			if (entry.enableI) memcpy(ppu->vramI + offset, &value, sizeof(T));
+			if (entry.enableA) GuestMemory::store<T>(ppu->vramA + (entry.bankA * 0x4000) + offset, value);
+			if (entry.enableB) GuestMemory::store<T>(ppu->vramB + (entry.bankB * 0x4000) + offset, value);
+			if (entry.enableC) GuestMemory::store<T>(ppu->vramC + (entry.bankC * 0x4000) + offset, value);
+			if (entry.enableD) GuestMemory::store<T>(ppu->vramD + (entry.bankD * 0x4000) + offset, value);
+			if (entry.enableE) GuestMemory::store<T>(ppu->vramE + (entry.bankE * 0x4000) + offset, value);
+			if (entry.enableF) GuestMemory::store<T>(ppu->vramF + offset, value);
+			if (entry.enableG) GuestMemory::store<T>(ppu->vramG + offset, value);
+			if (entry.enableH) GuestMemory::store<T>(ppu->vramH + (entry.bankH * 0x4000) + offset, value);
+			if (entry.enableI) GuestMemory::store<T>(ppu->vramI + offset, value);
 			} break;
 		case 0x7000000 ... 0x7FFFFFF: // OAM
 			memcpy(ppu->oam + (alignedAddress & 0x7FF), &value, sizeof(T));
 			break;
 		default:
-			shared->log << fmt::format("[NDS9 Bus] Write to unknown location 0x{:0>8X} with {} byte value 0x{:0>{}X}\n", address, sizeof(T), value, sizeof(T) * 2);
+			if constexpr (Instrumentation::logging)
+				shared->log << fmt::format("[NDS9 Bus] Write to unknown location 0x{:0>8X} with {} byte value 0x{:0>{}X}\n", address, sizeof(T), value, sizeof(T) * 2);
 			break;
 		}
 	}
@@ -324,35 +581,9 @@ void BusARM9::breakpoint() {
 	shared->addEvent(0, EventType::STOP);
 }
 
+// Registers the bus owns, and anything io doesn't have a handler for. Components are reached through io.
 u8 BusARM9::readIO(u32 address, bool final) {
 	switch (address) {
-	case 0x4000130 ... 0x4000137:
-	case 0x4000204: case 0x4000205:
-	case 0x4000247:
-		return shared->readIO9(address);
-
-	case 0x4000180 ... 0x4000187:
-	case 0x4100000 ... 0x4100003:
-		return ipc->readIO9(address, final);
-
-	case 0x4000000 ... 0x400006F:
-	case 0x4000304 ... 0x4000307:
-	case 0x4001000 ... 0x400106F:
-		return ppu->readIO9(address);
-
-	case 0x40001A0 ... 0x40001BB:
-	case 0x4100010 ... 0x4100014:
-		return gamecard->readIO9(address, final);
-
-	case 0x40000B0 ... 0x40000EF:
-		return dma->readIO9(address);
-
-	case 0x4000100 ... 0x400010F:
-		return timer->readIO(address);
-
-	case 0x4000280 ... 0x40002BF:
-		return dsmath->readIO9(address, final);
-
 	case 0x4000208:
 		return (u8)IME;
 	case 0x4000209 ... 0x400020B:
@@ -377,49 +608,14 @@ u8 BusARM9::readIO(u32 address, bool final) {
 		return POSTFLG;
 
 	default:
-		shared->log << fmt::format("[NDS9 Bus] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS9 Bus] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 }
 
 void BusARM9::writeIO(u32 address, u8 value, bool final) {
 	switch (address) {
-	case 0x4000130 ... 0x4000137:
-	case 0x4000204: case 0x4000205:
-	case 0x4000247:
-		shared->writeIO9(address, value);
-		break;
-
-	case 0x4000180 ... 0x400018B:
-		ipc->writeIO9(address, value, final);
-		break;
-
-	case 0x4000000 ... 0x400006F:
-	case 0x4000240 ... 0x4000246:
-	case 0x4000248:
-	case 0x4000249:
-	case 0x4000304 ... 0x4000307:
-	case 0x4001000 ... 0x400106F:
-		ppu->writeIO9(address, value);
-		break;
-
-	case 0x40001A0 ... 0x40001BB:
-	case 0x4100010 ... 0x4100014:
-		gamecard->writeIO9(address, value);
-		break;
-
-	case 0x40000B0 ... 0x40000EF:
-		dma->writeIO9(address, value);
-		break;
-
-	case 0x4000100 ... 0x400010F:
-		timer->writeIO(address, value);
-		break;
-
-	case 0x4000280 ... 0x40002BF:
-		dsmath->writeIO9(address, value, final);
-		break;
-
 	case 0x4000208:
 		IME = value & 1;
 		refreshInterrupts();
@@ -463,9 +659,35 @@ void BusARM9::writeIO(u32 address, u8 value, bool final) {
 		break;
 
 	default:
-		shared->log << fmt::format("[NDS9 Bus] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS9 Bus] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		break;
+	}
+}
+
+u32 BusARM9::readIO32(u32 address) {
+	switch (address) {
+	case 0x4000208: return IME;
+	case 0x4000210: return IE;
+	case 0x4000214: return IF;
+	default: return 0;
+	}
+}
+
+// Interrupt handlers acknowledge with a word write to IF, so only refresh once
+void BusARM9::writeIO32(u32 address, u32 value) {
+	switch (address) {
+	case 0x4000208:
+		IME = value & 1;
+		break;
+	case 0x4000210:
+		IE = value & 0x003F3F7F;
+		break;
+	case 0x4000214:
+		IF &= ~value;
 		break;
 	}
+	refreshInterrupts();
 }
 
 u32 BusARM9::coprocessorRead(u32 copNum, u32 copOpc, u32 copSrcDestReg, u32 copOpReg, u32 copOpcType) {
@@ -536,6 +758,7 @@ void BusARM9::coprocessorWrite(u32 copNum, u32 copOpc, u32 copSrcDestReg, u32 co
 			break;
 
 		cpu->cp15.control = (value & 0xFF085) | 0x00000078;
+		refreshTcmPages(); // Has the TCM enable bits
 		return;
 	case 2:
 	case 3:
@@ -558,6 +781,7 @@ void BusARM9::coprocessorWrite(u32 copNum, u32 copOpc, u32 copSrcDestReg, u32 co
 
 				cpu->cp15.itcmEnd = 512 << cpu->cp15.itcmVirtualSize;
 			}
+			refreshTcmPages();
 		}
 		return; // I hate crt0
 	}
@@ -17,6 +17,36 @@ void DSMath::reset() {
 	divFinishTimestamp = sqrtFinishTimestamp = 0;
 }
 
+void DSMath::saveState(StateWriter &state) {
+	state.beginChunk("MATH", 1);
+	state.write(DIVCNT);
+	state.write(DIV_NUMER);
+	state.write(DIV_DENOM);
+	state.write(DIV_RESULT);
+	state.write(DIVREM_RESULT);
+	state.write(SQRTCNT);
+	state.write(SQRT_RESULT);
+	state.write(SQRT_PARAM);
+	state.write(divFinishTimestamp);
+	state.write(sqrtFinishTimestamp);
+	state.endChunk();
+}
+
+void DSMath::loadState(StateReader &state) {
+	state.beginChunk("MATH", 1);
+	state.read(DIVCNT);
+	state.read(DIV_NUMER);
+	state.read(DIV_DENOM);
+	state.read(DIV_RESULT);
+	state.read(DIVREM_RESULT);
+	state.read(SQRTCNT);
+	state.read(SQRT_RESULT);
+	state.read(SQRT_PARAM);
+	state.read(divFinishTimestamp);
+	state.read(sqrtFinishTimestamp);
+	state.endChunk();
+}
+
 u8 DSMath::readIO9(u32 address, bool final) {
 	switch (address) {
 	case 0x4000280:
@@ -126,7 +156,8 @@ u8 DSMath::readIO9(u32 address, bool final) {
 	case 0x40002BF:
 		return (u8)(SQRT_PARAM >> 56);
 	default:
-		shared->log << fmt::format("[NDS9 Bus][DSMath] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS9 Bus][DSMath] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 }
@@ -216,7 +247,8 @@ void DSMath::writeIO9(u32 address, u8 value, bool final) {
 		SQRT_PARAM = (SQRT_PARAM & 0x00FFFFFFFFFFFFFF) | ((u64)value << 56);
 		break;
 	default:
-		shared->log << fmt::format("[NDS9 Bus][DSMath] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS9 Bus][DSMath] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
 		break;
 	}
 
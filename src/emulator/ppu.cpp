@@ -3,14 +3,15 @@
 #include <cmath>
 
 #define convertColor(x) ((x) | 0x8000)
-#define VRAM_SIZE ((128 + 128 + 128 + 128 + 64 + 16 + 16 + 32 + 16) * 1024)
 
 static constexpr u32 toPage(u32 address) {
 	return address >> 14; // Pages are 16KB
 }
 
+static_assert(GuestMemory::layout[GuestMemory::VRAM].size == VRAM_SIZE);
+
 PPU::PPU(std::shared_ptr<BusShared> shared) : shared(shared) {
-	vramAll = new u8[VRAM_SIZE];
+	vramAll = shared->memory[GuestMemory::VRAM];
 	vramA = vramAll; // 128KB
 	vramB = vramA + 0x20000; // 128KB
 	vramC = vramB + 0x20000; // 128KB
@@ -20,10 +21,12 @@ PPU::PPU(std::shared_ptr<BusShared> shared) : shared(shared) {
 	vramG = vramF + 0x4000; // 16KB
 	vramH = vramG + 0x4000; // 32KB
 	vramI = vramH + 0x8000; // 16KB
+
+	hideFrames = false;
 }
 
 PPU::~PPU() {
-	delete[] vramAll;
+	//
 }
 
 void PPU::reset() {
@@ -80,13 +83,80 @@ void PPU::reset() {
 	shared->addEvent(3072, EventType::PPU_HBLANK);
 }
 
+void PPU::saveState(StateWriter &state) {
+	state.beginChunk("PPU ", 1);
+	state.write(frameCounter);
+	state.write(framebufferA);
+	state.write(framebufferB);
+	state.write(vBlankIrq9);
+	state.write(hBlankIrq9);
+	state.write(vCounterIrq9);
+	state.write(vBlankIrq7);
+	state.write(hBlankIrq7);
+	state.write(vCounterIrq7);
+	state.write(pram);
+	state.write(oam);
+	state.writeBytes(vramAll, VRAM_SIZE);
+	state.write(engineA);
+	state.write(engineB);
+	state.write(DISPSTAT9);
+	state.write(DISPSTAT7);
+	state.write(VCOUNT);
+	state.write(VRAMSTAT);
+	state.write(VRAMCNT_A);
+	state.write(VRAMCNT_B);
+	state.write(VRAMCNT_C);
+	state.write(VRAMCNT_D);
+	state.write(VRAMCNT_E);
+	state.write(VRAMCNT_F);
+	state.write(VRAMCNT_G);
+	state.write(VRAMCNT_H);
+	state.write(VRAMCNT_I);
+	state.write(POWCNT1);
+	state.endChunk();
+}
+
+void PPU::loadState(StateReader &state) {
+	state.beginChunk("PPU ", 1);
+	state.read(frameCounter);
+	state.read(framebufferA);
+	state.read(framebufferB);
+	state.read(vBlankIrq9);
+	state.read(hBlankIrq9);
+	state.read(vCounterIrq9);
+	state.read(vBlankIrq7);
+	state.read(hBlankIrq7);
+	state.read(vCounterIrq7);
+	state.read(pram);
+	state.read(oam);
+	state.readBytes(vramAll, VRAM_SIZE);
+	state.read(engineA);
+	state.read(engineB);
+	state.read(DISPSTAT9);
+	state.read(DISPSTAT7);
+	state.read(VCOUNT);
+	state.read(VRAMSTAT);
+	state.read(VRAMCNT_A);
+	state.read(VRAMCNT_B);
+	state.read(VRAMCNT_C);
+	state.read(VRAMCNT_D);
+	state.read(VRAMCNT_E);
+	state.read(VRAMCNT_F);
+	state.read(VRAMCNT_G);
+	state.read(VRAMCNT_H);
+	state.read(VRAMCNT_I);
+	state.read(POWCNT1);
+	state.endChunk();
+}
+
 void PPU::lineStart() {
 	shared->addEvent(4260, EventType::PPU_LINE_START);
 
 	++currentScanline;
 	switch (currentScanline) {
 	case 192: // VBlank
-		updateScreen = true;
+		if (!hideFrames)
+			updateScreen = true;
 		vBlankFlag9 = vBlankFlag7 = true;
 
 		if (vBlankIrqEnable9)
@@ -1034,34 +1104,6 @@ u8 PPU::readIO9(u32 address) {
 		return (u8)VCOUNT;
 	case 0x4000007:
 		return (u8)(VCOUNT >> 8);
-	case 0x4000008:
-		return (u8)engineA.bg[0].BGCNT;
-	case 0x4000009:
-		return (u8)(engineA.bg[0].BGCNT >> 8);
-	case 0x400000A:
-		return (u8)engineA.bg[1].BGCNT;
-	case 0x400000B:
-		return (u8)(engineA.bg[1].BGCNT >> 8);
-	case 0x400000C:
-		return (u8)engineA.bg[2].BGCNT;
-	case 0x400000D:
-		return (u8)(engineA.bg[2].BGCNT >> 8);
-	case 0x400000E:
-		return (u8)engineA.bg[3].BGCNT;
-	case 0x400000F:
-		return (u8)(engineA.bg[3].BGCNT >> 8);
-	case 0x4000048:
-		return (u8)engineA.WININ;
-	case 0x4000049:
-		return (u8)(engineA.WININ >> 8);
-	case 0x400004A:
-		return (u8)engineA.WINOUT;
-	case 0x400004B:
-		return (u8)(engineA.WINOUT >> 8);
-	case 0x400006C:
-		return (u8)engineA.MASTER_BRIGHT;
-	case 0x400006D:
-		return (u8)(engineA.MASTER_BRIGHT >> 8);
 	case 0x400006E:
 	case 0x400006F:
 		return 0;
@@ -1080,39 +1122,12 @@ u8 PPU::readIO9(u32 address) {
 		return (u8)(engineB.DISPCNT >> 16);
 	case 0x4001003:
 		return (u8)(engineB.DISPCNT >> 24);
-	case 0x4001008:
-		return (u8)engineB.bg[0].BGCNT;
-	case 0x4001009:
-		return (u8)(engineB.bg[0].BGCNT >> 8);
-	case 0x400100A:
-		return (u8)engineB.bg[1].BGCNT;
-	case 0x400100B:
-		return (u8)(engineB.bg[1].BGCNT >> 8);
-	case 0x400100C:
-		return (u8)engineB.bg[2].BGCNT;
-	case 0x400100D:
-		return (u8)(engineB.bg[2].BGCNT >> 8);
-	case 0x400100E:
-		return (u8)engineB.bg[3].BGCNT;
-	case 0x400100F:
-		return (u8)(engineB.bg[3].BGCNT >> 8);
-	case 0x4001048:
-		return (u8)engineB.WININ;
-	case 0x4001049:
-		return (u8)(engineB.WININ >> 8);
-	case 0x400104A:
-		return (u8)engineB.WINOUT;
-	case 0x400104B:
-		return (u8)(engineB.WINOUT >> 8);
-	case 0x400106C:
-		return (u8)engineB.MASTER_BRIGHT;
-	case 0x400106D:
-		return (u8)(engineB.MASTER_BRIGHT >> 8);
 	case 0x400106E:
 	case 0x400106F:
 		return 0;
 	default:
-		shared->log << fmt::format("[NDS9 Bus][PPU] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS9 Bus][PPU] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 }
@@ -1145,303 +1160,55 @@ void PPU::writeIO9(u32 address, u8 value) {
 	case 0x4000005:
 		DISPSTAT9 = (DISPSTAT9 & 0x00FF) | ((value & 0xFF) << 8);
 		break;
-	case 0x4000008:
-		engineA.bg[0].BGCNT = (engineA.bg[0].BGCNT & 0xFF00) | ((value & 0xFF) << 0);
-		engineA.bg[0].charBlockBaseAddress = (16384 * engineA.bg[0].charBlock) + (65536 * engineA.charBase);
-		break;
-	case 0x4000009:
-		engineA.bg[0].BGCNT = (engineA.bg[0].BGCNT & 0x00FF) | ((value & 0xFF) << 8);
-		engineA.bg[0].screenBlockBaseAddress = (2048 * engineA.bg[0].screenBlock) + (65536 * engineA.screenBase);
-		break;
-	case 0x400000A:
-		engineA.bg[1].BGCNT = (engineA.bg[1].BGCNT & 0xFF00) | ((value & 0xFF) << 0);
-		engineA.bg[1].charBlockBaseAddress = (16384 * engineA.bg[1].charBlock) + (65536 * engineA.charBase);
-		break;
-	case 0x400000B:
-		engineA.bg[1].BGCNT = (engineA.bg[1].BGCNT & 0x00FF) | ((value & 0xFF) << 8);
-		engineA.bg[1].screenBlockBaseAddress = (2048 * engineA.bg[1].screenBlock) + (65536 * engineA.screenBase);
-		break;
-	case 0x400000C:
-		engineA.bg[2].BGCNT = (engineA.bg[2].BGCNT & 0xFF00) | ((value & 0xFF) << 0);
-		engineA.bg[2].charBlockBaseAddress = (16384 * engineA.bg[2].charBlock) + (65536 * engineA.charBase);
-		break;
-	case 0x400000D:
-		engineA.bg[2].BGCNT = (engineA.bg[2].BGCNT & 0x00FF) | ((value & 0xFF) << 8);
-		engineA.bg[2].screenBlockBaseAddress = (2048 * engineA.bg[2].screenBlock) + (65536 * engineA.screenBase);
-		break;
-	case 0x400000E:
-		engineA.bg[3].BGCNT = (engineA.bg[3].BGCNT & 0xFF00) | ((value & 0xFF) << 0);
-		engineA.bg[3].charBlockBaseAddress = (16384 * engineA.bg[3].charBlock) + (65536 * engineA.charBase);
-		break;
-	case 0x400000F:
-		engineA.bg[3].BGCNT = (engineA.bg[3].BGCNT & 0x00FF) | ((value & 0xFF) << 8);
-		engineA.bg[3].screenBlockBaseAddress = (2048 * engineA.bg[3].screenBlock) + (65536 * engineA.screenBase);
-		break;
-	case 0x4000010:
-		engineA.bg[0].BGHOFS = (engineA.bg[0].BGHOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000011:
-		engineA.bg[0].BGHOFS = (engineA.bg[0].BGHOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x4000012:
-		engineA.bg[0].BGVOFS = (engineA.bg[0].BGVOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000013:
-		engineA.bg[0].BGVOFS = (engineA.bg[0].BGVOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x4000014:
-		engineA.bg[1].BGHOFS = (engineA.bg[1].BGHOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000015:
-		engineA.bg[1].BGHOFS = (engineA.bg[1].BGHOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x4000016:
-		engineA.bg[1].BGVOFS = (engineA.bg[1].BGVOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000017:
-		engineA.bg[1].BGVOFS = (engineA.bg[1].BGVOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x4000018:
-		engineA.bg[2].BGHOFS = (engineA.bg[2].BGHOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000019:
-		engineA.bg[2].BGHOFS = (engineA.bg[2].BGHOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x400001A:
-		engineA.bg[2].BGVOFS = (engineA.bg[2].BGVOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x400001B:
-		engineA.bg[2].BGVOFS = (engineA.bg[2].BGVOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x400001C:
-		engineA.bg[3].BGHOFS = (engineA.bg[3].BGHOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x400001D:
-		engineA.bg[3].BGHOFS = (engineA.bg[3].BGHOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x400001E:
-		engineA.bg[3].BGVOFS = (engineA.bg[3].BGVOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x400001F:
-		engineA.bg[3].BGVOFS = (engineA.bg[3].BGVOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x4000020:
-		engineA.bg[2].BGPA = (engineA.bg[2].BGPA & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000021:
-		engineA.bg[2].BGPA = (engineA.bg[2].BGPA & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4000022:
-		engineA.bg[2].BGPB = (engineA.bg[2].BGPB & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000023:
-		engineA.bg[2].BGPB = (engineA.bg[2].BGPB & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4000024:
-		engineA.bg[2].BGPC = (engineA.bg[2].BGPC & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000025:
-		engineA.bg[2].BGPC = (engineA.bg[2].BGPC & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4000026:
-		engineA.bg[2].BGPD = (engineA.bg[2].BGPD & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000027:
-		engineA.bg[2].BGPD = (engineA.bg[2].BGPD & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4000028:
-		engineA.bg[2].BGX = (engineA.bg[2].BGX & 0xFFFFFF00) | ((value & 0xFF) << 0);
-		engineA.bg[2].internalBGX = (float)((i32)(engineA.bg[2].BGX << 4) >> 4) / 256;
-		break;
-	case 0x4000029:
-		engineA.bg[2].BGX = (engineA.bg[2].BGX & 0xFFFF00FF) | ((value & 0xFF) << 8);
-		engineA.bg[2].internalBGX = (float)((i32)(engineA.bg[2].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400002A:
-		engineA.bg[2].BGX = (engineA.bg[2].BGX & 0xFF00FFFF) | ((value & 0xFF) << 16);
-		engineA.bg[2].internalBGX = (float)((i32)(engineA.bg[2].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400002B:
-		engineA.bg[2].BGX = (engineA.bg[2].BGX & 0x00FFFFFF) | ((value & 0x0F) << 24);
-		engineA.bg[2].internalBGX = (float)((i32)(engineA.bg[2].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400002C:
-		engineA.bg[2].BGY = (engineA.bg[2].BGY & 0xFFFFFF00) | ((value & 0xFF) << 0);
-		engineA.bg[2].internalBGY = (float)((i32)(engineA.bg[2].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400002D:
-		engineA.bg[2].BGY = (engineA.bg[2].BGY & 0xFFFF00FF) | ((value & 0xFF) << 8);
-		engineA.bg[2].internalBGY = (float)((i32)(engineA.bg[2].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400002E:
-		engineA.bg[2].BGY = (engineA.bg[2].BGY & 0xFF00FFFF) | ((value & 0xFF) << 16);
-		engineA.bg[2].internalBGY = (float)((i32)(engineA.bg[2].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400002F:
-		engineA.bg[2].BGY = (engineA.bg[2].BGY & 0x00FFFFFF) | ((value & 0x0F) << 24);
-		engineA.bg[2].internalBGY = (float)((i32)(engineA.bg[2].BGY << 4) >> 4) / 256;
-		break;
-	case 0x4000030:
-		engineA.bg[3].BGPA = (engineA.bg[3].BGPA & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000031:
-		engineA.bg[3].BGPA = (engineA.bg[3].BGPA & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4000032:
-		engineA.bg[3].BGPB = (engineA.bg[3].BGPB & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000033:
-		engineA.bg[3].BGPB = (engineA.bg[3].BGPB & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4000034:
-		engineA.bg[3].BGPC = (engineA.bg[3].BGPC & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000035:
-		engineA.bg[3].BGPC = (engineA.bg[3].BGPC & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4000036:
-		engineA.bg[3].BGPD = (engineA.bg[3].BGPD & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000037:
-		engineA.bg[3].BGPD = (engineA.bg[3].BGPD & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4000038:
-		engineA.bg[3].BGX = (engineA.bg[3].BGX & 0xFFFFFF00) | ((value & 0xFF) << 0);
-		engineA.bg[3].internalBGX = (float)((i32)(engineA.bg[3].BGX << 4) >> 4) / 256;
-		break;
-	case 0x4000039:
-		engineA.bg[3].BGX = (engineA.bg[3].BGX & 0xFFFF00FF) | ((value & 0xFF) << 8);
-		engineA.bg[3].internalBGX = (float)((i32)(engineA.bg[3].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400003A:
-		engineA.bg[3].BGX = (engineA.bg[3].BGX & 0xFF00FFFF) | ((value & 0xFF) << 16);
-		engineA.bg[3].internalBGX = (float)((i32)(engineA.bg[3].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400003B:
-		engineA.bg[3].BGX = (engineA.bg[3].BGX & 0x00FFFFFF) | ((value & 0x0F) << 24);
-		engineA.bg[3].internalBGX = (float)((i32)(engineA.bg[3].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400003C:
-		engineA.bg[3].BGY = (engineA.bg[3].BGY & 0xFFFFFF00) | ((value & 0xFF) << 0);
-		engineA.bg[3].internalBGY = (float)((i32)(engineA.bg[3].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400003D:
-		engineA.bg[3].BGY = (engineA.bg[3].BGY & 0xFFFF00FF) | ((value & 0xFF) << 8);
-		engineA.bg[3].internalBGY = (float)((i32)(engineA.bg[3].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400003E:
-		engineA.bg[3].BGY = (engineA.bg[3].BGY & 0xFF00FFFF) | ((value & 0xFF) << 16);
-		engineA.bg[3].internalBGY = (float)((i32)(engineA.bg[3].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400003F:
-		engineA.bg[3].BGY = (engineA.bg[3].BGY & 0x00FFFFFF) | ((value & 0x0F) << 24);
-		engineA.bg[3].internalBGY = (float)((i32)(engineA.bg[3].BGY << 4) >> 4) / 256;
-		break;
-	case 0x4000040:
-		engineA.WIN0H = (engineA.WIN0H & 0xFF00) | ((value & 0xFF) << 0);
-		engineA.windowMasksDirty = true;
-		break;
-	case 0x4000041:
-		engineA.WIN0H = (engineA.WIN0H & 0x00FF) | ((value & 0xFF) << 8);
-		engineA.windowMasksDirty = true;
-		break;
-	case 0x4000042:
-		engineA.WIN1H = (engineA.WIN1H & 0xFF00) | ((value & 0xFF) << 0);
-		engineA.windowMasksDirty = true;
-		break;
-	case 0x4000043:
-		engineA.WIN1H = (engineA.WIN1H & 0x00FF) | ((value & 0xFF) << 8);
-		engineA.windowMasksDirty = true;
-		break;
-	case 0x4000044:
-		engineA.WIN0V = (engineA.WIN0V & 0xFF00) | ((value & 0xFF) << 0);
-		engineA.windowMasksDirty = true;
-		break;
-	case 0x4000045:
-		engineA.WIN0V = (engineA.WIN0V & 0x00FF) | ((value & 0xFF) << 8);
-		engineA.windowMasksDirty = true;
-		break;
-	case 0x4000046:
-		engineA.WIN1V = (engineA.WIN1V & 0xFF00) | ((value & 0xFF) << 0);
-		engineA.windowMasksDirty = true;
-		break;
-	case 0x4000047:
-		engineA.WIN1V = (engineA.WIN1V & 0x00FF) | ((value & 0xFF) << 8);
-		engineA.windowMasksDirty = true;
-		break;
-	case 0x4000048:
-		engineA.WININ = (engineA.WININ & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4000049:
-		engineA.WININ = (engineA.WININ & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x400004A:
-		engineA.WINOUT = (engineA.WINOUT & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x400004B:
-		engineA.WINOUT = (engineA.WINOUT & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x400004C:
-		engineA.MOSAIC = (engineA.MOSAIC & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x400004D:
-		engineA.MOSAIC = (engineA.MOSAIC & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x400006C:
-		engineA.MASTER_BRIGHT = (engineA.MASTER_BRIGHT & 0xFF00) | ((value & 0x1F) << 0);
-		break;
-	case 0x400006D:
-		engineA.MASTER_BRIGHT = (engineA.MASTER_BRIGHT & 0x00FF) | ((value & 0xC0) << 8);
-		break;
 	case 0x400006E:
 	case 0x400006F:
 		break;
 	case 0x4000240:
 		VRAMCNT_A = value & 0x9B;
 
-		shared->addEvent(0, EventType::REFRESH_VRAM_PAGES);
+		shared->requestPageRefresh(BusShared::PAGES_VRAM);
 		break;
 	case 0x4000241:
 		VRAMCNT_B = value & 0x9F;
 
-		shared->addEvent(0, EventType::REFRESH_VRAM_PAGES);
+		shared->requestPageRefresh(BusShared::PAGES_VRAM);
 		break;
 	case 0x4000242:
 		VRAMCNT_C = value & 0x9F;
 		vramCMapped7 = vramCEnable && (vramCMst == 2);
 
-		shared->addEvent(0, EventType::REFRESH_VRAM_PAGES);
+		shared->requestPageRefresh(BusShared::PAGES_VRAM);
 		break;
 	case 0x4000243:
 		VRAMCNT_D = value & 0x9F;
 		vramDMapped7 = vramDEnable && (vramDMst == 2);
 
-		shared->addEvent(0, EventType::REFRESH_VRAM_PAGES);
+		shared->requestPageRefresh(BusShared::PAGES_VRAM);
 		break;
 	case 0x4000244:
 		VRAMCNT_E = value & 0x87;
 
-		shared->addEvent(0, EventType::REFRESH_VRAM_PAGES);
+		shared->requestPageRefresh(BusShared::PAGES_VRAM);
 		break;
 	case 0x4000245:
 		VRAMCNT_F = value & 0x9F;
 
-		shared->addEvent(0, EventType::REFRESH_VRAM_PAGES);
+		shared->requestPageRefresh(BusShared::PAGES_VRAM);
 		break;
 	case 0x4000246:
 		VRAMCNT_G = value & 0x9F;
 
-		shared->addEvent(0, EventType::REFRESH_VRAM_PAGES);
+		shared->requestPageRefresh(BusShared::PAGES_VRAM);
 		break;
 	case 0x4000248:
 		VRAMCNT_H = value & 0x83;
 
-		shared->addEvent(0, EventType::REFRESH_VRAM_PAGES);
+		shared->requestPageRefresh(BusShared::PAGES_VRAM);
 		break;
 	case 0x4000249:
 		VRAMCNT_I = value & 0x83;
 
-		shared->addEvent(0, EventType::REFRESH_VRAM_PAGES);
+		shared->requestPageRefresh(BusShared::PAGES_VRAM);
 		break;
 	case 0x4000304:
 		POWCNT1 = (POWCNT1 & 0xFF00) | ((value & 0x0F) << 0);
@@ -1464,263 +1231,37 @@ void PPU::writeIO9(u32 address, u8 value) {
 	case 0x4001003:
 		engineB.DISPCNT = (engineB.DISPCNT & 0x00FFFFFF) | ((value & 0xC0) << 24);
 		break;
-	case 0x4001008:
-		engineB.bg[0].BGCNT = (engineB.bg[0].BGCNT & 0xFF00) | ((value & 0xFF) << 0);
-		engineB.bg[0].charBlockBaseAddress = 16384 * engineB.bg[0].charBlock;
-		break;
-	case 0x4001009:
-		engineB.bg[0].BGCNT = (engineB.bg[0].BGCNT & 0x00FF) | ((value & 0xFF) << 8);
-		engineB.bg[0].screenBlockBaseAddress = 2048 * engineB.bg[0].screenBlock;
-		break;
-	case 0x400100A:
-		engineB.bg[1].BGCNT = (engineB.bg[1].BGCNT & 0xFF00) | ((value & 0xFF) << 0);
-		engineB.bg[1].charBlockBaseAddress = 16384 * engineB.bg[1].charBlock;
-		break;
-	case 0x400100B:
-		engineB.bg[1].BGCNT = (engineB.bg[1].BGCNT & 0x00FF) | ((value & 0xFF) << 8);
-		engineB.bg[1].screenBlockBaseAddress = 2048 * engineB.bg[1].screenBlock;
-		break;
-	case 0x400100C:
-		engineB.bg[2].BGCNT = (engineB.bg[2].BGCNT & 0xFF00) | ((value & 0xFF) << 0);
-		engineB.bg[2].charBlockBaseAddress = 16384 * engineB.bg[2].charBlock;
-		break;
-	case 0x400100D:
-		engineB.bg[2].BGCNT = (engineB.bg[2].BGCNT & 0x00FF) | ((value & 0xFF) << 8);
-		engineB.bg[2].screenBlockBaseAddress = 2048 * engineB.bg[2].screenBlock;
-		break;
-	case 0x400100E:
-		engineB.bg[3].BGCNT = (engineB.bg[3].BGCNT & 0xFF00) | ((value & 0xFF) << 0);
-		engineB.bg[3].charBlockBaseAddress = 16384 * engineB.bg[3].charBlock;
-		break;
-	case 0x400100F:
-		engineB.bg[3].BGCNT = (engineB.bg[3].BGCNT & 0x00FF) | ((value & 0xFF) << 8);
-		engineB.bg[3].screenBlockBaseAddress = 2048 * engineB.bg[3].screenBlock;
-		break;
-	case 0x4001010:
-		engineB.bg[0].BGHOFS = (engineB.bg[0].BGHOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001011:
-		engineB.bg[0].BGHOFS = (engineB.bg[0].BGHOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x4001012:
-		engineB.bg[0].BGVOFS = (engineB.bg[0].BGVOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001013:
-		engineB.bg[0].BGVOFS = (engineB.bg[0].BGVOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x4001014:
-		engineB.bg[1].BGHOFS = (engineB.bg[1].BGHOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001015:
-		engineB.bg[1].BGHOFS = (engineB.bg[1].BGHOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x4001016:
-		engineB.bg[1].BGVOFS = (engineB.bg[1].BGVOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001017:
-		engineB.bg[1].BGVOFS = (engineB.bg[1].BGVOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x4001018:
-		engineB.bg[2].BGHOFS = (engineB.bg[2].BGHOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001019:
-		engineB.bg[2].BGHOFS = (engineB.bg[2].BGHOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x400101A:
-		engineB.bg[2].BGVOFS = (engineB.bg[2].BGVOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x400101B:
-		engineB.bg[2].BGVOFS = (engineB.bg[2].BGVOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x400101C:
-		engineB.bg[3].BGHOFS = (engineB.bg[3].BGHOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x400101D:
-		engineB.bg[3].BGHOFS = (engineB.bg[3].BGHOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x400101E:
-		engineB.bg[3].BGVOFS = (engineB.bg[3].BGVOFS & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x400101F:
-		engineB.bg[3].BGVOFS = (engineB.bg[3].BGVOFS & 0x00FF) | ((value & 0x01) << 8);
-		break;
-	case 0x4001020:
-		engineB.bg[2].BGPA = (engineB.bg[2].BGPA & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001021:
-		engineB.bg[2].BGPA = (engineB.bg[2].BGPA & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4001022:
-		engineB.bg[2].BGPB = (engineB.bg[2].BGPB & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001023:
-		engineB.bg[2].BGPB = (engineB.bg[2].BGPB & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4001024:
-		engineB.bg[2].BGPC = (engineB.bg[2].BGPC & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001025:
-		engineB.bg[2].BGPC = (engineB.bg[2].BGPC & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4001026:
-		engineB.bg[2].BGPD = (engineB.bg[2].BGPD & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001027:
-		engineB.bg[2].BGPD = (engineB.bg[2].BGPD & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4001028:
-		engineB.bg[2].BGX = (engineB.bg[2].BGX & 0xFFFFFF00) | ((value & 0xFF) << 0);
-		engineB.bg[2].internalBGX = (float)((i32)(engineB.bg[2].BGX << 4) >> 4) / 256;
-		break;
-	case 0x4001029:
-		engineB.bg[2].BGX = (engineB.bg[2].BGX & 0xFFFF00FF) | ((value & 0xFF) << 8);
-		engineB.bg[2].internalBGX = (float)((i32)(engineB.bg[2].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400102A:
-		engineB.bg[2].BGX = (engineB.bg[2].BGX & 0xFF00FFFF) | ((value & 0xFF) << 16);
-		engineB.bg[2].internalBGX = (float)((i32)(engineB.bg[2].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400102B:
-		engineB.bg[2].BGX = (engineB.bg[2].BGX & 0x00FFFFFF) | ((value & 0x0F) << 24);
-		engineB.bg[2].internalBGX = (float)((i32)(engineB.bg[2].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400102C:
-		engineB.bg[2].BGY = (engineB.bg[2].BGY & 0xFFFFFF00) | ((value & 0xFF) << 0);
-		engineB.bg[2].internalBGY = (float)((i32)(engineB.bg[2].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400102D:
-		engineB.bg[2].BGY = (engineB.bg[2].BGY & 0xFFFF00FF) | ((value & 0xFF) << 8);
-		engineB.bg[2].internalBGY = (float)((i32)(engineB.bg[2].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400102E:
-		engineB.bg[2].BGY = (engineB.bg[2].BGY & 0xFF00FFFF) | ((value & 0xFF) << 16);
-		engineB.bg[2].internalBGY = (float)((i32)(engineB.bg[2].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400102F:
-		engineB.bg[2].BGY = (engineB.bg[2].BGY & 0x00FFFFFF) | ((value & 0x0F) << 24);
-		engineB.bg[2].internalBGY = (float)((i32)(engineB.bg[2].BGY << 4) >> 4) / 256;
-		break;
-	case 0x4001030:
-		engineB.bg[3].BGPA = (engineB.bg[3].BGPA & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001031:
-		engineB.bg[3].BGPA = (engineB.bg[3].BGPA & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4001032:
-		engineB.bg[3].BGPB = (engineB.bg[3].BGPB & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001033:
-		engineB.bg[3].BGPB = (engineB.bg[3].BGPB & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4001034:
-		engineB.bg[3].BGPC = (engineB.bg[3].BGPC & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001035:
-		engineB.bg[3].BGPC = (engineB.bg[3].BGPC & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4001036:
-		engineB.bg[3].BGPD = (engineB.bg[3].BGPD & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001037:
-		engineB.bg[3].BGPD = (engineB.bg[3].BGPD & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x4001038:
-		engineB.bg[3].BGX = (engineB.bg[3].BGX & 0xFFFFFF00) | ((value & 0xFF) << 0);
-		engineB.bg[3].internalBGX = (float)((i32)(engineB.bg[3].BGX << 4) >> 4) / 256;
-		break;
-	case 0x4001039:
-		engineB.bg[3].BGX = (engineB.bg[3].BGX & 0xFFFF00FF) | ((value & 0xFF) << 8);
-		engineB.bg[3].internalBGX = (float)((i32)(engineB.bg[3].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400103A:
-		engineB.bg[3].BGX = (engineB.bg[3].BGX & 0xFF00FFFF) | ((value & 0xFF) << 16);
-		engineB.bg[3].internalBGX = (float)((i32)(engineB.bg[3].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400103B:
-		engineB.bg[3].BGX = (engineB.bg[3].BGX & 0x00FFFFFF) | ((value & 0x0F) << 24);
-		engineB.bg[3].internalBGX = (float)((i32)(engineB.bg[3].BGX << 4) >> 4) / 256;
-		break;
-	case 0x400103C:
-		engineB.bg[3].BGY = (engineB.bg[3].BGY & 0xFFFFFF00) | ((value & 0xFF) << 0);
-		engineB.bg[3].internalBGY = (float)((i32)(engineB.bg[3].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400103D:
-		engineB.bg[3].BGY = (engineB.bg[3].BGY & 0xFFFF00FF) | ((value & 0xFF) << 8);
-		engineB.bg[3].internalBGY = (float)((i32)(engineB.bg[3].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400103E:
-		engineB.bg[3].BGY = (engineB.bg[3].BGY & 0xFF00FFFF) | ((value & 0xFF) << 16);
-		engineB.bg[3].internalBGY = (float)((i32)(engineB.bg[3].BGY << 4) >> 4) / 256;
-		break;
-	case 0x400103F:
-		engineB.bg[3].BGY = (engineB.bg[3].BGY & 0x00FFFFFF) | ((value & 0x0F) << 24);
-		engineB.bg[3].internalBGY = (float)((i32)(engineB.bg[3].BGY << 4) >> 4) / 256;
-		break;
-	case 0x4001040:
-		engineB.WIN0H = (engineB.WIN0H & 0xFF00) | ((value & 0xFF) << 0);
-		engineB.windowMasksDirty = true;
-		break;
-	case 0x4001041:
-		engineB.WIN0H = (engineB.WIN0H & 0x00FF) | ((value & 0xFF) << 8);
-		engineB.windowMasksDirty = true;
-		break;
-	case 0x4001042:
-		engineB.WIN1H = (engineB.WIN1H & 0xFF00) | ((value & 0xFF) << 0);
-		engineB.windowMasksDirty = true;
-		break;
-	case 0x4001043:
-		engineB.WIN1H = (engineB.WIN1H & 0x00FF) | ((value & 0xFF) << 8);
-		engineB.windowMasksDirty = true;
-		break;
-	case 0x4001044:
-		engineB.WIN0V = (engineB.WIN0V & 0xFF00) | ((value & 0xFF) << 0);
-		engineB.windowMasksDirty = true;
-		break;
-	case 0x4001045:
-		engineB.WIN0V = (engineB.WIN0V & 0x00FF) | ((value & 0xFF) << 8);
-		engineB.windowMasksDirty = true;
-		break;
-	case 0x4001046:
-		engineB.WIN1V = (engineB.WIN1V & 0xFF00) | ((value & 0xFF) << 0);
-		engineB.windowMasksDirty = true;
-		break;
-	case 0x4001047:
-		engineB.WIN1V = (engineB.WIN1V & 0x00FF) | ((value & 0xFF) << 8);
-		engineB.windowMasksDirty = true;
-		break;
-	case 0x4001048:
-		engineB.WININ = (engineB.WININ & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x4001049:
-		engineB.WININ = (engineB.WININ & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x400104A:
-		engineB.WINOUT = (engineB.WINOUT & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x400104B:
-		engineB.WINOUT = (engineB.WINOUT & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x400104C:
-		engineB.MOSAIC = (engineB.MOSAIC & 0xFF00) | ((value & 0xFF) << 0);
-		break;
-	case 0x400104D:
-		engineB.MOSAIC = (engineB.MOSAIC & 0x00FF) | ((value & 0xFF) << 8);
-		break;
-	case 0x400106C:
-		engineB.MASTER_BRIGHT = (engineB.MASTER_BRIGHT & 0xFF00) | ((value & 0x1F) << 0);
-		break;
-	case 0x400106D:
-		engineB.MASTER_BRIGHT = (engineB.MASTER_BRIGHT & 0x00FF) | ((value & 0xC0) << 8);
-		break;
 	case 0x400106E:
 	case 0x400106F:
 		break;
 	default:
-		shared->log << fmt::format("[NDS9 Bus][PPU] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS9 Bus][PPU] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
 		break;
 	}
 }
 
+void PPU::bgControlWritten(void *engine, u32 address, u32 old) {
+	GraphicsEngine &e = *(GraphicsEngine *)engine;
+	auto &bg = e.bg[(address >> 1) & 3];
+	// Engine B's DISPCNT can't set the bases, so they're always 0 there
+	bg.charBlockBaseAddress = (16384 * bg.charBlock) + (65536 * e.charBase);
+	bg.screenBlockBaseAddress = (2048 * bg.screenBlock) + (65536 * e.screenBase);
+}
+
+void PPU::referencePointWritten(void *engine, u32 address, u32 old) {
+	auto &bg = ((GraphicsEngine *)engine)->bg[2 + ((address >> 4) & 1)];
+	if (address & 4) {
+		bg.internalBGY = (float)((i32)(bg.BGY << 4) >> 4) / 256;
+	} else {
+		bg.internalBGX = (float)((i32)(bg.BGX << 4) >> 4) / 256;
+	}
+}
+
+void PPU::windowWritten(void *engine, u32 address, u32 old) {
+	((GraphicsEngine *)engine)->windowMasksDirty = true;
+}
+
 u8 PPU::readIO7(u32 address) {
 	switch (address) {
 	case 0x4000004:
@@ -1734,7 +1275,8 @@ u8 PPU::readIO7(u32 address) {
 	case 0x4000240:
 		return VRAMSTAT;
 	default:
-		shared->log << fmt::format("[NDS7 Bus][PPU] Read from unknown IO register 0x{:0>7X}\n", address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][PPU] Read from unknown IO register 0x{:0>7X}\n", address);
 		return 0;
 	}
 }
@@ -1748,7 +1290,8 @@ void PPU::writeIO7(u32 address, u8 value) {
 		DISPSTAT7 = (DISPSTAT7 & 0x00FF) | ((value & 0xFF) << 8);
 		break;
 	default:
-		shared->log << fmt::format("[NDS7 Bus][PPU] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS7 Bus][PPU] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", address, value);
 		break;
 	}
 }
@@ -0,0 +1,125 @@
+#include "emulator/rewind.hpp"
+
+RewindBuffer::RewindBuffer() {
+	budget = 256 * 1024 * 1024;
+	memoryUsed = 0;
+}
+
+RewindBuffer::~RewindBuffer() {
+	//
+}
+
+void RewindBuffer::clear() {
+	deltas.clear();
+	current.clear();
+	memoryUsed = 0;
+}
+
+void RewindBuffer::push(std::vector<u8> &state) {
+	if (!current.empty()) {
+		// Build the difference that takes the new state back to the current one
+		Delta delta;
+		delta.size = current.size();
+
+		size_t size = std::max(state.size(), current.size()); // Whichever one is shorter acts like it's padded with zeros
+		for (size_t start = 0; start < size; start += BLOCK_SIZE) {
+			size_t blockSize = std::min(BLOCK_SIZE, size - start);
+			size_t newerBytes = (start < state.size()) ? std::min(blockSize, state.size() - start) : 0;
+			size_t olderBytes = (start < current.size()) ? std::min(blockSize, current.size() - start) : 0;
+			if ((newerBytes == blockSize) && (olderBytes == blockSize) && !memcmp(&state[start], &current[start], blockSize)) [[likely]]
+				continue;
+
+			if ((newerBytes == blockSize) && (olderBytes == blockSize)) [[likely]] {
+				for (size_t i = 0; i < blockSize; i++)
+					xorBlock[i] = state[start + i] ^ current[start + i];
+			} else { // Only at the end, when the sizes don't match
+				for (size_t i = 0; i < blockSize; i++)
+					xorBlock[i] = ((i < newerBytes) ? state[start + i] : 0) ^ ((i < olderBytes) ? current[start + i] : 0);
+			}
+
+			u32 header[2] = {(u32)(start / BLOCK_SIZE), 0};
+			size_t headerOffset = delta.data.size();
+			delta.data.resize(headerOffset + sizeof(header));
+			encodeBlock(delta.data, xorBlock, blockSize);
+			header[1] = delta.data.size() - headerOffset - sizeof(header);
+			memcpy(&delta.data[headerOffset], header, sizeof(header));
+		}
+
+		memoryUsed += delta.data.size();
+		deltas.push_back(std::move(delta));
+	}
+
+	memoryUsed = memoryUsed - current.size() + state.size();
+	std::swap(state, current);
+
+	// Drop the oldest history until it fits
+	while ((memoryUsed > budget) && !deltas.empty()) {
+		memoryUsed -= deltas.front().data.size();
+		deltas.pop_front();
+	}
+}
+
+// Turns the newest state into the one before it
+bool RewindBuffer::stepBack() {
+	if (deltas.empty())
+		return false;
+
+	Delta &delta = deltas.back();
+	size_t newerSize = current.size();
+	current.resize(std::max(newerSize, delta.size));
+
+	for (size_t offset = 0; offset < delta.data.size();) {
+		u32 header[2];
+		memcpy(header, &delta.data[offset], sizeof(header));
+		offset += sizeof(header);
+
+		size_t start = (size_t)header[0] * BLOCK_SIZE;
+		applyBlock(&current[start], std::min(BLOCK_SIZE, current.size() - start), &delta.data[offset], header[1]);
+		offset += header[1];
+	}
+	current.resize(delta.size);
+
+	memoryUsed = memoryUsed - newerSize + delta.size - delta.data.size();
+	deltas.pop_back();
+	return true;
+}
+
+// XORed blocks are mostly zeros, so they're stored as runs of zeros followed by runs of literal bytes.
+// Each pair is a u16 zero count, a u16 literal count, and then the literals.
+void RewindBuffer::encodeBlock(std::vector<u8> &out, const u8 *block, size_t blockSize) {
+	size_t i = 0;
+	while (i < blockSize) {
+		size_t zeroStart = i;
+		while ((i < blockSize) && (block[i] == 0))
+			++i;
+		u16 zeros = i - zeroStart;
+
+		// Keep short runs of zeros in the literals. Splitting them off would cost more than it saves.
+		size_t literalStart = i;
+		while ((i < blockSize) && !(((i + 4) <= blockSize) && (block[i] == 0) && (block[i + 1] == 0) && (block[i + 2] == 0) && (block[i + 3] == 0)))
+			++i;
+		u16 literals = i - literalStart;
+
+		size_t offset = out.size();
+		out.resize(offset + 4 + literals);
+		memcpy(&out[offset], &zeros, 2);
+		memcpy(&out[offset + 2], &literals, 2);
+		memcpy(&out[offset + 4], &block[literalStart], literals);
+	}
+}
+
+void RewindBuffer::applyBlock(u8 *block, size_t blockSize, const u8 *encoded, size_t encodedSize) {
+	size_t i = 0;
+	size_t offset = 0;
+	while ((offset + 4) <= encodedSize) {
+		u16 zeros, literals;
+		memcpy(&zeros, &encoded[offset], 2);
+		memcpy(&literals, &encoded[offset + 2], 2);
+		offset += 4;
+
+		i += zeros;
+		for (int j = 0; (j < literals) && (i < blockSize); j++)
+			block[i++] ^= encoded[offset + j];
+		offset += literals;
+	}
+}
@@ -0,0 +1,114 @@
+#include "emulator/savestate.hpp"
+
+static u32 toTag(const char *tag) {
+	u32 value;
+	memcpy(&value, tag, sizeof(value));
+	return value;
+}
+
+static std::string fromTag(u32 tag) {
+	return std::string((const char *)&tag, sizeof(tag));
+}
+
+StateWriter::StateWriter(std::vector<u8> &buffer) : buffer(buffer) {
+	buffer.clear(); // Keeps the capacity from the last save
+	chunkStart = 0;
+
+	write<u32>(SAVESTATE_MAGIC);
+	write<u32>(SAVESTATE_FORMAT_VERSION);
+}
+
+void StateWriter::beginChunk(const char *tag, u32 version) {
+	write<u32>(toTag(tag));
+	write<u32>(version);
+	write<u32>(0); // Size is filled in by endChunk()
+	chunkStart = buffer.size();
+}
+
+void StateWriter::endChunk() {
+	u32 size = buffer.size() - chunkStart;
+	memcpy(&buffer[chunkStart - sizeof(u32)], &size, sizeof(u32));
+}
+
+void StateWriter::writeBytes(const void *data, size_t size) {
+	size_t offset = buffer.size();
+	buffer.resize(offset + size);
+	memcpy(&buffer[offset], data, size);
+}
+
+StateReader::StateReader(const u8 *data, size_t size) : data(data) {
+	position = 0;
+	chunkEnd = size;
+	currentTag = 0;
+
+	if (read<u32>() != SAVESTATE_MAGIC) {
+		fail("Not a save state");
+		return;
+	}
+	u32 formatVersion = read<u32>();
+	if (formatVersion != SAVESTATE_FORMAT_VERSION) {
+		fail(fmt::format("Unsupported save state format version {}", formatVersion));
+		return;
+	}
+
+	// Build the chunk table
+	while (!failed() && (position < size)) {
+		Chunk chunk;
+		chunk.tag = read<u32>();
+		chunk.version = read<u32>();
+		chunk.size = read<u32>();
+		chunk.offset = position;
+		if (failed() || ((size - position) < chunk.size)) {
+			fail(fmt::format("Chunk {} is truncated", fromTag(chunk.tag)));
+			return;
+		}
+
+		chunks.push_back(chunk);
+		position += chunk.size;
+	}
+}
+
+u32 StateReader::beginChunk(const char *tag, u32 maxVersion) {
+	if (failed())
+		return 0;
+
+	currentTag = toTag(tag);
+	for (auto& chunk : chunks) {
+		if (chunk.tag != currentTag)
+			continue;
+
+		if ((chunk.version == 0) || (chunk.version > maxVersion)) {
+			fail(fmt::format("Chunk {} has unsupported version {}", fromTag(currentTag), chunk.version));
+			return 0;
+		}
+
+		position = chunk.offset;
+		chunkEnd = chunk.offset + chunk.size;
+		return chunk.version;
+	}
+
+	fail(fmt::format("Missing chunk {}", fromTag(currentTag)));
+	return 0;
+}
+
+void StateReader::endChunk() {
+	if (!failed() && (position != chunkEnd))
+		fail(fmt::format("Chunk {} has {} bytes left over", fromTag(currentTag), chunkEnd - position));
+}
+
+void StateReader::readBytes(void *out, size_t size) {
+	if (failed() || ((chunkEnd - position) < size)) {
+		if (!failed())
+			fail(fmt::format("Chunk {} ended early", fromTag(currentTag)));
+		memset(out, 0, size);
+		return;
+	}
+
+	memcpy(out, &data[position], size);
+	position += size;
+}
+
+void StateReader::fail(std::string message) {
+	if (error.empty())
+		error = std::move(message);
+}
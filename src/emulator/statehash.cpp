@@ -0,0 +1,152 @@
+#include "emulator/statehash.hpp"
+
+#include <bit>
+#include <sstream>
+
+u64 StateHasher::hash(const void *data, size_t size, u64 seed) {
+	constexpr u64 PRIME1 = 0x9E3779B185EBCA87;
+	constexpr u64 PRIME2 = 0xC2B2AE3D27D4EB4F;
+	const u8 *bytes = (const u8 *)data;
+
+	u64 lanes[4] = {seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1};
+	size_t i = 0;
+	for (; (i + 32) <= size; i += 32) {
+		for (int lane = 0; lane < 4; lane++) {
+			u64 word;
+			memcpy(&word, &bytes[i + (lane * 8)], sizeof(word));
+			lanes[lane] = std::rotl(lanes[lane] + (word * PRIME2), 31) * PRIME1;
+		}
+	}
+
+	u64 result = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18) + size;
+	for (; i < size; i++)
+		result = std::rotl(result ^ (bytes[i] * PRIME1), 11) * PRIME2;
+
+	// Final mix so every input bit affects every output bit
+	result ^= result >> 33;
+	result *= PRIME2;
+	result ^= result >> 29;
+	return result;
+}
+
+StateHasher::StateHasher() {
+	frameNumber = 0;
+	diverged = false;
+}
+
+StateHasher::~StateHasher() {
+	//
+}
+
+int StateHasher::record(std::filesystem::path path) {
+	recordFile.open(path, std::ios::trunc);
+	if (!recordFile.is_open())
+		return -1;
+
+	recordFile << "frame";
+	for (auto name : componentNames)
+		recordFile << '\t' << name;
+	recordFile << '\n';
+
+	frameNumber = 0;
+	return 0;
+}
+
+int StateHasher::check(std::filesystem::path path) {
+	referenceFile.open(path);
+	if (!referenceFile.is_open())
+		return -1;
+
+	std::string header;
+	std::getline(referenceFile, header);
+
+	frameNumber = 0;
+	diverged = false;
+	divergence.clear();
+	return 0;
+}
+
+void StateHasher::stop() {
+	recordFile.close();
+	referenceFile.close();
+}
+
+bool StateHasher::frame(FrameHash &hashes) {
+	hashes.frame = frameNumber++;
+	if (recordFile.is_open())
+		writeFrame(recordFile, hashes);
+
+	if (referenceFile.is_open() && !diverged) {
+		FrameHash reference;
+		if (!readFrame(referenceFile, reference)) // Ran past the end of the reference
+			return true;
+
+		divergence = describe(reference, hashes);
+		if (!divergence.empty()) {
+			diverged = true;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::string StateHasher::compare(std::filesystem::path pathA, std::filesystem::path pathB) {
+	std::ifstream fileA(pathA);
+	std::ifstream fileB(pathB);
+	if (!fileA.is_open() || !fileB.is_open())
+		return "Couldn't open both files";
+
+	std::string header;
+	std::getline(fileA, header);
+	std::getline(fileB, header);
+
+	FrameHash a, b;
+	while (true) {
+		bool gotA = readFrame(fileA, a);
+		bool gotB = readFrame(fileB, b);
+		if (!gotA || !gotB) {
+			if (gotA != gotB)
+				return fmt::format("{} ends at frame {}", gotA ? pathB.string() : pathA.string(), gotA ? a.frame : b.frame);
+			return "";
+		}
+
+		auto difference = describe(a, b);
+		if (!difference.empty())
+			return difference;
+	}
+}
+
+void StateHasher::writeFrame(std::ostream &stream, const FrameHash &hashes) {
+	stream << hashes.frame;
+	for (auto hash : hashes.component)
+		stream << fmt::format("\t{:0>16X}", hash);
+	stream << '\n';
+}
+
+bool StateHasher::readFrame(std::istream &stream, FrameHash &hashes) {
+	std::string line;
+	if (!std::getline(stream, line))
+		return false;
+
+	std::istringstream fields(line);
+	fields >> hashes.frame;
+	for (auto& hash : hashes.component)
+		fields >> std::hex >> hash;
+	return !fields.fail();
+}
+
+std::string StateHasher::describe(const FrameHash &a, const FrameHash &b) {
+	if (a.frame != b.frame)
+		return fmt::format("Frame numbers don't line up ({} and {})", a.frame, b.frame);
+
+	std::string components;
+	for (int i = 0; i < COMPONENT_COUNT; i++) {
+		if (a.component[i] != b.component[i])
+			components += components.empty() ? componentNames[i] : fmt::format(", {}", componentNames[i]);
+	}
+	if (components.empty())
+		return "";
+
+	return fmt::format("Diverged at frame {} in {}", a.frame, components);
+}
@@ -13,7 +13,18 @@ void Timer::reset() {
 	timer[0].TIMCNT_L = timer[1].TIMCNT_L = timer[2].TIMCNT_L = timer[3].TIMCNT_L = 0;
 	timer[0].TIMCNT_H = timer[1].TIMCNT_H = timer[2].TIMCNT_H = timer[3].TIMCNT_H = 0;
 	timer[0].lastIncrementTimestamp = timer[1].lastIncrementTimestamp = timer[2].lastIncrementTimestamp = timer[3].lastIncrementTimestamp = 0;
-	timer[0].interruptRequested = timer[1].interruptRequested = timer[2].interruptRequested = timer[3].interruptRequested = false;
+}
+
+void Timer::saveState(StateWriter &state) {
+	state.beginChunk(timer9 ? "TMR9" : "TMR7", 1);
+	state.write(timer);
+	state.endChunk();
+}
+
+void Timer::loadState(StateReader &state) {
+	state.beginChunk(timer9 ? "TMR9" : "TMR7", 1);
+	state.read(timer);
+	state.endChunk();
 }
 
 const u64 prescalerShifts[4] = { 1, 7, 9, 12 };
@@ -24,54 +35,51 @@ void Timer::updateCounter(int channel) {
 	if (!tim.startStop || tim.cascade)
 		return;
 
-	tim.TIMCNT_L += (shared->currentTime - tim.lastIncrementTimestamp) >> shift;
-	tim.lastIncrementTimestamp = (shared->currentTime >> shift) << shift; // Round down to last rising edge of the selected prescaler bit
+	tim.TIMCNT_L += (shared->time() - tim.lastIncrementTimestamp) >> shift;
+	tim.lastIncrementTimestamp = (shared->time() >> shift) << shift; // Round down to last rising edge of the selected prescaler bit
+}
+
+EventType Timer::overflowEvent(int channel) {
+	return (EventType)((timer9 ? TIMER0_OVERFLOW_9 : TIMER0_OVERFLOW_7) + channel);
 }
 
 u64 Timer::scheduleTimer(int channel) {
 	auto& tim = timer[channel];
 	int shift = prescalerShifts[tim.prescaler];
 
-	u64 nextTime = ((shared->currentTime >> shift) + (0x10000 - tim.TIMCNT_L)) << shift;
-	shared->addEventAbsolute(nextTime, timer9 ? TIMER_OVERFLOW_9 : TIMER_OVERFLOW_7);
+	u64 nextTime = ((shared->time() >> shift) + (0x10000 - tim.TIMCNT_L)) << shift;
+	shared->addEventAbsolute(nextTime, overflowEvent(channel));
 	return nextTime;
 }
 
-void Timer::checkOverflow() {
-	bool overflow = false;
-	for (int channel = 0; channel < 4; channel++) {
-		auto& tim = timer[channel];
-		if (!tim.startStop)
-			continue;
-
-		if (tim.cascade) {
-			if (overflow) {
-				if (++tim.TIMCNT_L == 0) {
-					if (tim.irqEnable)
-						tim.interruptRequested = true;
-
-					tim.TIMCNT_L = tim.reload;
-				} else {
-					overflow = false;
-				}
-			}
-		} else {
-			overflow = false;
+// Handles an overflow on one channel and any timers cascading off of it.
+// Returns a mask of the channels that want an interrupt.
+u8 Timer::checkOverflow(int channel) {
+	auto& tim = timer[channel];
+	if (!tim.startStop || tim.cascade)
+		return 0;
+
+	updateCounter(channel);
+	if ((tim.TIMCNT_L != 0) || (tim.lastIncrementTimestamp != shared->time())) // Not an overflow
+		return 0;
 
-			updateCounter(channel);
-			if ((tim.TIMCNT_L == 0) && (tim.lastIncrementTimestamp == shared->currentTime)) { // Overflow
-				if (tim.irqEnable)
-					tim.interruptRequested = true;
+	u8 irqMask = tim.irqEnable ? (1 << channel) : 0;
+	tim.TIMCNT_L = tim.reload;
+	u64 nextTime = scheduleTimer(channel);
+	if (Instrumentation::logging && logTimer)
+		shared->log << fmt::format("[NDS{} Bus][Timer] Timer {:X} overflow at time {:X}. Next overflow prediced at {:X}. {}\n", timer9 ? 9 : 7, channel, shared->time(), nextTime, tim.irqEnable ? "Interrupt requested" : "");
 
-				tim.TIMCNT_L = tim.reload;
-				u64 nextTime = scheduleTimer(channel);
-				if (logTimer)
-					shared->log << fmt::format("[NDS{} Bus][Timer] Timer {:X} overflow at time {:X}. Next overflow prediced at {:X}. {}\n", timer9 ? 9 : 7, channel, shared->currentTime, nextTime, tim.irqEnable ? "Interrupt requested" : "");
+	for (int next = channel + 1; next < 4; next++) {
+		auto& cascadeTim = timer[next];
+		if (!cascadeTim.startStop || !cascadeTim.cascade || (++cascadeTim.TIMCNT_L != 0))
+			break;
 
-				overflow = true;
-			}
-		}
+		if (cascadeTim.irqEnable)
+			irqMask |= 1 << next;
+		cascadeTim.TIMCNT_L = cascadeTim.reload;
 	}
+
+	return irqMask;
 }
 
 u8 Timer::readIO(u32 address) {
@@ -117,7 +125,8 @@ u8 Timer::readIO(u32 address) {
 	case 0x400010F:
 		return (u8)(timer[3].TIMCNT_H >> 8);
 	default:
-		shared->log << fmt::format("[NDS{} Bus][Timer] Read from unknown IO register 0x{:0>7X}\n", timer9 ? 9 : 7, address);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS{} Bus][Timer] Read from unknown IO register 0x{:0>7X}\n", timer9 ? 9 : 7, address);
 		return 0;
 	}
 }
@@ -141,8 +150,11 @@ void Timer::writeIO(u32 address, u8 value) {
 		if (!oldStartStop && tim.startStop) // Rising edge
 			tim.TIMCNT_L = tim.reload;
 
-		if (tim.startStop && !tim.cascade)
+		if (tim.startStop && !tim.cascade) {
 			scheduleTimer(0);
+		} else {
+			shared->cancelEvent(overflowEvent(0));
+		}
 		} break;
 	case 0x4000103:
 		break;
@@ -163,8 +175,11 @@ void Timer::writeIO(u32 address, u8 value) {
 		if (!oldStartStop && tim.startStop) // Rising edge
 			tim.TIMCNT_L = tim.reload;
 
-		if (tim.startStop && !tim.cascade)
+		if (tim.startStop && !tim.cascade) {
 			scheduleTimer(1);
+		} else {
+			shared->cancelEvent(overflowEvent(1));
+		}
 	} break;
 	case 0x4000107:
 		break;
@@ -185,8 +200,11 @@ void Timer::writeIO(u32 address, u8 value) {
 		if (!oldStartStop && tim.startStop) // Rising edge
 			tim.TIMCNT_L = tim.reload;
 
-		if (tim.startStop && !tim.cascade)
+		if (tim.startStop && !tim.cascade) {
 			scheduleTimer(2);
+		} else {
+			shared->cancelEvent(overflowEvent(2));
+		}
 	} break;
 	case 0x400010B:
 		break;
@@ -207,13 +225,17 @@ void Timer::writeIO(u32 address, u8 value) {
 		if (!oldStartStop && tim.startStop) // Rising edge
 			tim.TIMCNT_L = tim.reload;
 
-		if (tim.startStop && !tim.cascade)
+		if (tim.startStop && !tim.cascade) {
 			scheduleTimer(3);
+		} else {
+			shared->cancelEvent(overflowEvent(3));
+		}
 	} break;
 	case 0x400010F:
 		break;
 	default:
-		shared->log << fmt::format("[NDS{} Bus][Timer] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", timer9 ? 9 : 7, address, value);
+		if constexpr (Instrumentation::logging)
+			shared->log << fmt::format("[NDS{} Bus][Timer] Write to unknown IO register 0x{:0>7X} with value 0x{:0>2X}\n", timer9 ? 9 : 7, address, value);
 		break;
 	}
 }
@@ -0,0 +1,50 @@
+#include "emulator/timetravel.hpp"
+
+TimeTravel::TimeTravel() {
+	budget = 1024 * 1024 * 1024;
+	clear();
+}
+
+TimeTravel::~TimeTravel() {
+	//
+}
+
+void TimeTravel::clear() {
+	keyframes.clear();
+	inputs.clear();
+	memoryUsed = 0;
+	position = {0, 0, 0};
+	nextInput = 0;
+}
+
+void TimeTravel::addKeyframe(std::vector<u8> &state, u64 time) {
+	Keyframe keyframe = {.position = position, .time = time};
+	std::swap(keyframe.state, state);
+	memoryUsed += keyframe.state.size();
+	keyframes.push_back(std::move(keyframe));
+
+	// Drop the oldest keyframes until it fits, along with the inputs that only they needed.
+	// The newest one always stays so there's somewhere to go back to.
+	while ((memoryUsed > budget) && (keyframes.size() > 1)) {
+		memoryUsed -= keyframes.front().state.size();
+		keyframes.pop_front();
+	}
+	while (!inputs.empty() && (inputs.front().ticks < keyframes.front().position.ticks))
+		inputs.pop_front();
+}
+
+void TimeTravel::addInput(u32 keys, u8 touchX, u8 touchY) {
+	if (keyframes.empty()) // The first keyframe will have it in its state
+		return;
+
+	inputs.push_back({position.ticks, keys, touchX, touchY});
+}
+
+void TimeTravel::truncate() {
+	while (!keyframes.empty() && (keyframes.back().position.ticks > position.ticks)) {
+		memoryUsed -= keyframes.back().state.size();
+		keyframes.pop_back();
+	}
+	while (!inputs.empty() && (inputs.back().ticks >= position.ticks))
+		inputs.pop_back();
+}
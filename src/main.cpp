@@ -21,6 +21,7 @@ SDL_Scancode keymap[12] = {
 	SDL_SCANCODE_A // Button Y
 };
 u32 lastJoypad;
+u16 lastTouch;
 
 WavFile<i16> wavFile;
 SDL_AudioSpec desiredAudioSpec, audioSpec;
@@ -29,10 +30,15 @@ void audioCallback(void *userdata, uint8_t *stream, int len) {
 	if (!ortin.nds.running)
 		return;
 
-	ortin.nds.nds7->apu->soundRunning = true; // What's thread safety?
+	if (ortin.nds.pacer.audioMuted()) {
+		SDL_memset(stream, audioSpec.silence, len);
+		return;
+	}
 
-	SDL_memcpy(stream, ortin.nds.nds7->apu->outputSamples, len); // Copy samples to SDL's buffer
-	wavFile.write((u8 *)ortin.nds.nds7->apu->outputSamples, len); // Write samples to file
+	// Silence for whatever the emulator hasn't caught up on yet
+	int bytes = ortin.nds.pullAudio((i16 *)stream, len / (2 * sizeof(i16))) * 2 * sizeof(i16);
+	SDL_memset(stream + bytes, audioSpec.silence, len - bytes);
+	wavFile.write(stream, bytes); // Write samples to file
 }
 
 int main(int argc, char *argv[]) {
@@ -44,22 +50,19 @@ int main(int argc, char *argv[]) {
 	mINI::INIStructure ini;
 	file.read(ini);
 	if (ini["files"]["autoloadbios9"] == "true") {
-		static std::filesystem::path path = ini["files"]["bios9path"];
-		ortin.nds.addThreadEvent(NDS::LOAD_BIOS9, &path);
+		ortin.nds.addThreadEvent(NDS::LOAD_BIOS9, std::filesystem::path(ini["files"]["bios9path"]));
 	}
 	if (ini["files"]["autoloadbios7"] == "true") {
-		static std::filesystem::path path = ini["files"]["bios7path"];
-		ortin.nds.addThreadEvent(NDS::LOAD_BIOS7, &path);
+		ortin.nds.addThreadEvent(NDS::LOAD_BIOS7, std::filesystem::path(ini["files"]["bios7path"]));
 	}
 	if (ini["files"]["autoloadfirmware"] == "true") {
-		static std::filesystem::path path = ini["files"]["firmwarepath"];
-		ortin.nds.addThreadEvent(NDS::LOAD_FIRMWARE, &path);
+		ortin.nds.addThreadEvent(NDS::LOAD_FIRMWARE, std::filesystem::path(ini["files"]["firmwarepath"]));
 	}
 
 	// Setup Audio
 	desiredAudioSpec = {
 		.freq = 32768,
-		.format = AUDIO_U16,
+		.format = AUDIO_S16,
 		.channels = 2,
 		.samples = SAMPLE_BUFFER_SIZE,
 		.callback = audioCallback,
@@ -91,9 +94,12 @@ int main(int argc, char *argv[]) {
 				currentJoypad |= 1 << i;
 		}
 		currentJoypad |= ortin.penDown << 16;
-		if (currentJoypad != lastJoypad) {
-			ortin.nds.addThreadEvent(NDS::UPDATE_KEYS, currentJoypad);
+		ortin.nds.rewinding.store(ortin.nds.rewindEnabled && currentKeyStates[SDL_SCANCODE_R], std::memory_order_relaxed);
+		u16 currentTouch = (ortin.touchY << 8) | ortin.touchX;
+		if ((currentJoypad != lastJoypad) || (currentTouch != lastTouch)) {
+			ortin.nds.addThreadEvent(NDS::UPDATE_KEYS, NDS::KeyState{currentJoypad, ortin.touchX, ortin.touchY});
 			lastJoypad = currentJoypad;
+			lastTouch = currentTouch;
 		}
 
 		// Count FPS
@@ -104,16 +110,16 @@ int main(int argc, char *argv[]) {
 		}
 
 		// Set window name
-		std::string windowName = "Ortin - " + ortin.nds.romInfo.filePath.string() + " - " + std::to_string(emuThreadFps) + "FPS";
+		std::string windowName = "Ortin - " + ortin.nds.romInfo.filePath.string() + " - " + std::to_string(emuThreadFps) + "FPS (" + std::to_string((int)ortin.nds.pacer.speedPercent) + "%)";
 		SDL_SetWindowTitle(ortin.window, windowName.c_str());
 
 		// Update display texture
 		//auto ppu = ortin.nds.ppu;
 		if (ortin.nds.ppu->updateScreen) {
 			glBindTexture(GL_TEXTURE_2D, ortin.engineATexture);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB5_A1, 256, 192, 0, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, ortin.nds.ppu->framebufferA);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB5_A1, 256, 192, 0, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, ortin.nds.getFramebuffer(0));
 			glBindTexture(GL_TEXTURE_2D, ortin.engineBTexture);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB5_A1, 256, 192, 0, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, ortin.nds.ppu->framebufferB);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB5_A1, 256, 192, 0, GL_RGBA, GL_UNSIGNED_SHORT_1_5_5_5_REV, ortin.nds.getFramebuffer(1));
 			ortin.nds.ppu->updateScreen = false;
 		}
 
@@ -1,6 +1,7 @@
 #include "menus/debug.hpp"
 #include "imgui_memory_editor.h"
 
+#include <algorithm>
 #include <fstream>
 
 // NDS Components
@@ -38,6 +39,12 @@ void DebugMenu::drawMenu() {
 		ImGui::MenuItem("Memory", nullptr, &showMemEditor);
 		ImGui::MenuItem("NDS9 IO", nullptr, &showIoReg9);
 		ImGui::MenuItem("NDS7 IO", nullptr, &showIoReg7);
+		ImGui::Separator();
+
+		ImGui::Checkbox("Record History", &ortin.nds.timeTravelEnabled);
+		ImGui::SliderInt("Keyframe Interval", &ortin.nds.keyframeInterval, 1, 300, "%d frames");
+		ImGui::SliderInt("History Budget", &ortin.nds.timeTravelBudget, 64, 8192, "%dMB", ImGuiSliderFlags_Logarithmic);
+		ImGui::Text("Keyframes: %zu (%zuMB)", ortin.nds.history.keyframes.size(), ortin.nds.history.memoryUsed >> 20);
 
 		ImGui::EndMenu();
 	}
@@ -153,6 +160,14 @@ template <typename T> void DebugMenu::armDebugWindow(T& cpu) {
 	if (ImGui::Button("Step")) {
 		ortin.nds.addThreadEvent(isNds9 ? NDS::STEP_ARM9 : NDS::STEP_ARM7);
 	}
+	if (ortin.nds.timeTravelEnabled && !ortin.nds.running) {
+		ImGui::SameLine();
+		if (ImGui::Button("Step Back"))
+			ortin.nds.addThreadEvent(isNds9 ? NDS::REVERSE_STEP_ARM9 : NDS::REVERSE_STEP_ARM7);
+		ImGui::SameLine();
+		if (ImGui::Button("Reverse Continue"))
+			ortin.nds.addThreadEvent(NDS::REVERSE_CONTINUE);
+	}
 	ImGui::SameLine();
 	ImGui::Checkbox("Trace Instructions", isNds9 ? &ortin.nds.traceArm9 : &ortin.nds.traceArm7);
 	ImGui::Separator();
@@ -439,8 +454,8 @@ void DebugMenu::memEditorWindow() {
 		{"Shared WRAM (32KB)", ortin.nds.shared->wram, 0x8000, false},
 
 		{"--ARM9 Only--", NULL, 0, true},
-		{"Instruction TCM (32KB)", ortin.nds.nds9->cpu->cp15.itcm, 0x8000, false},
-		{"Data TCM (16KB)", ortin.nds.nds9->cpu->cp15.dtcm, 0x4000, false},
+		{"Instruction TCM (32KB)", ortin.nds.nds9->itcm, 0x8000, false},
+		{"Data TCM (16KB)", ortin.nds.nds9->dtcm, 0x4000, false},
 		{"Standard Palettes (2KB mirrored 0x5000000 to 0x6000000)", ortin.nds.ppu->pram, 0x800, false},
 		{"OAM (2KB mirrored 0x7000000 to 0x8000000)", ortin.nds.ppu->oam, 0x800, false},
 		{"ARM9 BIOS (4KB 0xFFFF0000 to 0xFFFF1000)", ortin.nds.nds9->bios, 0x1000, false},
@@ -477,29 +492,35 @@ void DebugMenu::memEditorWindow() {
 		ImGui::EndCombo();
 	}
 
+	if (ImGui::TreeNode("Arena Layout")) {
+		auto& memory = ortin.nds.shared->memory;
+		const char *pageTypes[] = {"4KB pages", "Transparent huge pages", "Huge pages"};
+		ImGui::Text("Base: %p  Size: %zuKB  %s", memory.base, GuestMemory::SIZE >> 10, pageTypes[memory.pageType]);
+
+		if (ImGui::BeginTable("arenaLayout", 3, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_BordersInnerV)) {
+			for (auto& region : GuestMemory::layout) {
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(0);
+				ImGui::Text("%s", region.name);
+				ImGui::TableNextColumn();
+				ImGui::Text("+0x%06zX", region.offset);
+				ImGui::TableNextColumn();
+				ImGui::Text("%zuKB", region.size >> 10);
+			}
+			ImGui::EndTable();
+		}
+		ImGui::TreePop();
+	}
+
 	memEditor.DrawContents(memoryRegions[selectedRegion].pointer, memoryRegions[selectedRegion].size);
 
 	ImGui::End();
 }
 
-enum InputType {
-	TEXT_BOX,
-	TEXT_BOX_HEX,
-	CHECKBOX,
-	COMBO,
-	SPECIAL
-};
-
-struct IoField {
-	std::string_view name;
-	int startBit;
-	int length;
-	InputType type;
-	const char *comboText;
-};
+using enum IoFieldType;
 
 struct IoRegister {
-	std::string_view name;
+	std::string name;
 	std::string_view description;
 	u32 address;
 	int size;
@@ -509,7 +530,32 @@ struct IoRegister {
 	std::vector<IoField> fields;
 };
 
-static const std::vector<IoRegister> registers9 = {{
+// Adds the entries for one of the register tables the bus uses
+static void addTable(std::vector<IoRegister> &registers, std::span<const IoRegisterInfo> table, void *object, std::string_view prefix = "", u32 offset = 0) {
+	for (auto &reg : table) {
+		registers.push_back({fmt::format("{}{}", prefix, reg.name), reg.description, reg.address + offset, reg.size, reg.readMask != 0, reg.writeMask != 0,
+			(u8 *)object + reg.offset, {reg.fields.begin(), reg.fields.end()}});
+	}
+}
+
+// The 2D engine and DMA registers are generated from the tables the bus uses, the 2D engine ones once for each engine
+static std::vector<IoRegister> withTableRegisters9(std::vector<IoRegister> registers) {
+	addTable(registers, ppuEngineRegisters, &ortin.nds.ppu->engineA, "(A) ");
+	addTable(registers, ppuEngineRegisters, &ortin.nds.ppu->engineB, "(B) ", 0x1000);
+	addTable(registers, dma9Registers, static_cast<DmaRegisters *>(ortin.nds.nds9->dma.get()));
+
+	std::stable_sort(registers.begin(), registers.end(), [](auto &a, auto &b) { return a.address < b.address; });
+	return registers;
+}
+
+static std::vector<IoRegister> withTableRegisters7(std::vector<IoRegister> registers) {
+	addTable(registers, dma7Registers, static_cast<DmaRegisters *>(ortin.nds.nds7->dma.get()));
+
+	std::stable_sort(registers.begin(), registers.end(), [](auto &a, auto &b) { return a.address < b.address; });
+	return registers;
+}
+
+static const std::vector<IoRegister> registers9 = withTableRegisters9({{
 	{"(A) DISPCNT", "LCD Control", 0x4000000, 4, true, true, &ortin.nds.ppu->engineA.DISPCNT, {
 		{"BG Mode", 0, 3, TEXT_BOX},
 		{"BG0 2D/3D Selection", 3, 1, COMBO, "2D\0"
@@ -551,259 +597,6 @@ static const std::vector<IoRegister> registers9 = {{
 		{"VCOUNT Compare Value", 7, 9, SPECIAL}}},
 	{"VCOUNT", "Vertical Counter", 0x4000006, 2, true, false, &ortin.nds.ppu->VCOUNT, {
 		{"Current Scanline (LY)", 0, 9, TEXT_BOX}}},
-	{"(A) BG0CNT", "BG0 Control", 0x4000008, 2, true, true, &ortin.nds.ppu->engineA.bg[0].BGCNT, {
-		{"BG Priority", 0, 2, TEXT_BOX},
-		{"Character Base Block", 2, 4, TEXT_BOX},
-		{"Mosaic", 6, 1, CHECKBOX},
-		{"Colors/Palettes", 7, 1, COMBO, "16/16\0"
-										 "256/1\0\0"},
-		{"Screen Base Block", 8, 5, TEXT_BOX},
-		{"Ext Palette Slot", 13, 1, COMBO, "Slot 0\0"
-										   "Slot2\0\0"},
-		{"Screen Size", 14, 2, TEXT_BOX}}},
-	{"(A) BG1CNT", "BG1 Control", 0x400000A, 2, true, true, &ortin.nds.ppu->engineA.bg[1].BGCNT, {
-		{"BG Priority", 0, 2, TEXT_BOX},
-		{"Character Base Block", 2, 4, TEXT_BOX},
-		{"Mosaic", 6, 1, CHECKBOX},
-		{"Colors/Palettes", 7, 1, COMBO, "16/16\0"
-										 "256/1\0\0"},
-		{"Screen Base Block", 8, 5, TEXT_BOX},
-		{"Ext Palette Slot", 13, 1, COMBO, "Slot 1\0"
-										   "Slot3\0\0"},
-		{"Screen Size", 14, 2, TEXT_BOX}}},
-	{"(A) BG2CNT", "BG2 Control", 0x400000C, 2, true, true, &ortin.nds.ppu->engineA.bg[2].BGCNT, {
-		{"BG Priority", 0, 2, TEXT_BOX},
-		{"Character Base Block", 2, 4, TEXT_BOX},
-		{"Mosaic", 6, 1, CHECKBOX},
-		{"Colors/Palettes", 7, 1, COMBO, "16/16\0"
-										 "256/1\0\0"},
-		{"Screen Base Block", 8, 5, TEXT_BOX},
-		{"Display Area Overflow", 13, 1, COMBO, "Transparent\0"
-												"Wraparound\0\0"},
-		{"Screen Size", 14, 2, TEXT_BOX}}},
-	{"(A) BG3CNT", "BG3 Control", 0x400000E, 2, true, true, &ortin.nds.ppu->engineA.bg[3].BGCNT, {
-		{"BG Priority", 0, 2, TEXT_BOX},
-		{"Character Base Block", 2, 4, TEXT_BOX},
-		{"Mosaic", 6, 1, CHECKBOX},
-		{"Colors/Palettes", 7, 1, COMBO, "16/16\0"
-										 "256/1\0\0"},
-		{"Screen Base Block", 8, 5, TEXT_BOX},
-		{"Display Area Overflow", 13, 1, COMBO, "Transparent\0"
-												"Wraparound\0\0"},
-		{"Screen Size", 14, 2, TEXT_BOX}}},
-	{"(A) BG0HOFS", "BG0 X-Offset", 0x4000010, 2, false, true, &ortin.nds.ppu->engineA.bg[0].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(A) BG0VOFS", "BG0 Y-Offset", 0x4000012, 2, false, true, &ortin.nds.ppu->engineA.bg[0].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(A) BG1HOFS", "BG1 X-Offset", 0x4000014, 2, false, true, &ortin.nds.ppu->engineA.bg[1].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(A) BG1VOFS", "BG1 Y-Offset", 0x4000016, 2, false, true, &ortin.nds.ppu->engineA.bg[1].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(A) BG2HOFS", "BG2 X-Offset", 0x4000018, 2, false, true, &ortin.nds.ppu->engineA.bg[2].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(A) BG2VOFS", "BG2 Y-Offset", 0x400001A, 2, false, true, &ortin.nds.ppu->engineA.bg[2].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(A) BG3HOFS", "BG3 X-Offset", 0x400001C, 2, false, true, &ortin.nds.ppu->engineA.bg[3].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(A) BG3VOFS", "BG3 Y-Offset", 0x400001E, 2, false, true, &ortin.nds.ppu->engineA.bg[3].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(A) BG2PA", "BG2 Rotation/Scaling Parameter A (alias dx)", 0x4000020, 2, false, true, &ortin.nds.ppu->engineA.bg[2].BGPA, {
-		{"BG2 Rotation/Scaling Parameter A", 0, 16, TEXT_BOX_HEX},
-		{"BG2 Rotation/Scaling Parameter A", 0, 16, SPECIAL}}},
-	{"(A) BG2PB", "BG2 Rotation/Scaling Parameter B (alias dmx)", 0x4000022, 2, false, true, &ortin.nds.ppu->engineA.bg[2].BGPB, {
-		{"BG2 Rotation/Scaling Parameter B", 0, 16, TEXT_BOX_HEX},
-		{"BG2 Rotation/Scaling Parameter B", 0, 16, SPECIAL}}},
-	{"(A) BG2PC", "BG2 Rotation/Scaling Parameter C (alias dy)", 0x4000024, 2, false, true, &ortin.nds.ppu->engineA.bg[2].BGPC, {
-		{"BG2 Rotation/Scaling Parameter C", 0, 16, TEXT_BOX_HEX},
-		{"BG2 Rotation/Scaling Parameter C", 0, 16, SPECIAL}}},
-	{"(A) BG2PD", "BG2 Rotation/Scaling Parameter D (alias dmy)", 0x4000026, 2, false, true, &ortin.nds.ppu->engineA.bg[2].BGPD, {
-		{"BG2 Rotation/Scaling Parameter D", 0, 16, TEXT_BOX_HEX},
-		{"BG2 Rotation/Scaling Parameter D", 0, 16, SPECIAL}}},
-	{"(A) BG2X", "BG2 Reference Point X-Coordinate", 0x4000028, 4, false, true, &ortin.nds.ppu->engineA.bg[2].BGX, {
-		{"BG2 Reference Point X-Coordinate", 0, 28, TEXT_BOX_HEX},
-		{"BG2 Reference Point X-Coordinate", 0, 28, SPECIAL}}},
-	{"(A) BG2Y", "BG2 Reference Point Y-Coordinate", 0x400002C, 4, false, true, &ortin.nds.ppu->engineA.bg[2].BGY, {
-		{"BG2 Reference Point Y-Coordinate", 0, 28, TEXT_BOX_HEX},
-		{"BG2 Reference Point Y-Coordinate", 0, 28, SPECIAL}}},
-	{"(A) BG3PA", "BG3 Rotation/Scaling Parameter A (alias dx)", 0x4000030, 2, false, true, &ortin.nds.ppu->engineA.bg[3].BGPA, {
-		{"BG3 Rotation/Scaling Parameter A", 0, 16, TEXT_BOX_HEX},
-		{"BG3 Rotation/Scaling Parameter A", 0, 16, SPECIAL}}},
-	{"(A) BG3PB", "BG3 Rotation/Scaling Parameter B (alias dmx)", 0x4000032, 2, false, true, &ortin.nds.ppu->engineA.bg[3].BGPB, {
-		{"BG3 Rotation/Scaling Parameter B", 0, 16, TEXT_BOX_HEX},
-		{"BG3 Rotation/Scaling Parameter B", 0, 16, SPECIAL}}},
-	{"(A) BG3PC", "BG3 Rotation/Scaling Parameter C (alias dy)", 0x4000034, 2, false, true, &ortin.nds.ppu->engineA.bg[3].BGPC, {
-		{"BG3 Rotation/Scaling Parameter C", 0, 16, TEXT_BOX_HEX},
-		{"BG3 Rotation/Scaling Parameter C", 0, 16, SPECIAL}}},
-	{"(A) BG3PD", "BG3 Rotation/Scaling Parameter D (alias dmy)", 0x4000036, 2, false, true, &ortin.nds.ppu->engineA.bg[3].BGPD, {
-		{"BG3 Rotation/Scaling Parameter D", 0, 16, TEXT_BOX_HEX},
-		{"BG3 Rotation/Scaling Parameter D", 0, 16, SPECIAL}}},
-	{"(A) BG3X", "BG3 Reference Point X-Coordinate", 0x4000038, 4, false, true, &ortin.nds.ppu->engineA.bg[3].BGX, {
-		{"BG3 Reference Point X-Coordinate", 0, 28, TEXT_BOX_HEX},
-		{"BG3 Reference Point X-Coordinate", 0, 28, SPECIAL}}},
-	{"(A) BG3Y", "BG3 Reference Point Y-Coordinate", 0x400003C, 4, false, true, &ortin.nds.ppu->engineA.bg[3].BGY, {
-		{"BG3 Reference Point Y-Coordinate", 0, 28, TEXT_BOX_HEX},
-		{"BG3 Reference Point Y-Coordinate", 0, 28, SPECIAL}}},
-	{"(A) WIN0H", "Window 0 Horizontal Dimensions", 0x4000040, 2, false, true, &ortin.nds.ppu->engineA.WIN0H, {
-		{"X2, Rightmost coordinate of window, plus 1", 0, 8, TEXT_BOX},
-		{"X1, Leftmost coordinate of window", 8, 8, TEXT_BOX}}},
-	{"(A) WIN1H", "Window 1 Horizontal Dimensions", 0x4000042, 2, false, true, &ortin.nds.ppu->engineA.WIN1H, {
-		{"X2, Rightmost coordinate of window, plus 1", 0, 8, TEXT_BOX},
-		{"X1, Leftmost coordinate of window", 8, 8, TEXT_BOX}}},
-	{"(A) WIN0V", "Window 0 Vertical Dimensions", 0x4000044, 2, false, true, &ortin.nds.ppu->engineA.WIN0V, {
-		{"Y2, Bottom-most coordinate of window, plus 1", 0, 8, TEXT_BOX},
-		{"Y1, Top-most coordinate of window", 8, 8, TEXT_BOX}}},
-	{"(A) WIN1V", "Window 0 Vertical Dimensions", 0x4000046, 2, false, true, &ortin.nds.ppu->engineA.WIN1V, {
-		{"Y2, Bottom-most coordinate of window, plus 1", 0, 8, TEXT_BOX},
-		{"Y1, Top-most coordinate of window", 8, 8, TEXT_BOX}}},
-	{"(A) WININ", "Control of Inside of Window(s)", 0x4000048, 2, true, true, &ortin.nds.ppu->engineA.WININ, {
-		{"Window 0 BG0 Enable Bit", 0, 1, CHECKBOX},
-		{"Window 0 BG1 Enable Bit", 1, 1, CHECKBOX},
-		{"Window 0 BG2 Enable Bit", 2, 1, CHECKBOX},
-		{"Window 0 BG3 Enable Bit", 3, 1, CHECKBOX},
-		{"Window 0 OBJ Enable Bit", 4, 1, CHECKBOX},
-		{"Window 0 Color Special Effect", 5, 1, CHECKBOX},
-		{"Window 1 BG0 Enable Bit", 8, 1, CHECKBOX},
-		{"Window 1 BG1 Enable Bit", 9, 1, CHECKBOX},
-		{"Window 1 BG2 Enable Bit", 10, 1, CHECKBOX},
-		{"Window 1 BG3 Enable Bit", 11, 1, CHECKBOX},
-		{"Window 1 OBJ Enable Bit", 12, 1, CHECKBOX},
-		{"Window 1 Color Special Effect", 13, 1, CHECKBOX}}},
-	{"(A) WINOUT", "Control of Outside of Windows & Inside of OBJ Window", 0x400004A, 2, true, true, &ortin.nds.ppu->engineA.WINOUT, {
-		{"Outside BG0 Enable Bit", 0, 1, CHECKBOX},
-		{"Outside BG1 Enable Bit", 1, 1, CHECKBOX},
-		{"Outside BG2 Enable Bit", 2, 1, CHECKBOX},
-		{"Outside BG3 Enable Bit", 3, 1, CHECKBOX},
-		{"Outside OBJ Enable Bit", 4, 1, CHECKBOX},
-		{"Outside Color Special Effect", 5, 1, CHECKBOX},
-		{"OBJ Window BG0 Enable Bit", 8, 1, CHECKBOX},
-		{"OBJ Window BG1 Enable Bit", 9, 1, CHECKBOX},
-		{"OBJ Window BG2 Enable Bit", 10, 1, CHECKBOX},
-		{"OBJ Window BG3 Enable Bit", 11, 1, CHECKBOX},
-		{"OBJ Window OBJ Enable Bit", 12, 1, CHECKBOX},
-		{"OBJ Window Color Special Effect", 13, 1, CHECKBOX}}},
-	{"(A) MOSAIC", "Mosaic Size", 0x400004C, 2, false, true, &ortin.nds.ppu->engineA.MOSAIC, {
-		{"BG Mosaic H-Size (minus 1)", 0, 4, TEXT_BOX},
-		{"BG Mosaic V-Size (minus 1)", 4, 4, TEXT_BOX},
-		{"OBJ Mosaic H-Size (minus 1)", 8, 4, TEXT_BOX},
-		{"OBJ Mosaic V-Size (minus 1)", 12, 4, TEXT_BOX}}},
-	{"(A) MASTER_BRIGHT", "Master Brightness Up/Down", 0x400006C, 2, true, true, &ortin.nds.ppu->engineA.MASTER_BRIGHT, {
-		{"Factor used for 6bit R,G,B Intensities", 0, 5, TEXT_BOX},
-		{"Mode", 14, 2, COMBO, "Disable\0"
-							   "Up\0"
-							   "Down\0"
-							   "Reserved\0\0"}}},
-	{"DMA0SAD", "DMA 0 Source Address", 0x40000B0, 4, true, true, &ortin.nds.nds9->dma->channel[0].DMASAD, {
-		{"DMA 0 Source Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA0DAD", "DMA 0 Destination Address", 0x40000B4, 4, true, true, &ortin.nds.nds9->dma->channel[0].DMADAD, {
-		{"DMA 0 Destination Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA0CNT", "DMA 0 Control", 0x40000B8, 4, true, true, &ortin.nds.nds9->dma->channel[0].DMACNT, {
-		{"Word Count", 0, 21, TEXT_BOX_HEX},
-		{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
-											"Decrement\0"
-											"Fixed\0"
-											"Increment/Reload\0\0"},
-		{"Source Adr Control", 23, 2, COMBO, "Increment\0"
-											 "Decrement\0"
-											 "Fixed\0"
-											 "Prohibited\0\0"},
-		{"DMA Repeat", 25, 1, CHECKBOX},
-		{"DMA Transfer Type", 26, 1, CHECKBOX},
-		{"DMA Start Timing", 27, 3, COMBO, "Start Immediately\0"
-										   "Start at V-Blank\0"
-										   "Start at H-Blank\0"
-										   "Synchronize to start of display\0"
-										   "Main memory display\0"
-										   "DS Cartridge Slot\0"
-										   "GBA Cartridge Slot\0"
-										   "Geometry Command FIFO\0\0"},
-		{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
-		{"DMA Enable", 31, 1, CHECKBOX}}},
-	{"DMA1SAD", "DMA 1 Source Address", 0x40000BC, 4, true, true, &ortin.nds.nds9->dma->channel[1].DMASAD, {
-		{"DMA 0 Source Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA1DAD", "DMA 1 Destination Address", 0x40000C0, 4, true, true, &ortin.nds.nds9->dma->channel[1].DMADAD, {
-		{"DMA 0 Destination Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA1CNT", "DMA 1 Control", 0x40000C4, 4, true, true, &ortin.nds.nds9->dma->channel[1].DMACNT, {
-		{"Word Count", 0, 21, TEXT_BOX_HEX},
-		{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
-											"Decrement\0"
-											"Fixed\0"
-											"Increment/Reload\0\0"},
-		{"Source Adr Control", 23, 2, COMBO, "Increment\0"
-											 "Decrement\0"
-											 "Fixed\0"
-											 "Prohibited\0\0"},
-		{"DMA Repeat", 25, 1, CHECKBOX},
-		{"DMA Transfer Type", 26, 1, CHECKBOX},
-		{"DMA Start Timing", 27, 3, COMBO, "Start Immediately\0"
-										   "Start at V-Blank\0"
-										   "Start at H-Blank\0"
-										   "Synchronize to start of display\0"
-										   "Main memory display\0"
-										   "DS Cartridge Slot\0"
-										   "GBA Cartridge Slot\0"
-										   "Geometry Command FIFO\0\0"},
-		{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
-		{"DMA Enable", 31, 1, CHECKBOX}}},
-	{"DMA2SAD", "DMA 2 Source Address", 0x40000C8, 4, true, true, &ortin.nds.nds9->dma->channel[2].DMASAD, {
-		{"DMA 0 Source Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA2DAD", "DMA 2 Destination Address", 0x40000CC, 4, true, true, &ortin.nds.nds9->dma->channel[2].DMADAD, {
-		{"DMA 0 Destination Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA2CNT", "DMA 2 Control", 0x40000D0, 4, true, true, &ortin.nds.nds9->dma->channel[2].DMACNT, {
-		{"Word Count", 0, 21, TEXT_BOX_HEX},
-		{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
-											"Decrement\0"
-											"Fixed\0"
-											"Increment/Reload\0\0"},
-		{"Source Adr Control", 23, 2, COMBO, "Increment\0"
-											 "Decrement\0"
-											 "Fixed\0"
-											 "Prohibited\0\0"},
-		{"DMA Repeat", 25, 1, CHECKBOX},
-		{"DMA Transfer Type", 26, 1, CHECKBOX},
-		{"DMA Start Timing", 27, 3, COMBO, "Start Immediately\0"
-										   "Start at V-Blank\0"
-										   "Start at H-Blank\0"
-										   "Synchronize to start of display\0"
-										   "Main memory display\0"
-										   "DS Cartridge Slot\0"
-										   "GBA Cartridge Slot\0"
-										   "Geometry Command FIFO\0\0"},
-		{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
-		{"DMA Enable", 31, 1, CHECKBOX}}},
-	{"DMA3SAD", "DMA 3 Source Address", 0x40000D4, 4, true, true, &ortin.nds.nds9->dma->channel[3].DMASAD, {
-		{"DMA 0 Source Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA3DAD", "DMA 3 Destination Address", 0x40000D8, 4, true, true, &ortin.nds.nds9->dma->channel[3].DMADAD, {
-		{"DMA 0 Destination Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA3CNT", "DMA 3 Control", 0x40000DC, 4, true, true, &ortin.nds.nds9->dma->channel[3].DMACNT, {
-		{"Word Count", 0, 21, TEXT_BOX_HEX},
-		{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
-											"Decrement\0"
-											"Fixed\0"
-											"Increment/Reload\0\0"},
-		{"Source Adr Control", 23, 2, COMBO, "Increment\0"
-											 "Decrement\0"
-											 "Fixed\0"
-											 "Prohibited\0\0"},
-		{"DMA Repeat", 25, 1, CHECKBOX},
-		{"DMA Transfer Type", 26, 1, CHECKBOX},
-		{"DMA Start Timing", 27, 3, COMBO, "Start Immediately\0"
-										   "Start at V-Blank\0"
-										   "Start at H-Blank\0"
-										   "Synchronize to start of display\0"
-										   "Main memory display\0"
-										   "DS Cartridge Slot\0"
-										   "GBA Cartridge Slot\0"
-										   "Geometry Command FIFO\0\0"},
-		{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
-		{"DMA Enable", 31, 1, CHECKBOX}}},
-	{"DMA0FILL", "DMA 0 Filldata", 0x40000E0, 4, true, true, &ortin.nds.nds9->dma->DMA0FILL, {
-		{"DMA 0 Filldata", 0, 32, TEXT_BOX_HEX}}},
-	{"DMA1FILL", "DMA 1 Filldata", 0x40000E4, 4, true, true, &ortin.nds.nds9->dma->DMA1FILL, {
-		{"DMA 1 Filldata", 0, 32, TEXT_BOX_HEX}}},
-	{"DMA2FILL", "DMA 2 Filldata", 0x40000E8, 4, true, true, &ortin.nds.nds9->dma->DMA2FILL, {
-		{"DMA 2 Filldata", 0, 32, TEXT_BOX_HEX}}},
-	{"DMA3FILL", "DMA 3 Filldata", 0x40000EC, 4, true, true, &ortin.nds.nds9->dma->DMA3FILL, {
-		{"DMA 3 Filldata", 0, 32, TEXT_BOX_HEX}}},
 	{"TM0CNT_L", "Timer 0 Counter/Reload", 0x4000100, 2, true, true, &ortin.nds.nds9->timer->timer[0].TIMCNT_L, {
 		{"Counter(R)/Reload(W)", 0, 16, TEXT_BOX_HEX}}},
 	{"TM0CNT_H", "Timer 0 Control", 0x4000102, 2, true, true, &ortin.nds.nds9->timer->timer[0].TIMCNT_H, {
@@ -1062,164 +855,7 @@ static const std::vector<IoRegister> registers9 = {{
 		{"OBJ Processing during H-Blank", 23, 1, CHECKBOX},
 		{"BG Extended Palettes", 30, 1, CHECKBOX},
 		{"OBJ Extended Palettes", 31, 1, CHECKBOX}}},
-	{"(B) BG0CNT", "BG0 Control", 0x4001008, 2, true, true, &ortin.nds.ppu->engineB.bg[0].BGCNT, {
-		{"BG Priority", 0, 2, TEXT_BOX},
-		{"Character Base Block", 2, 4, TEXT_BOX},
-		{"Mosaic", 6, 1, CHECKBOX},
-		{"Colors/Palettes", 7, 1, COMBO, "16/16\0"
-										 "256/1\0\0"},
-		{"Screen Base Block", 8, 5, TEXT_BOX},
-		{"Ext Palette Slot", 13, 1, COMBO, "Slot 0\0"
-										   "Slot2\0\0"},
-		{"Screen Size", 14, 2, TEXT_BOX}}},
-	{"(B) BG1CNT", "BG1 Control", 0x400100A, 2, true, true, &ortin.nds.ppu->engineB.bg[1].BGCNT, {
-		{"BG Priority", 0, 2, TEXT_BOX},
-		{"Character Base Block", 2, 4, TEXT_BOX},
-		{"Mosaic", 6, 1, CHECKBOX},
-		{"Colors/Palettes", 7, 1, COMBO, "16/16\0"
-										 "256/1\0\0"},
-		{"Screen Base Block", 8, 5, TEXT_BOX},
-		{"Ext Palette Slot", 13, 1, COMBO, "Slot 1\0"
-										   "Slot3\0\0"},
-		{"Screen Size", 14, 2, TEXT_BOX}}},
-	{"(B) BG2CNT", "BG2 Control", 0x400100C, 2, true, true, &ortin.nds.ppu->engineB.bg[2].BGCNT, {
-		{"BG Priority", 0, 2, TEXT_BOX},
-		{"Character Base Block", 2, 4, TEXT_BOX},
-		{"Mosaic", 6, 1, CHECKBOX},
-		{"Colors/Palettes", 7, 1, COMBO, "16/16\0"
-										 "256/1\0\0"},
-		{"Screen Base Block", 8, 5, TEXT_BOX},
-		{"Display Area Overflow", 13, 1, COMBO, "Transparent\0"
-												"Wraparound\0\0"},
-		{"Screen Size", 14, 2, TEXT_BOX}}},
-	{"(B) BG3CNT", "BG3 Control", 0x400100E, 2, true, true, &ortin.nds.ppu->engineB.bg[3].BGCNT, {
-		{"BG Priority", 0, 2, TEXT_BOX},
-		{"Character Base Block", 2, 4, TEXT_BOX},
-		{"Mosaic", 6, 1, CHECKBOX},
-		{"Colors/Palettes", 7, 1, COMBO, "16/16\0"
-										 "256/1\0\0"},
-		{"Screen Base Block", 8, 5, TEXT_BOX},
-		{"Display Area Overflow", 13, 1, COMBO, "Transparent\0"
-												"Wraparound\0\0"},
-		{"Screen Size", 14, 2, TEXT_BOX}}},
-	{"(B) BG0HOFS", "BG0 X-Offset", 0x4001010, 2, false, true, &ortin.nds.ppu->engineB.bg[0].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG0VOFS", "BG0 Y-Offset", 0x4001012, 2, false, true, &ortin.nds.ppu->engineB.bg[0].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG1HOFS", "BG1 X-Offset", 0x4001014, 2, false, true, &ortin.nds.ppu->engineB.bg[1].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG1VOFS", "BG1 Y-Offset", 0x4001016, 2, false, true, &ortin.nds.ppu->engineB.bg[1].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG2HOFS", "BG2 X-Offset", 0x4001018, 2, false, true, &ortin.nds.ppu->engineB.bg[2].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG2VOFS", "BG2 Y-Offset", 0x400101A, 2, false, true, &ortin.nds.ppu->engineB.bg[2].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG3HOFS", "BG3 X-Offset", 0x400101C, 2, false, true, &ortin.nds.ppu->engineB.bg[3].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG3VOFS", "BG3 Y-Offset", 0x400101E, 2, false, true, &ortin.nds.ppu->engineB.bg[3].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG0HOFS", "BG0 X-Offset", 0x4001010, 2, false, true, &ortin.nds.ppu->engineB.bg[0].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG0VOFS", "BG0 Y-Offset", 0x4001012, 2, false, true, &ortin.nds.ppu->engineB.bg[0].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG1HOFS", "BG1 X-Offset", 0x4001014, 2, false, true, &ortin.nds.ppu->engineB.bg[1].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG1VOFS", "BG1 Y-Offset", 0x4001016, 2, false, true, &ortin.nds.ppu->engineB.bg[1].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG2HOFS", "BG2 X-Offset", 0x4001018, 2, false, true, &ortin.nds.ppu->engineB.bg[2].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG2VOFS", "BG2 Y-Offset", 0x400101A, 2, false, true, &ortin.nds.ppu->engineB.bg[2].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG3HOFS", "BG3 X-Offset", 0x400101C, 2, false, true, &ortin.nds.ppu->engineB.bg[3].BGHOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG3VOFS", "BG3 Y-Offset", 0x400101E, 2, false, true, &ortin.nds.ppu->engineB.bg[3].BGVOFS, {
-		{"Offset", 0, 9, TEXT_BOX}}},
-	{"(B) BG2PA", "BG2 Rotation/Scaling Parameter A (alias dx)", 0x4001020, 2, false, true, &ortin.nds.ppu->engineB.bg[2].BGPA, {
-		{"BG2 Rotation/Scaling Parameter A", 0, 16, TEXT_BOX_HEX},
-		{"BG2 Rotation/Scaling Parameter A", 0, 16, SPECIAL}}},
-	{"(B) BG2PB", "BG2 Rotation/Scaling Parameter B (alias dmx)", 0x4001022, 2, false, true, &ortin.nds.ppu->engineB.bg[2].BGPB, {
-		{"BG2 Rotation/Scaling Parameter B", 0, 16, TEXT_BOX_HEX},
-		{"BG2 Rotation/Scaling Parameter B", 0, 16, SPECIAL}}},
-	{"(B) BG2PC", "BG2 Rotation/Scaling Parameter C (alias dy)", 0x4001024, 2, false, true, &ortin.nds.ppu->engineB.bg[2].BGPC, {
-		{"BG2 Rotation/Scaling Parameter C", 0, 16, TEXT_BOX_HEX},
-		{"BG2 Rotation/Scaling Parameter C", 0, 16, SPECIAL}}},
-	{"(B) BG2PD", "BG2 Rotation/Scaling Parameter D (alias dmy)", 0x4001026, 2, false, true, &ortin.nds.ppu->engineB.bg[2].BGPD, {
-		{"BG2 Rotation/Scaling Parameter D", 0, 16, TEXT_BOX_HEX},
-		{"BG2 Rotation/Scaling Parameter D", 0, 16, SPECIAL}}},
-	{"(B) BG2X", "BG2 Reference Point X-Coordinate", 0x4001028, 4, false, true, &ortin.nds.ppu->engineB.bg[2].BGX, {
-		{"BG2 Reference Point X-Coordinate", 0, 28, TEXT_BOX_HEX},
-		{"BG2 Reference Point X-Coordinate", 0, 28, SPECIAL}}},
-	{"(B) BG2Y", "BG2 Reference Point Y-Coordinate", 0x400102C, 4, false, true, &ortin.nds.ppu->engineB.bg[2].BGY, {
-		{"BG2 Reference Point Y-Coordinate", 0, 28, TEXT_BOX_HEX},
-		{"BG2 Reference Point Y-Coordinate", 0, 28, SPECIAL}}},
-	{"(B) BG3PA", "BG3 Rotation/Scaling Parameter A (alias dx)", 0x4001030, 2, false, true, &ortin.nds.ppu->engineB.bg[3].BGPA, {
-		{"BG3 Rotation/Scaling Parameter A", 0, 16, TEXT_BOX_HEX},
-		{"BG3 Rotation/Scaling Parameter A", 0, 16, SPECIAL}}},
-	{"(B) BG3PB", "BG3 Rotation/Scaling Parameter B (alias dmx)", 0x4001032, 2, false, true, &ortin.nds.ppu->engineB.bg[3].BGPB, {
-		{"BG3 Rotation/Scaling Parameter B", 0, 16, TEXT_BOX_HEX},
-		{"BG3 Rotation/Scaling Parameter B", 0, 16, SPECIAL}}},
-	{"(B) BG3PC", "BG3 Rotation/Scaling Parameter C (alias dy)", 0x4001034, 2, false, true, &ortin.nds.ppu->engineB.bg[3].BGPC, {
-		{"BG3 Rotation/Scaling Parameter C", 0, 16, TEXT_BOX_HEX},
-		{"BG3 Rotation/Scaling Parameter C", 0, 16, SPECIAL}}},
-	{"(B) BG3PD", "BG3 Rotation/Scaling Parameter D (alias dmy)", 0x4001036, 2, false, true, &ortin.nds.ppu->engineB.bg[3].BGPD, {
-		{"BG3 Rotation/Scaling Parameter D", 0, 16, TEXT_BOX_HEX},
-		{"BG3 Rotation/Scaling Parameter D", 0, 16, SPECIAL}}},
-	{"(B) BG3X", "BG3 Reference Point X-Coordinate", 0x4001038, 4, false, true, &ortin.nds.ppu->engineB.bg[3].BGX, {
-		{"BG3 Reference Point X-Coordinate", 0, 28, TEXT_BOX_HEX},
-		{"BG3 Reference Point X-Coordinate", 0, 28, SPECIAL}}},
-	{"(B) BG3Y", "BG3 Reference Point Y-Coordinate", 0x400103C, 4, false, true, &ortin.nds.ppu->engineB.bg[3].BGY, {
-		{"BG3 Reference Point Y-Coordinate", 0, 28, TEXT_BOX_HEX},
-		{"BG3 Reference Point Y-Coordinate", 0, 28, SPECIAL}}},
-	{"(B) WIN0H", "Window 0 Horizontal Dimensions", 0x4001040, 2, false, true, &ortin.nds.ppu->engineB.WIN0H, {
-		{"X2, Rightmost coordinate of window, plus 1", 0, 8, TEXT_BOX},
-		{"X1, Leftmost coordinate of window", 8, 8, TEXT_BOX}}},
-	{"(B) WIN1H", "Window 1 Horizontal Dimensions", 0x4001042, 2, false, true, &ortin.nds.ppu->engineB.WIN1H, {
-		{"X2, Rightmost coordinate of window, plus 1", 0, 8, TEXT_BOX},
-		{"X1, Leftmost coordinate of window", 8, 8, TEXT_BOX}}},
-	{"(B) WIN0V", "Window 0 Vertical Dimensions", 0x4001044, 2, false, true, &ortin.nds.ppu->engineB.WIN0V, {
-		{"Y2, Bottom-most coordinate of window, plus 1", 0, 8, TEXT_BOX},
-		{"Y1, Top-most coordinate of window", 8, 8, TEXT_BOX}}},
-	{"(B) WIN1V", "Window 0 Vertical Dimensions", 0x4001046, 2, false, true, &ortin.nds.ppu->engineB.WIN1V, {
-		{"Y2, Bottom-most coordinate of window, plus 1", 0, 8, TEXT_BOX},
-		{"Y1, Top-most coordinate of window", 8, 8, TEXT_BOX}}},
-	{"(B) WININ", "Control of Inside of Window(s)", 0x4001048, 2, true, true, &ortin.nds.ppu->engineB.WININ, {
-		{"Window 0 BG0 Enable Bit", 0, 1, CHECKBOX},
-		{"Window 0 BG1 Enable Bit", 1, 1, CHECKBOX},
-		{"Window 0 BG2 Enable Bit", 2, 1, CHECKBOX},
-		{"Window 0 BG3 Enable Bit", 3, 1, CHECKBOX},
-		{"Window 0 OBJ Enable Bit", 4, 1, CHECKBOX},
-		{"Window 0 Color Special Effect", 5, 1, CHECKBOX},
-		{"Window 1 BG0 Enable Bit", 8, 1, CHECKBOX},
-		{"Window 1 BG1 Enable Bit", 9, 1, CHECKBOX},
-		{"Window 1 BG2 Enable Bit", 10, 1, CHECKBOX},
-		{"Window 1 BG3 Enable Bit", 11, 1, CHECKBOX},
-		{"Window 1 OBJ Enable Bit", 12, 1, CHECKBOX},
-		{"Window 1 Color Special Effect", 13, 1, CHECKBOX}}},
-	{"(B) WINOUT", "Control of Outside of Windows & Inside of OBJ Window", 0x400104A, 2, true, true, &ortin.nds.ppu->engineB.WINOUT, {
-		{"Outside BG0 Enable Bit", 0, 1, CHECKBOX},
-		{"Outside BG1 Enable Bit", 1, 1, CHECKBOX},
-		{"Outside BG2 Enable Bit", 2, 1, CHECKBOX},
-		{"Outside BG3 Enable Bit", 3, 1, CHECKBOX},
-		{"Outside OBJ Enable Bit", 4, 1, CHECKBOX},
-		{"Outside Color Special Effect", 5, 1, CHECKBOX},
-		{"OBJ Window BG0 Enable Bit", 8, 1, CHECKBOX},
-		{"OBJ Window BG1 Enable Bit", 9, 1, CHECKBOX},
-		{"OBJ Window BG2 Enable Bit", 10, 1, CHECKBOX},
-		{"OBJ Window BG3 Enable Bit", 11, 1, CHECKBOX},
-		{"OBJ Window OBJ Enable Bit", 12, 1, CHECKBOX},
-		{"OBJ Window Color Special Effect", 13, 1, CHECKBOX}}},
-	{"(B) MOSAIC", "Mosaic Size", 0x400104C, 2, false, true, &ortin.nds.ppu->engineB.MOSAIC, {
-		{"BG Mosaic H-Size (minus 1)", 0, 4, TEXT_BOX},
-		{"BG Mosaic V-Size (minus 1)", 4, 4, TEXT_BOX},
-		{"OBJ Mosaic H-Size (minus 1)", 8, 4, TEXT_BOX},
-		{"OBJ Mosaic V-Size (minus 1)", 12, 4, TEXT_BOX}}},
-	{"(B) MASTER_BRIGHT", "Master Brightness Up/Down", 0x400106C, 2, true, true, &ortin.nds.ppu->engineB.MASTER_BRIGHT, {
-		{"Factor used for 6bit R,G,B Intensities", 0, 5, TEXT_BOX},
-		{"Mode", 14, 2, COMBO, "Disable\0"
-							   "Up\0"
-							   "Down\0"
-							   "Reserved\0\0"}}},
-}};
+}});
 
 void DebugMenu::ioReg9Window() { // Shamefully stolen from the ImGui demo
 	static int selected = 0;
@@ -1284,7 +920,7 @@ void DebugMenu::ioReg9Window() { // Shamefully stolen from the ImGui demo
 				ImGui::Combo(((std::string)field.name).c_str(), (int *)&fValue, field.comboText);
 				break;
 			case SPECIAL:
-				switch (address) {
+				switch (address & ~0x1000) { // Engine B's registers are the same as engine A's
 				case 0x4000004: // DISPSTAT
 					fValue = numberInput(((std::string)field.name).c_str(), false, (fValue >> 1) | ((fValue & 1) << 8), mask >> field.startBit);
 					fValue = ((fValue & 0xFF) << 1) | (fValue >> 8);
@@ -1323,15 +959,11 @@ void DebugMenu::ioReg9Window() { // Shamefully stolen from the ImGui demo
 
 		if (ImGui::Button("Write")) {
 			if (size == 4) {
-				ortin.nds.nds9->writeIO(address | 0, (u8)(value >> 0), false);
-				ortin.nds.nds9->writeIO(address | 1, (u8)(value >> 8), false);
-				ortin.nds.nds9->writeIO(address | 2, (u8)(value >> 16), false);
-				ortin.nds.nds9->writeIO(address | 3, (u8)(value >> 24), true);
+				ortin.nds.nds9->io.write<u32>(address, value, true);
 			} else if (size == 2) {
-				ortin.nds.nds9->writeIO(address | 0, (u8)(value >> 0), false);
-				ortin.nds.nds9->writeIO(address | 1, (u8)(value >> 8), true);
+				ortin.nds.nds9->io.write<u16>(address, (u16)value, true);
 			} else {
-				ortin.nds.nds9->writeIO(address, (u8)value, true);
+				ortin.nds.nds9->io.write<u8>(address, (u8)value, true);
 			}
 
 			tmpRefresh = true;
@@ -1342,7 +974,7 @@ void DebugMenu::ioReg9Window() { // Shamefully stolen from the ImGui demo
 	ImGui::End();
 }
 
-static const std::vector<IoRegister> registers7 = {{
+static const std::vector<IoRegister> registers7 = withTableRegisters7({{
 	{"DISPSTAT", "Display Status and Interrupt Control", 0x4000004, 2, true, true, &ortin.nds.ppu->DISPSTAT7, {
 		{"V-Blank", 0, 1, CHECKBOX},
 		{"H-Blank", 1, 1, CHECKBOX},
@@ -1353,94 +985,6 @@ static const std::vector<IoRegister> registers7 = {{
 		{"VCOUNT Compare Value", 7, 9, SPECIAL}}},
 	{"VCOUNT", "Vertical Counter", 0x4000006, 2, true, false, &ortin.nds.ppu->VCOUNT, {
 		{"Current Scanline (LY)", 0, 9}}},
-	{"DMA0SAD", "DMA 0 Source Address", 0x40000B0, 4, true, true, &ortin.nds.nds7->dma->channel[0].DMASAD, {
-		{"DMA 0 Source Address", 0, 27, TEXT_BOX_HEX}}},
-	{"DMA0DAD", "DMA 0 Destination Address", 0x40000B4, 4, true, true, &ortin.nds.nds7->dma->channel[0].DMADAD, {
-		{"DMA 0 Destination Address", 0, 27, TEXT_BOX_HEX}}},
-	{"DMA0CNT", "DMA 0 Control", 0x40000B8, 4, true, true, &ortin.nds.nds7->dma->channel[0].DMACNT, {
-		{"Word Count", 0, 14, TEXT_BOX_HEX},
-		{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
-											"Decrement\0"
-											"Fixed\0"
-											"Increment/Reload\0\0"},
-		{"Source Adr Control", 23, 2, COMBO, "Increment\0"
-											 "Decrement\0"
-											 "Fixed\0"
-											 "Prohibited\0\0"},
-		{"DMA Repeat", 25, 1, CHECKBOX},
-		{"DMA Transfer Type", 26, 1, CHECKBOX},
-		{"DMA Start Timing", 28, 2, COMBO, "Start Immediately\0"
-										   "Start at V-Blank\0"
-										   "DS Cartridge Slot\0"
-										   "Wireless interrupt\0\0"},
-		{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
-		{"DMA Enable", 31, 1, CHECKBOX}}},
-	{"DMA1SAD", "DMA 1 Source Address", 0x40000BC, 4, true, true, &ortin.nds.nds7->dma->channel[1].DMASAD, {
-		{"DMA 0 Source Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA1DAD", "DMA 1 Destination Address", 0x40000C0, 4, true, true, &ortin.nds.nds7->dma->channel[1].DMADAD, {
-		{"DMA 0 Destination Address", 0, 27, TEXT_BOX_HEX}}},
-	{"DMA1CNT", "DMA 1 Control", 0x40000C4, 4, true, true, &ortin.nds.nds7->dma->channel[1].DMACNT, {
-		{"Word Count", 0, 14, TEXT_BOX_HEX},
-		{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
-											"Decrement\0"
-											"Fixed\0"
-											"Increment/Reload\0\0"},
-		{"Source Adr Control", 23, 2, COMBO, "Increment\0"
-											 "Decrement\0"
-											 "Fixed\0"
-											 "Prohibited\0\0"},
-		{"DMA Repeat", 25, 1, CHECKBOX},
-		{"DMA Transfer Type", 26, 1, CHECKBOX},
-		{"DMA Start Timing", 28, 2, COMBO, "Start Immediately\0"
-										   "Start at V-Blank\0"
-										   "DS Cartridge Slot\0"
-										   "GBA Cartridge Slot\0\0"},
-		{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
-		{"DMA Enable", 31, 1, CHECKBOX}}},
-	{"DMA2SAD", "DMA 2 Source Address", 0x40000C8, 4, true, true, &ortin.nds.nds7->dma->channel[2].DMASAD, {
-		{"DMA 0 Source Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA2DAD", "DMA 2 Destination Address", 0x40000CC, 4, true, true, &ortin.nds.nds7->dma->channel[2].DMADAD, {
-		{"DMA 0 Destination Address", 0, 27, TEXT_BOX_HEX}}},
-	{"DMA2CNT", "DMA 2 Control", 0x40000D0, 4, true, true, &ortin.nds.nds7->dma->channel[2].DMACNT, {
-		{"Word Count", 0, 14, TEXT_BOX_HEX},
-		{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
-											"Decrement\0"
-											"Fixed\0"
-											"Increment/Reload\0\0"},
-		{"Source Adr Control", 23, 2, COMBO, "Increment\0"
-											 "Decrement\0"
-											 "Fixed\0"
-											 "Prohibited\0\0"},
-		{"DMA Repeat", 25, 1, CHECKBOX},
-		{"DMA Transfer Type", 26, 1, CHECKBOX},
-		{"DMA Start Timing", 28, 2, COMBO, "Start Immediately\0"
-										   "Start at V-Blank\0"
-										   "DS Cartridge Slot\0"
-										   "Wireless interrupt\0\0"},
-		{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
-		{"DMA Enable", 31, 1, CHECKBOX}}},
-	{"DMA3SAD", "DMA 3 Source Address", 0x40000D4, 4, true, true, &ortin.nds.nds7->dma->channel[3].DMASAD, {
-		{"DMA 0 Source Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA3DAD", "DMA 3 Destination Address", 0x40000D8, 4, true, true, &ortin.nds.nds7->dma->channel[3].DMADAD, {
-		{"DMA 0 Destination Address", 0, 28, TEXT_BOX_HEX}}},
-	{"DMA3CNT", "DMA 3 Control", 0x40000DC, 4, true, true, &ortin.nds.nds7->dma->channel[3].DMACNT, {
-		{"Word Count", 0, 16, TEXT_BOX_HEX},
-		{"Dest Addr Control", 21, 2, COMBO, "Increment\0"
-											"Decrement\0"
-											"Fixed\0"
-											"Increment/Reload\0\0"},
-		{"Source Adr Control", 23, 2, COMBO, "Increment\0"
-											 "Decrement\0"
-											 "Fixed\0"
-											 "Prohibited\0\0"},
-		{"DMA Repeat", 25, 1, CHECKBOX},
-		{"DMA Transfer Type", 26, 1, CHECKBOX},
-		{"DMA Start Timing", 28, 2, COMBO, "Start Immediately\0"
-										   "Start at V-Blank\0"
-										   "DS Cartridge Slot\0"
-										   "GBA Cartridge Slot\0\0"},
-		{"IRQ upon end of Word Count", 30, 1, CHECKBOX},
-		{"DMA Enable", 31, 1, CHECKBOX}}},
 	{"TM0CNT_L", "Timer 0 Counter/Reload", 0x4000100, 2, true, true, &ortin.nds.nds7->timer->timer[0].TIMCNT_L, {
 		{"Counter(R)/Reload(W)", 0, 16, TEXT_BOX_HEX}}},
 	{"TM0CNT_H", "Timer 0 Control", 0x4000102, 2, true, true, &ortin.nds.nds7->timer->timer[0].TIMCNT_H, {
@@ -2115,7 +1659,7 @@ static const std::vector<IoRegister> registers7 = {{
 		{"Destination address", 0, 27, TEXT_BOX_HEX}}},
 	{"SNDCAP1LEN", "Sound Capture 1 Length", 0x400051C, 2, false, true, &ortin.nds.nds7->apu->SNDCAP1LEN, {
 		{"Buffer length", 0, 16, TEXT_BOX_HEX}}},
-}};
+}});
 
 void DebugMenu::ioReg7Window() {
 	static int selected = 0;
@@ -2203,15 +1747,11 @@ void DebugMenu::ioReg7Window() {
 
 		if (ImGui::Button("Write")) {
 			if (size == 4) {
-				ortin.nds.nds7->writeIO(address | 0, (u8)(value >> 0), false);
-				ortin.nds.nds7->writeIO(address | 1, (u8)(value >> 8), false);
-				ortin.nds.nds7->writeIO(address | 2, (u8)(value >> 16), false);
-				ortin.nds.nds7->writeIO(address | 3, (u8)(value >> 24), true);
+				ortin.nds.nds7->io.write<u32>(address, value, true);
 			} else if (size == 2) {
-				ortin.nds.nds7->writeIO(address | 0, (u8)(value >> 0), false);
-				ortin.nds.nds7->writeIO(address | 1, (u8)(value >> 8), true);
+				ortin.nds.nds7->io.write<u16>(address, (u16)value, true);
 			} else {
-				ortin.nds.nds7->writeIO(address, (u8)value, true);
+				ortin.nds.nds7->io.write<u8>(address, (u8)value, true);
 			}
 
 			tmpRefresh = true;
@@ -21,7 +21,44 @@ void EmulationMenu::drawMenu() {
 			ortin.nds.addThreadEvent(NDS::RESET);
 			ortin.nds.addThreadEvent(NDS::START);
 		}
-		if (ImGui::MenuItem("Sync Time")) { ortin.nds.addThreadEvent(NDS::SET_TIME); }
+		ImGui::MenuItem("Cache Boot", nullptr, &ortin.nds.bootCache);
+		if (ImGui::MenuItem("Sync Time")) { ortin.nds.addThreadEvent(NDS::SET_TIME, NDS::RealTime{std::time(nullptr)}); }
+		ImGui::Separator();
+		auto& pacer = ortin.nds.pacer;
+		if (ImGui::RadioButton("Real Time", pacer.mode == FramePacer::REALTIME)) pacer.mode = FramePacer::REALTIME;
+		if (ImGui::RadioButton("Uncapped", pacer.mode == FramePacer::UNCAPPED)) pacer.mode = FramePacer::UNCAPPED;
+		if (ImGui::RadioButton("Fast Forward", pacer.mode == FramePacer::FAST_FORWARD)) pacer.mode = FramePacer::FAST_FORWARD;
+		int multiplier = pacer.fastForwardMultiplier;
+		if (ImGui::SliderInt("Fast Forward Speed", &multiplier, 2, 16, "%dx")) pacer.fastForwardMultiplier = multiplier;
+		int fastForwardAudio = pacer.fastForwardAudio;
+		if (ImGui::Combo("Fast Forward Audio", &fastForwardAudio, "Normal\0Mute\0Decimate\0")) pacer.fastForwardAudio = (FramePacer::FastForwardAudio)fastForwardAudio;
+		ImGui::Separator();
+		ImGui::Checkbox("Rewind (Hold R)", &ortin.nds.rewindEnabled);
+		ImGui::SliderInt("Rewind Interval", &ortin.nds.rewindInterval, 1, 60, "%d frames");
+		ImGui::SliderInt("Rewind Budget", &ortin.nds.rewindBudget, 16, 2048, "%dMB", ImGuiSliderFlags_Logarithmic);
+		if (ImGui::MenuItem("Step Back", nullptr, false, ortin.nds.rewindEnabled && !ortin.nds.running)) { ortin.nds.addThreadEvent(NDS::REWIND); }
+		ImGui::Text("Snapshots: %zu (%zuMB)", ortin.nds.rewind.depth(), ortin.nds.rewind.memoryUsed >> 20);
+		ImGui::Text("Last snapshot took: %lluus", (unsigned long long)ortin.nds.rewindCaptureTime);
+		ImGui::Separator();
+		ImGui::SliderInt("Run-Ahead", &ortin.nds.runAheadFrames, 0, 4, "%d frames");
+		ImGui::Checkbox("Run Ahead on Second Instance", &ortin.nds.runAheadThreaded);
+		ImGui::Separator();
+		ImGui::SliderInt("Sync Quantum", &ortin.nds.syncQuantum, 0, 65536, "%d", ImGuiSliderFlags_Logarithmic);
+		ImGui::Checkbox("Run ARM7 on Separate Thread", &ortin.nds.threadedArm7); // Not exact, see nds.hpp
+		if (ortin.nds.threadedArm7) {
+			// Slices shorter than this stay on the emulator thread, so the sync quantum has to be above it to help
+			if (ortin.nds.arm7ThreadUnavailable) {
+				ImGui::Text("Only one host CPU, so the ARM7 can't have its own thread");
+			} else if (ortin.nds.parallelMinSlice != UINT64_MAX) {
+				ImGui::Text("Break-even slice: %llu cycles", (unsigned long long)ortin.nds.parallelMinSlice);
+			}
+		}
+		ImGui::Checkbox("Idle Loop Detection", &ortin.nds.idleLoopDetection);
+		bool fastmem = ortin.nds.nds9->fastmem.base != nullptr;
+		if (ImGui::Checkbox("Fastmem", &fastmem)) { ortin.nds.addThreadEvent(fastmem ? NDS::ENABLE_FASTMEM : NDS::DISABLE_FASTMEM); }
+		ImGui::Text("Idle cycles skipped: %llu", (unsigned long long)ortin.nds.idleCyclesSkipped);
+		ImGui::Text("Page refreshes coalesced: %llu", (unsigned long long)ortin.nds.shared->coalescedRefreshes);
+		ImGui::Text("Last resume latency: %lluus", (unsigned long long)ortin.nds.resumeLatency.load());
 
 		ImGui::EndMenu();
 	}
@@ -17,6 +17,15 @@ void FileMenu::drawMenu() {
 		if (ImGui::MenuItem("Load Firmware")) { firmwareFileDialog(); }
 		ImGui::Separator();
 
+		if (ImGui::MenuItem("Save State", nullptr, false, ortin.nds.romInfo.romLoaded)) { saveStateDialog(); }
+		if (ImGui::MenuItem("Load State", nullptr, false, ortin.nds.romInfo.romLoaded)) { loadStateDialog(); }
+		ImGui::Separator();
+
+		if (ImGui::MenuItem("Record State Hashes", nullptr, false, ortin.nds.romInfo.romLoaded)) { hashFileDialog(NDS::RECORD_HASHES); }
+		if (ImGui::MenuItem("Check State Hashes", nullptr, false, ortin.nds.romInfo.romLoaded)) { hashFileDialog(NDS::CHECK_HASHES); }
+		if (ImGui::MenuItem("Stop Hashing")) { ortin.nds.addThreadEvent(NDS::STOP_HASHES); }
+		ImGui::Separator();
+
 		ImGui::MenuItem("ROM Info", nullptr, &showRomInfo);
 
 		ImGui::EndMenu();
@@ -37,7 +46,7 @@ void FileMenu::romFileDialog() {
 		std::cout << "Selected " << outPath.get() << std::endl;
 
 		ortin.nds.addThreadEvent(NDS::STOP);
-		ortin.nds.addThreadEvent(NDS::LOAD_ROM, &romFilePath);
+		ortin.nds.addThreadEvent(NDS::LOAD_ROM, romFilePath);
 		ortin.nds.addThreadEvent(NDS::RESET);
 		ortin.nds.addThreadEvent(NDS::START);
 	} else if (result != NFD_CANCEL) {
@@ -55,7 +64,7 @@ void FileMenu::bios9FileDialog() {
 		std::cout << "Selected " << outPath.get() << std::endl;
 
 		ortin.nds.addThreadEvent(NDS::STOP);
-		ortin.nds.addThreadEvent(NDS::LOAD_BIOS9, &bios9FilePath);
+		ortin.nds.addThreadEvent(NDS::LOAD_BIOS9, bios9FilePath);
 		ortin.nds.addThreadEvent(NDS::RESET);
 		ortin.nds.addThreadEvent(NDS::START);
 	} else if (result != NFD_CANCEL) {
@@ -73,7 +82,7 @@ void FileMenu::bios7FileDialog() {
 		std::cout << "Selected " << outPath.get() << std::endl;
 
 		ortin.nds.addThreadEvent(NDS::STOP);
-		ortin.nds.addThreadEvent(NDS::LOAD_BIOS7, &bios7FilePath);
+		ortin.nds.addThreadEvent(NDS::LOAD_BIOS7, bios7FilePath);
 		ortin.nds.addThreadEvent(NDS::RESET);
 		ortin.nds.addThreadEvent(NDS::START);
 	} else if (result != NFD_CANCEL) {
@@ -91,7 +100,60 @@ void FileMenu::firmwareFileDialog() {
 		std::cout << "Selected " << outPath.get() << std::endl;
 
 		ortin.nds.addThreadEvent(NDS::STOP);
-		ortin.nds.addThreadEvent(NDS::LOAD_FIRMWARE, &firmwareFilePath);
+		ortin.nds.addThreadEvent(NDS::LOAD_FIRMWARE, firmwareFilePath);
+		ortin.nds.addThreadEvent(NDS::RESET);
+		ortin.nds.addThreadEvent(NDS::START);
+	} else if (result != NFD_CANCEL) {
+		std::cout << "Error: " << NFD::GetError() << std::endl;
+	}
+}
+
+void FileMenu::saveStateDialog() {
+	NFD::UniquePath outPath;
+	nfdfilteritem_t filterItem[1] = {{"Ortin Save State", "ost"}};
+
+	nfdresult_t result = NFD::SaveDialog(outPath, filterItem, 1, nullptr, (ortin.nds.romInfo.filePath.stem().string() + ".ost").c_str());
+	if (result == NFD_OKAY) {
+		std::cout << "Selected " << outPath.get() << std::endl;
+
+		// Handled between frames, so there's no need to stop the emulator
+		ortin.nds.addThreadEvent(NDS::SAVE_STATE, std::filesystem::path(outPath.get()));
+	} else if (result != NFD_CANCEL) {
+		std::cout << "Error: " << NFD::GetError() << std::endl;
+	}
+}
+
+void FileMenu::loadStateDialog() {
+	NFD::UniquePath outPath;
+	nfdfilteritem_t filterItem[1] = {{"Ortin Save State", "ost"}};
+
+	nfdresult_t result = NFD::OpenDialog(outPath, filterItem, 1);
+	if (result == NFD_OKAY) {
+		std::cout << "Selected " << outPath.get() << std::endl;
+
+		ortin.nds.addThreadEvent(NDS::LOAD_STATE, std::filesystem::path(outPath.get()));
+	} else if (result != NFD_CANCEL) {
+		std::cout << "Error: " << NFD::GetError() << std::endl;
+	}
+}
+
+void FileMenu::hashFileDialog(NDS::threadEventType type) {
+	NFD::UniquePath outPath;
+	nfdfilteritem_t filterItem[1] = {{"State Hashes", "hashes"}};
+
+	nfdresult_t result;
+	if (type == NDS::RECORD_HASHES) {
+		result = NFD::SaveDialog(outPath, filterItem, 1, nullptr, (ortin.nds.romInfo.filePath.stem().string() + ".hashes").c_str());
+	} else {
+		result = NFD::OpenDialog(outPath, filterItem, 1);
+	}
+
+	if (result == NFD_OKAY) {
+		std::cout << "Selected " << outPath.get() << std::endl;
+
+		// Hashes only line up if both runs start from a reset
+		ortin.nds.addThreadEvent(NDS::STOP);
+		ortin.nds.addThreadEvent(type, std::filesystem::path(outPath.get()));
 		ortin.nds.addThreadEvent(NDS::RESET);
 		ortin.nds.addThreadEvent(NDS::START);
 	} else if (result != NFD_CANCEL) {
@@ -5,6 +5,7 @@
 Ortin::Ortin() : emuThread(&NDS::run, std::ref(nds)) {
 	error = false;
 	penDown = false;
+	touchX = touchY = 0;
 
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) != 0) {
 		printf("Error: %s\n", SDL_GetError());
@@ -117,13 +118,11 @@ void Ortin::drawScreens() {
 		auto topLeft = ImGui::GetItemRectMin();
 		auto size = ImGui::GetItemRectSize();
 
-		nds.nds7->spi->touchscreen.xPosition = (u8)(((mousePos.x - topLeft.x) / size.x) * 0x100) << 4;
-		nds.nds7->spi->touchscreen.yPosition = (u8)(((mousePos.y - topLeft.y) / size.y) * 0xC0) << 4;
+		touchX = (u8)(((mousePos.x - topLeft.x) / size.x) * 0x100);
+		touchY = (u8)(((mousePos.y - topLeft.y) / size.y) * 0xC0);
 		penDown = true;
-		//printf("%03X  %03X\n", nds.nds7->spi->touchscreen.xPosition, nds.nds7->spi->touchscreen.yPosition);
 	} else {
-		nds.nds7->spi->touchscreen.xPosition = 0;
-		nds.nds7->spi->touchscreen.yPosition = 0;
+		touchX = touchY = 0;
 		penDown = false;
 	}
 